@@ -21,10 +21,13 @@
 
 #include "config.h"
 #include "mtrand.h"
+#include "palette_lut.h"
 #include "varz.h"
 #include "video.h"
 
 #include <assert.h>
+#include <stddef.h>
+#include <string.h>
 
 /*Special Background 2 and Background 3*/
 
@@ -43,6 +46,269 @@ JE_byte map1YDelay, map1YDelayMax, map2YDelay, map2YDelayMax;
 JE_boolean  anySmoothies;
 JE_byte     smoothie_data[9]; /* [1..9] */
 
+void init_tile_info( JE_TileInfo *info, const Uint8 *data )
+{
+	bool any_opaque = false, all_opaque = true;
+	
+	for (int row = 0; row < 28; row++)
+	{
+		Uint32 mask = 0;
+		for (int x = 0; x < 24; x++)
+			if (data[row * 24 + x] != 0)
+				mask |= 1u << x;
+		
+		info->row_mask[row] = mask;
+		any_opaque |= (mask != 0);
+		all_opaque &= (mask == TILE_ROW_OPAQUE);
+	}
+	
+	info->kind = all_opaque ? TILE_OPAQUE : any_opaque ? TILE_MIXED : TILE_EMPTY;
+}
+
+static inline const JE_TileInfo *tile_info( const Uint8 *data )
+{
+	// JE_loadMap keeps the info right in front of the pixels
+	return (const JE_TileInfo *)(data - sizeof(JE_TileInfo));
+}
+
+#define TILE_INFO_ADJACENT(type) \
+	(offsetof(type, shapes[0].sh) == offsetof(type, shapes[0].info) + sizeof(JE_TileInfo))
+_Static_assert(TILE_INFO_ADJACENT(struct JE_MegaDataType1) &&
+               TILE_INFO_ADJACENT(struct JE_MegaDataType2) &&
+               TILE_INFO_ADJACENT(struct JE_MegaDataType3), "tile info must directly precede the shape");
+
+// The bits of a tile row's mask for the pixels from offset to offset + width.
+static inline Uint32 clip_row_mask( Uint32 mask, int offset, int width )
+{
+	return (mask >> offset) & ((1u << width) - 1);
+}
+
+// Copies each run of opaque pixels in a tile row with one memcpy, skipping
+// the transparent ones between them.  Bit i of mask stands for data[i].
+static inline void copy_opaque_runs( Uint8 *pixels, const Uint8 *data, Uint32 mask )
+{
+	while (mask != 0)
+	{
+		const int skip = __builtin_ctz(mask);
+		pixels += skip;
+		data += skip;
+		mask >>= skip;
+		
+		// the mask is at most 24 bits wide, so ~mask always has a set bit
+		const int run = __builtin_ctz(~mask);
+		memcpy(pixels, data, run);
+		pixels += run;
+		data += run;
+		mask >>= run;
+	}
+}
+
+static inline void blend_opaque_runs( Uint8 *pixels, const Uint8 *data, Uint32 mask )
+{
+	while (mask != 0)
+	{
+		const int skip = __builtin_ctz(mask);
+		pixels += skip;
+		data += skip;
+		mask >>= skip;
+		
+		for (int run = __builtin_ctz(~mask); run > 0; run--)
+		{
+			*pixels = (*data & 0xf0) | (((*pixels & 0x0f) + (*data & 0x0f)) / 2);
+			
+			pixels++;
+			data++;
+			mask >>= 1;
+		}
+	}
+}
+
+#if BACKGROUND_CACHE
+/*
+ * Each layer draws 8 rows of 12 tiles (24x28) every frame, but from one frame
+ * to the next only the scroll offset changes.  A row of tiles is rasterized
+ * once into a strip the first time it is seen (in practice when backPos wraps
+ * and a new row scrolls in) and kept while it stays on screen.  Strips are
+ * keyed by the map entries they were drawn from, so horizontal tile shifts
+ * are picked up too.  One spare slot beyond the visible rows means the least
+ * recently used strip is always one that has left the screen.
+ */
+#define BACKGROUND_STRIPS       9
+#define BACKGROUND_STRIP_WIDTH  (12 * 24)
+
+enum
+{
+	STRIP_ROW_MIXED,
+	STRIP_ROW_EMPTY,   // fully transparent; nothing to draw
+	STRIP_ROW_OPAQUE,  // no transparent pixels; drawn with a plain copy
+};
+
+typedef struct
+{
+	Uint8 **map;  // first of the map entries this strip was drawn from
+	Uint32 last_used;
+	Uint8 row_kind[28];
+	Uint8 pixels[28][BACKGROUND_STRIP_WIDTH];
+}
+BackgroundStrip;
+
+typedef struct
+{
+	BackgroundStrip strips[BACKGROUND_STRIPS];
+	Uint32 frame;
+}
+BackgroundCache;
+
+EXT_RAM_BSS_ATTR static BackgroundCache background_cache[3];
+
+typedef enum
+{
+	BACKGROUND_COPY,     // bottom layer over a cleared surface; transparent pixels are 0 anyway
+	BACKGROUND_OVERLAY,
+	BACKGROUND_BLEND,
+}
+BackgroundMode;
+
+void invalidate_background_cache( void )
+{
+	for (int layer = 0; layer < 3; ++layer)
+		for (int i = 0; i < BACKGROUND_STRIPS; ++i)
+			background_cache[layer].strips[i].map = NULL;
+}
+
+static void rasterize_strip( BackgroundStrip *strip, Uint8 **map )
+{
+	strip->map = map;
+	
+	bool any_opaque[28] = { false }, all_opaque[28];
+	memset(all_opaque, true, sizeof(all_opaque));
+	
+	for (int tile = 0; tile < 12; tile++)
+	{
+		const Uint8 *data = *(map + tile);
+		const JE_TileInfo *info = data != NULL ? tile_info(data) : NULL;
+		
+		for (int row = 0; row < 28; row++)
+		{
+			Uint8 *pixels = &strip->pixels[row][tile * 24];
+			const Uint32 mask = info != NULL ? info->row_mask[row] : 0;
+			
+			// no tile or nothing in this row of it; leave it transparent
+			if (mask == 0)
+				memset(pixels, 0, 24);
+			else
+				memcpy(pixels, data + row * 24, 24);
+			
+			any_opaque[row] |= (mask != 0);
+			all_opaque[row] &= (mask == TILE_ROW_OPAQUE);
+		}
+	}
+	
+	for (int row = 0; row < 28; row++)
+		strip->row_kind[row] = all_opaque[row] ? STRIP_ROW_OPAQUE :
+		                       any_opaque[row] ? STRIP_ROW_MIXED : STRIP_ROW_EMPTY;
+}
+
+static const BackgroundStrip *get_strip( BackgroundCache *cache, Uint8 **map )
+{
+	BackgroundStrip *oldest = &cache->strips[0];
+	
+	for (int i = 0; i < BACKGROUND_STRIPS; ++i)
+	{
+		BackgroundStrip *strip = &cache->strips[i];
+		
+		if (strip->map == map)
+		{
+			strip->last_used = cache->frame;
+			return strip;
+		}
+		
+		if (strip->map == NULL || (oldest->map != NULL && strip->last_used < oldest->last_used))
+			oldest = strip;
+	}
+	
+	rasterize_strip(oldest, map);
+	oldest->last_used = cache->frame;
+	return oldest;
+}
+
+static void IRAM_ATTR blit_background_strip( SDL_Surface *surface, const SDL_Rect *clip, const BackgroundStrip *strip, int x, int y, BackgroundMode mode )
+{
+	const int left = MAX(x, clip->x),
+	          right = MIN(x + BACKGROUND_STRIP_WIDTH, clip->x + clip->w);
+	
+	if (left >= right)
+		return;
+	
+	for (int row = 0; row < 28; row++)
+	{
+		const int pixels_y = y + row;
+		
+		// not drawing on screen yet; skip row
+		if (pixels_y < clip->y)
+			continue;
+		if (pixels_y >= clip->y + clip->h)
+			return;
+		
+		const int kind = strip->row_kind[row];
+		if (kind == STRIP_ROW_EMPTY)
+			continue;
+		
+		Uint8 * const pixels = (Uint8 *)surface->pixels + (pixels_y * surface->pitch);
+		
+		if (mode == BACKGROUND_COPY || (mode == BACKGROUND_OVERLAY && kind == STRIP_ROW_OPAQUE))
+		{
+			memcpy(&pixels[left], &strip->pixels[row][left - x], right - left);
+			continue;
+		}
+		
+		// a mixed row is mostly empty tiles or runs of opaque pixels; go by
+		// the masks of the tiles it was drawn from rather than pixel by pixel
+		for (int tile = 0; tile < 12; tile++)
+		{
+			const Uint8 *data = strip->map[tile];
+			
+			// no tile; skip tile
+			if (data == NULL)
+				continue;
+			
+			const int tile_x = x + tile * 24,
+			          tile_left = MAX(tile_x, left),
+			          tile_right = MIN(tile_x + 24, right);
+			
+			if (tile_left >= tile_right)
+				continue;
+			
+			const Uint32 mask = clip_row_mask(tile_info(data)->row_mask[row], tile_left - tile_x, tile_right - tile_left);
+			
+			if (mode == BACKGROUND_BLEND)
+				blend_opaque_runs(&pixels[tile_left], &strip->pixels[row][tile_left - x], mask);
+			else
+				copy_opaque_runs(&pixels[tile_left], &strip->pixels[row][tile_left - x], mask);
+		}
+	}
+}
+
+static void draw_background_layer( SDL_Surface *surface, int layer, int x, int y, Uint8 **map, int map_width, BackgroundMode mode )
+{
+	BackgroundCache *cache = &background_cache[layer];
+	++cache->frame;
+	
+	const SDL_Rect clip = *get_blit_clip(surface);
+	
+	for (int i = -1; i < 7; i++)
+	{
+		blit_background_strip(surface, &clip, get_strip(cache, map), x, (i * 28) + y, mode);
+		
+		map += map_width;
+	}
+}
+#else
+void invalidate_background_cache( void )
+{
+}
+#endif /* BACKGROUND_CACHE */
+
 void JE_darkenBackground( JE_word neat )  /* wild detail level */
 {
 	Uint8 *s = (Uint8 *)VGAScreen->pixels; /* screen pointer, 8-bit specific */
@@ -65,45 +331,42 @@ void IRAM_ATTR blit_background_row( SDL_Surface *surface, int x, int y, Uint8 **
 {
 	// assert(surface->BitsPerPixel == 8);
 	
-	Uint8 *pixels = (Uint8 *)surface->pixels + (y * surface->pitch) + x,
-	      *pixels_ll = (Uint8 *)surface->pixels,  // lower limit
-	      *pixels_ul = (Uint8 *)surface->pixels + (surface->h * surface->pitch);  // upper limit
+	const SDL_Rect clip = *get_blit_clip(surface);
 	
-	for (int y = 0; y < 28; y++)
+	for (int row = 0; row < 28; row++)
 	{
-		// not drawing on screen yet; skip y
-		if ((pixels + (12 * 24)) < pixels_ll)
-		{
-			pixels += surface->pitch;
+		const int pixels_y = y + row;
+		
+		// not drawing on screen yet; skip row
+		if (pixels_y < clip.y)
 			continue;
-		}
+		if (pixels_y >= clip.y + clip.h)
+			return;
+		
+		Uint8 * const pixels = (Uint8 *)surface->pixels + (pixels_y * surface->pitch);
 		
 		for (int tile = 0; tile < 12; tile++)
 		{
-			Uint8 *data = *(map + tile);
+			const Uint8 *data = *(map + tile);
 			
 			// no tile; skip tile
 			if (data == NULL)
-			{
-				pixels += 24;
 				continue;
-			}
 			
-			data += y * 24;
+			const int tile_x = x + tile * 24,
+			          left = MAX(tile_x, clip.x),
+			          right = MIN(tile_x + 24, clip.x + clip.w);
 			
-			for (int x = 24; x; x--)
-			{
-				if (pixels >= pixels_ul)
-					return;
-				if (pixels >= pixels_ll && *data != 0)
-					*pixels = *data;
-				
-				pixels++;
-				data++;
-			}
+			const Uint32 mask = tile_info(data)->row_mask[row];
+			
+			// fully transparent row of this tile, or off screen; skip it
+			if (mask == 0 || left >= right)
+				continue;
+			
+			data += row * 24 + (left - tile_x);
+			
+			copy_opaque_runs(&pixels[left], data, clip_row_mask(mask, left - tile_x, right - left));
 		}
-		
-		pixels += surface->pitch - 12 * 24;
 	}
 }
 
@@ -111,45 +374,42 @@ void IRAM_ATTR blit_background_row_blend( SDL_Surface *surface, int x, int y, Ui
 {
 	// assert(surface->BitsPerPixel == 8);
 	
-	Uint8 *pixels = (Uint8 *)surface->pixels + (y * surface->pitch) + x,
-	      *pixels_ll = (Uint8 *)surface->pixels,  // lower limit
-	      *pixels_ul = (Uint8 *)surface->pixels + (surface->h * surface->pitch);  // upper limit
+	const SDL_Rect clip = *get_blit_clip(surface);
 	
-	for (int y = 0; y < 28; y++)
+	for (int row = 0; row < 28; row++)
 	{
-		// not drawing on screen yet; skip y
-		if ((pixels + (12 * 24)) < pixels_ll)
-		{
-			pixels += surface->pitch;
+		const int pixels_y = y + row;
+		
+		// not drawing on screen yet; skip row
+		if (pixels_y < clip.y)
 			continue;
-		}
+		if (pixels_y >= clip.y + clip.h)
+			return;
+		
+		Uint8 * const pixels = (Uint8 *)surface->pixels + (pixels_y * surface->pitch);
 		
 		for (int tile = 0; tile < 12; tile++)
 		{
-			Uint8 *data = *(map + tile);
+			const Uint8 *data = *(map + tile);
 			
 			// no tile; skip tile
 			if (data == NULL)
-			{
-				pixels += 24;
 				continue;
-			}
 			
-			data += y * 24;
+			const int tile_x = x + tile * 24,
+			          left = MAX(tile_x, clip.x),
+			          right = MIN(tile_x + 24, clip.x + clip.w);
 			
-			for (int x = 24; x; x--)
-			{
-				if (pixels >= pixels_ul)
-					return;
-				if (pixels >= pixels_ll && *data != 0)
-					*pixels = (*data & 0xf0) | (((*pixels & 0x0f) + (*data & 0x0f)) / 2);
-				
-				pixels++;
-				data++;
-			}
+			const Uint32 mask = tile_info(data)->row_mask[row];
+			
+			// fully transparent row of this tile, or off screen; skip it
+			if (mask == 0 || left >= right)
+				continue;
+			
+			data += row * 24 + (left - tile_x);
+			
+			blend_opaque_runs(&pixels[left], data, clip_row_mask(mask, left - tile_x, right - left));
 		}
-		
-		pixels += surface->pitch - 12 * 24;
 	}
 }
 
@@ -159,12 +419,16 @@ void IRAM_ATTR draw_background_1( SDL_Surface *surface )
 	
 	Uint8 **map = (Uint8 **)mapYPos + mapXbpPos - 12;
 	
+#if BACKGROUND_CACHE
+	draw_background_layer(surface, 0, mapXPos, backPos, map, 14, BACKGROUND_COPY);
+#else
 	for (int i = -1; i < 7; i++)
 	{
 		blit_background_row(surface, mapXPos, (i * 28) + backPos, map);
 		
 		map += 14;
 	}
+#endif
 }
 
 void IRAM_ATTR draw_background_2( SDL_Surface *surface )
@@ -179,12 +443,16 @@ void IRAM_ATTR draw_background_2( SDL_Surface *surface )
 		
 		Uint8 **map = (Uint8 **)mapY2Pos + (smoothies[1] ? mapXbpPos : mapX2bpPos) - 12;
 		
+#if BACKGROUND_CACHE
+		draw_background_layer(surface, 1, x, backPos2, map, 14, BACKGROUND_OVERLAY);
+#else
 		for (int i = -1; i < 7; i++)
 		{
 			blit_background_row(surface, x, (i * 28) + backPos2, map);
 			
 			map += 14;
 		}
+#endif
 	}
 	
 	/*Set Movement of background*/
@@ -210,12 +478,16 @@ void IRAM_ATTR draw_background_2_blend( SDL_Surface *surface )
 	
 	Uint8 **map = (Uint8 **)mapY2Pos + mapX2bpPos - 12;
 	
+#if BACKGROUND_CACHE
+	draw_background_layer(surface, 1, mapX2Pos, backPos2, map, 14, BACKGROUND_BLEND);
+#else
 	for (int i = -1; i < 7; i++)
 	{
 		blit_background_row_blend(surface, mapX2Pos, (i * 28) + backPos2, map);
 		
 		map += 14;
 	}
+#endif
 	
 	/*Set Movement of background*/
 	if (--map2YDelay == 0)
@@ -247,19 +519,22 @@ void IRAM_ATTR draw_background_3( SDL_Surface *surface )
 	
 	Uint8 **map = (Uint8 **)mapY3Pos + mapX3bpPos - 12;
 	
+#if BACKGROUND_CACHE
+	draw_background_layer(surface, 2, mapX3Pos, backPos3, map, 15, BACKGROUND_OVERLAY);
+#else
 	for (int i = -1; i < 7; i++)
 	{
 		blit_background_row(surface, mapX3Pos, (i * 28) + backPos3, map);
 		
 		map += 15;
 	}
+#endif
 }
 
 void JE_filterScreen( JE_shortint col, JE_shortint int_)
 {
 	Uint8 *s = NULL; /* screen pointer, 8-bit specific */
 	int x, y;
-	unsigned int temp;
 	
 	if (filterFade)
 	{
@@ -300,12 +575,13 @@ void JE_filterScreen( JE_shortint col, JE_shortint int_)
 		s = (Uint8 *)VGAScreen->pixels;
 		s += 24;
 		
+		const Uint8 *lut = palette_lut_brightness(int_);
+		
 		for (y = 184; y; y--)
 		{
 			for (x = 264; x; x--)
 			{
-				temp = (*s & 0x0f) + int_;
-				*s = (*s & 0xf0) | (temp >= 0x1f ? 0 : (temp >= 0x0f ? 0x0f : temp));
+				*s = lut[*s];
 				s++;
 			}
 			s += VGAScreen->pitch - 264;
@@ -318,6 +594,26 @@ void JE_checkSmoothies( void )
 	anySmoothies = (processorType > 2 && (smoothies[1-1] || smoothies[2-1])) || (processorType > 1 && (smoothies[3-1] || smoothies[4-1] || smoothies[5-1]));
 }
 
+/*
+ * The filters below work on four pixels at a time packed into a 32-bit word.
+ * Every operation stays inside a byte lane: nibbles are masked before adding,
+ * sums never exceed 8 bits, and whatever a shift drags in from the next lane
+ * is masked off again, so the result matches the per-pixel code exactly.
+ */
+#define SWAR_LANES(b) (0x01010101u * (Uint8)(b))
+
+static inline Uint32 load_pixels( const Uint8 *p )
+{
+	Uint32 v;
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+static inline void store_pixels( Uint8 *p, Uint32 v )
+{
+	memcpy(p, &v, sizeof(v));
+}
+
 void lava_filter( SDL_Surface *dst, SDL_Surface *src )
 {
 	// assert(src->BitsPerPixel == 8 && dst->BitsPerPixel == 8);
@@ -326,41 +622,63 @@ void lava_filter( SDL_Surface *dst, SDL_Surface *src )
 	 * read from the top 185+1 scanlines, and there should be 320 */
 	
 	const int dst_pitch = dst->pitch;
-	Uint8 *dst_pixel = (Uint8 *)dst->pixels + (185 * dst_pitch);
 	const Uint8 * const dst_pixel_ll = (Uint8 *)dst->pixels;  // lower limit
 	
 	const int src_pitch = src->pitch;
-	const Uint8 *src_pixel = (Uint8 *)src->pixels + (185 * src->pitch);
 	const Uint8 * const src_pixel_ll = (Uint8 *)src->pixels;  // lower limit
 	
-	int w = 320 * 185 - 1;
+	// Rows are filtered bottom to top and each row right to left, eight pixels
+	// sharing a waver, because the row below is read after it was filtered
+	// (and the row above before it is).  The order within a group of eight
+	// doesn't matter, since no pixel in a group reads another one -- unless
+	// the filter runs in place (after iced_blur_filter, game_screen is both
+	// surfaces), where a pixel reads source pixels to its right that were
+	// already filtered, so it has to go one pixel at a time.
+	const bool in_place = src->pixels == dst->pixels;
 	
 	for (int y = 185 - 1; y >= 0; --y)
 	{
-		dst_pixel -= (dst_pitch - 320);  // in case pitch is not 320
-		src_pixel -= (src_pitch - 320);  // in case pitch is not 320
+		Uint8 * const dst_row = (Uint8 *)dst->pixels + y * dst_pitch;
+		const Uint8 * const src_row = (Uint8 *)src->pixels + y * src_pitch;
 		
-		for (int x = 320 - 1; x >= 0; x -= 8)
+		for (int x = 320 - 8; x >= 0; x -= 8)
 		{
-			int waver = abs(((w >> 9) & 0x0f) - 8) - 1;
-			w -= 8;
+			const int w = 320 * y + x + 7;
+			const int waver = abs(((w >> 9) & 0x0f) - 8) - 1;
+			
+			// value is average value of source pixel (2x), destination pixel above, and destination pixel below (all with waver)
+			// hue is red
 			
-			for (int xi = 8 - 1; xi >= 0; --xi)
+			if (y >= 2 && !in_place)
 			{
-				--dst_pixel;
-				--src_pixel;
-				
-				// value is average value of source pixel (2x), destination pixel above, and destination pixel below (all with waver)
-				// hue is red
-				Uint8 value = 0;
-				
-				if (src_pixel + waver >= src_pixel_ll)
-					value += (*(src_pixel + waver) & 0x0f) * 2;
-				value += *(dst_pixel + waver + dst_pitch) & 0x0f;
-				if (dst_pixel + waver - dst_pitch >= dst_pixel_ll)
-					value += *(dst_pixel + waver - dst_pitch) & 0x0f;
-				
-				*dst_pixel = (value / 4) | 0x70;
+				// far enough from the top that every read is in bounds
+				for (int xi = 0; xi < 8; xi += 4)
+				{
+					const Uint32 s = load_pixels(src_row + x + xi + waver) & SWAR_LANES(0x0f),
+					             below = load_pixels(dst_row + x + xi + waver + dst_pitch) & SWAR_LANES(0x0f),
+					             above = load_pixels(dst_row + x + xi + waver - dst_pitch) & SWAR_LANES(0x0f);
+					
+					const Uint32 value = (s << 1) + below + above;
+					store_pixels(dst_row + x + xi, ((value >> 2) & SWAR_LANES(0x0f)) | SWAR_LANES(0x70));
+				}
+			}
+			else
+			{
+				for (int xi = 8 - 1; xi >= 0; --xi)
+				{
+					Uint8 * const dst_pixel = dst_row + x + xi;
+					const Uint8 * const src_pixel = src_row + x + xi;
+					
+					Uint8 value = 0;
+					
+					if (src_pixel + waver >= src_pixel_ll)
+						value += (*(src_pixel + waver) & 0x0f) * 2;
+					value += *(dst_pixel + waver + dst_pitch) & 0x0f;
+					if (dst_pixel + waver - dst_pitch >= dst_pixel_ll)
+						value += *(dst_pixel + waver - dst_pitch) & 0x0f;
+					
+					*dst_pixel = (value / 4) | 0x70;
+				}
 			}
 		}
 	}
@@ -376,39 +694,35 @@ void water_filter( SDL_Surface *dst, SDL_Surface *src )
 	 * read from the top 185+1 scanlines, and there should be 320 */
 	
 	const int dst_pitch = dst->pitch;
-	Uint8 *dst_pixel = (Uint8 *)dst->pixels + (185 * dst_pitch);
-	
-	const Uint8 *src_pixel = (Uint8 *)src->pixels + (185 * src->pitch);
-	
-	int w = 320 * 185 - 1;
 	
+	// same order as lava_filter, since the row below is read after filtering;
+	// a pixel reads no other pixel of its own row, so this also works in place
+	// (after lava_filter, game_screen is both surfaces)
 	for (int y = 185 - 1; y >= 0; --y)
 	{
-		dst_pixel -= (dst_pitch - 320);  // in case pitch is not 320
-		src_pixel -= (src->pitch - 320);  // in case pitch is not 320
+		Uint8 * const dst_row = (Uint8 *)dst->pixels + y * dst_pitch;
+		const Uint8 * const src_row = (Uint8 *)src->pixels + y * src->pitch;
 		
-		for (int x = 320 - 1; x >= 0; x -= 8)
+		for (int x = 320 - 8; x >= 0; x -= 8)
 		{
-			int waver = abs(((w >> 10) & 0x07) - 4) - 1;
-			w -= 8;
+			const int w = 320 * y + x + 7;
+			const int waver = abs(((w >> 10) & 0x07) - 4) - 1;
 			
-			for (int xi = 8 - 1; xi >= 0; --xi)
+			for (int xi = 0; xi < 8; xi += 4)
 			{
-				--dst_pixel;
-				--src_pixel;
-				
 				// pixel is copied from source if not blue
 				// otherwise, value is average of value of source pixel and destination pixel below (with waver)
-				if ((*src_pixel & 0x30) == 0)
-				{
-					*dst_pixel = *src_pixel;
-				}
-				else
-				{
-					Uint8 value = *src_pixel & 0x0f;
-					value += *(dst_pixel + waver + dst_pitch) & 0x0f;
-					*dst_pixel = (value / 2) | hue;
-				}
+				const Uint32 s = load_pixels(src_row + x + xi),
+				             below = load_pixels(dst_row + x + xi + waver + dst_pitch);
+				
+				const Uint32 value = (s & SWAR_LANES(0x0f)) + (below & SWAR_LANES(0x0f));
+				const Uint32 blended = ((value >> 1) & SWAR_LANES(0x0f)) | SWAR_LANES(hue);
+				
+				// 0xff in every lane whose source pixel has either blue bit set
+				const Uint32 blue_bits = s & SWAR_LANES(0x30),
+				             blue = (((blue_bits | (blue_bits >> 1)) >> 4) & SWAR_LANES(0x01)) * 0xff;
+				
+				store_pixels(dst_row + x + xi, (blended & blue) | (s & ~blue));
 			}
 		}
 	}
@@ -423,16 +737,16 @@ void iced_blur_filter( SDL_Surface *dst, SDL_Surface *src )
 	
 	for (int y = 0; y < 184; ++y)
 	{
-		for (int x = 0; x < 320; ++x)
+		for (int x = 0; x < 320; x += 4)
 		{
 			// value is average value of source pixel and destination pixel
 			// hue is icy blue
 			
-			const Uint8 value = (*src_pixel & 0x0f) + (*dst_pixel & 0x0f);
-			*dst_pixel = (value / 2) | 0x80;
+			const Uint32 value = (load_pixels(src_pixel) & SWAR_LANES(0x0f)) + (load_pixels(dst_pixel) & SWAR_LANES(0x0f));
+			store_pixels(dst_pixel, ((value >> 1) & SWAR_LANES(0x0f)) | SWAR_LANES(0x80));
 			
-			++dst_pixel;
-			++src_pixel;
+			dst_pixel += 4;
+			src_pixel += 4;
 		}
 		
 		dst_pixel += (dst->pitch - 320);  // in case pitch is not 320
@@ -449,16 +763,17 @@ void blur_filter( SDL_Surface *dst, SDL_Surface *src )
 	
 	for (int y = 0; y < 184; ++y)
 	{
-		for (int x = 0; x < 320; ++x)
+		for (int x = 0; x < 320; x += 4)
 		{
 			// value is average value of source pixel and destination pixel
 			// hue is source pixel hue
 			
-			const Uint8 value = (*src_pixel & 0x0f) + (*dst_pixel & 0x0f);
-			*dst_pixel = (value / 2) | (*src_pixel & 0xf0);
+			const Uint32 s = load_pixels(src_pixel);
+			const Uint32 value = (s & SWAR_LANES(0x0f)) + (load_pixels(dst_pixel) & SWAR_LANES(0x0f));
+			store_pixels(dst_pixel, ((value >> 1) & SWAR_LANES(0x0f)) | (s & SWAR_LANES(0xf0)));
 			
-			++dst_pixel;
-			++src_pixel;
+			dst_pixel += 4;
+			src_pixel += 4;
 		}
 		
 		dst_pixel += (dst->pitch - 320);  // in case pitch is not 320
@@ -20,10 +20,17 @@
 #define BACKGRND_H
 
 #include "opentyr.h"
+#include "varz.h"
 
 #include <stdint.h>
 #include "SDL3/SDL.h"
 
+// Keep every visible row of map tiles rasterized into a strip per layer, so
+// drawing a layer is mostly row copies instead of per-tile blits.
+#ifndef BACKGROUND_CACHE
+#define BACKGROUND_CACHE 1
+#endif
+
 extern JE_word backPos, backPos2, backPos3;
 extern JE_word backMove, backMove2, backMove3;
 extern JE_word mapX, mapY, mapX2, mapX3, mapY2, mapY3;
@@ -38,6 +45,8 @@ extern int starfield_speed;
 
 void JE_darkenBackground( JE_word neat );
 
+void init_tile_info( JE_TileInfo *info, const Uint8 *data );
+
 void blit_background_row( SDL_Surface *surface, int x, int y, Uint8 **map );
 void blit_background_row_blend( SDL_Surface *surface, int x, int y, Uint8 **map );
 
@@ -46,6 +55,8 @@ void draw_background_2( SDL_Surface *surface );
 void draw_background_2_blend( SDL_Surface *surface );
 void draw_background_3( SDL_Surface *surface );
 
+void invalidate_background_cache( void );
+
 void JE_filterScreen( JE_shortint col, JE_shortint generic_int );
 
 void JE_checkSmoothies( void );
@@ -687,7 +687,9 @@ void JE_decryptSaveTemp( void )
 
 const char *get_user_directory( void )
 {
+#ifdef ESP_PLATFORM
 	return "/sd/tyrian";
+#endif
 	static char user_dir[500] = "";
 	//strcpy(user_dir, "/sd/tyrian");
 	
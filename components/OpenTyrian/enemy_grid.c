@@ -0,0 +1,123 @@
+/*
+ * OpenTyrian: A modern cross-platform port of Tyrian
+ * Copyright (C) 2007-2009  The OpenTyrian Development Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+#include "enemy_grid.h"
+#include "varz.h"
+
+#include <string.h>
+
+#define GRID_CELL_SHIFT 5  // 32 pixel cells, a little wider than the largest hitbox
+#define GRID_COLS ((320 + 31) >> GRID_CELL_SHIFT)
+#define GRID_ROWS ((200 + 31) >> GRID_CELL_SHIFT)
+#define GRID_WORDS ((COUNTOF(enemy) + 31) / 32)
+
+// one bit per enemy slot, so a union of cells keeps the slot order
+typedef struct
+{
+	Uint32 bits[GRID_WORDS];
+} EnemySet;
+
+static EnemySet grid[GRID_ROWS][GRID_COLS];
+static EnemySet selected;
+static unsigned int live_enemies;
+
+static Uint32 pair_tests, full_scan_tests;
+
+static inline int grid_col( int x )
+{
+	return (x < 0) ? 0 : (x >> GRID_CELL_SHIFT >= GRID_COLS) ? GRID_COLS - 1 : x >> GRID_CELL_SHIFT;
+}
+
+static inline int grid_row( int y )
+{
+	return (y < 0) ? 0 : (y >> GRID_CELL_SHIFT >= GRID_ROWS) ? GRID_ROWS - 1 : y >> GRID_CELL_SHIFT;
+}
+
+static void grid_insert( unsigned int b )
+{
+	EnemySet *cell = &grid[grid_row(enemy[b].ey)][grid_col(enemy[b].ex + enemy[b].mapoffset)];
+	cell->bits[b / 32] |= 1u << (b % 32);
+}
+
+void enemy_grid_build( void )
+{
+	memset(grid, 0, sizeof(grid));
+	memset(&selected, 0, sizeof(selected));
+	live_enemies = 0;
+
+	for (unsigned int b = 0; b < COUNTOF(enemy); b++)
+	{
+		if (enemyAvail[b] == 0)
+		{
+			grid_insert(b);
+			live_enemies++;
+		}
+	}
+}
+
+void enemy_grid_add( unsigned int b )
+{
+	grid_insert(b);
+	selected.bits[b / 32] |= 1u << (b % 32);
+	live_enemies++;
+}
+
+void enemy_grid_query( int x1, int y1, int x2, int y2 )
+{
+	const int c1 = grid_col(x1), c2 = grid_col(x2);
+	const int r1 = grid_row(y1), r2 = grid_row(y2);
+
+	memset(&selected, 0, sizeof(selected));
+	for (int r = r1; r <= r2; r++)
+		for (int c = c1; c <= c2; c++)
+			for (unsigned int w = 0; w < GRID_WORDS; w++)
+				selected.bits[w] |= grid[r][c].bits[w];
+
+	full_scan_tests += live_enemies;
+}
+
+int enemy_grid_next( int b )
+{
+	unsigned int i = b + 1;
+
+	while (i < COUNTOF(enemy))
+	{
+		const Uint32 word = selected.bits[i / 32] >> (i % 32);
+		if (word == 0)
+		{
+			i = (i / 32 + 1) * 32;
+			continue;
+		}
+
+		i += __builtin_ctz(word);
+		if (enemyAvail[i] == 0)
+		{
+			pair_tests++;
+			return i;
+		}
+		i++;
+	}
+
+	return -1;
+}
+
+void get_collision_stats( Uint32 *pair_tests_out, Uint32 *full_scan_tests_out )
+{
+	*pair_tests_out = pair_tests;
+	*full_scan_tests_out = full_scan_tests;
+}
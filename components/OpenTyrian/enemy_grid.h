@@ -0,0 +1,49 @@
+/*
+ * OpenTyrian: A modern cross-platform port of Tyrian
+ * Copyright (C) 2007-2009  The OpenTyrian Development Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+#ifndef ENEMY_GRID_H
+#define ENEMY_GRID_H
+
+#include "opentyr.h"
+
+#include "SDL3/SDL.h"
+
+// Broadphase for player shots against enemies: a uniform grid over the
+// playfield, each cell holding the set of enemy slots whose position
+// (ex + mapoffset, ey) falls in it.  Positions off the playfield go to the
+// edge cells.  A query returns a superset of the enemies the exact test can
+// accept, in slot order, so hits resolve exactly as a scan of every slot.
+
+// Rebuilds the grid from enemy[] and enemyAvail[]; once per frame, after
+// the enemies have moved.
+void enemy_grid_build( void );
+// Adds an enemy placed after the build, such as one spawned by a kill.
+// It also joins the current query, as the full scan would have reached it.
+void enemy_grid_add( unsigned int b );
+
+// Selects the live enemies whose position may lie within the given bounds,
+// inclusive.
+void enemy_grid_query( int x1, int y1, int x2, int y2 );
+// The next selected live enemy after b (start from -1), or -1 when done.
+int enemy_grid_next( int b );
+
+// Shot/enemy pairs tested since startup, and how many a scan of every live
+// enemy per shot would have tested; both wrap.
+void get_collision_stats( Uint32 *pair_tests, Uint32 *full_scan_tests );
+
+#endif /* ENEMY_GRID_H */
@@ -21,10 +21,13 @@
 #include "varz.h"
 
 #include "SDL3/SDL.h"
+#include <dirent.h>
 #include <errno.h>
 #include <stdio.h>
 #include <string.h>
+#include <sys/stat.h>
 
+#ifdef ESP_PLATFORM
 // #include "esp_vfs_fat.h"
 #include "esp_vfs.h"
 #include "esp_littlefs.h"
@@ -36,6 +39,7 @@
 #define PIN_NUM_MOSI CONFIG_HW_SD_PIN_NUM_MOSI
 #define PIN_NUM_CLK  CONFIG_HW_SD_PIN_NUM_CLK
 #define PIN_NUM_CS   CONFIG_HW_SD_PIN_NUM_CS
+#endif
 
 const char *custom_data_dir = NULL;
 
@@ -83,6 +87,7 @@ void listFiles(const char *dirname) {
 
 
 void SDL_InitFS(void) {
+#ifdef ESP_PLATFORM
     printf("Initialising File System\n");
 
     // Define the LittleFS configuration
@@ -102,6 +107,8 @@ void SDL_InitFS(void) {
         printf("Listing files in /:\n");
         listFiles("/sd");
     }
+#endif
+    // host builds (tools/headless) read the data from the local filesystem
 }
 
 void Init_SD()
@@ -114,7 +121,9 @@ void Init_SD()
 // finds the Tyrian data directory
 const char *data_dir( void )
 {
+#ifdef ESP_PLATFORM
 	return "/sd/tyrian/data";
+#endif
 	const char *dirs[] =
 	{
 		"/sd/tyrian/data",
@@ -26,10 +26,14 @@
 #include "SDL3/SDL.h"
 #include "SDL3/SDL_events.h"
 #include "SDL3/SDL_keyboard.h"
+#ifdef ESP_PLATFORM
 #include "SDL_internal.h"
 #include "events/SDL_keyboard_c.h"
+#endif
+
 #include <stdio.h>
 
+#ifdef ESP_PLATFORM
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/event_groups.h"
@@ -51,6 +55,7 @@ sem_t usb_task_semaphore;
 pthread_t usb_event_thread;  // Thread for handling HID events
 
 static const char *TAG = "keyboard";
+#endif
 
 JE_boolean ESCPressed;
 
@@ -71,9 +76,11 @@ bool input_grab_enabled = true;
 bool input_grab_enabled = false;
 #endif
 
+#ifdef ESP_PLATFORM
 QueueHandle_t app_event_queue = NULL;
 
 #define APP_QUIT_PIN                GPIO_NUM_0
+#endif
 
 void flush_events_buffer( void )
 {
@@ -87,6 +94,7 @@ void wait_noinput( JE_boolean keyboard, JE_boolean mouse, JE_boolean joystick )
 {
 }
 
+#ifdef ESP_PLATFORM
 typedef enum {
     APP_EVENT = 0,
     APP_EVENT_HID_HOST
@@ -228,6 +236,8 @@ SDL_Scancode convert_hid_to_sdl_scancode(uint8_t hid_code) {
     }
 }
 
+#endif /* ESP_PLATFORM */
+
 char convert_sdl_scancode_to_ascii(SDL_Scancode scancode, bool shift_pressed) {
     switch (scancode) {
         // Alphabet (A-Z)
@@ -310,6 +320,7 @@ char convert_sdl_scancode_to_ascii(SDL_Scancode scancode, bool shift_pressed) {
     }
 }
 
+#ifdef ESP_PLATFORM
 #include "../src/events/SDL_keyboard_c.h"
 
 static void key_event_callback(key_event_t *key_event)
@@ -714,6 +725,22 @@ void init_keyboard(void)
     pthread_detach(usb_event_thread);
 }
 
+#else /* !ESP_PLATFORM */
+
+// host builds (tools/headless) have no USB HID stack; input arrives, if at
+// all, through SDL_PollEvent in service_SDL_events
+void process_keyboard()
+{
+}
+
+void init_keyboard(void)
+{
+    newkey = newmouse = false;
+    keydown = mousedown = false;
+}
+
+#endif /* ESP_PLATFORM */
+
 void input_grab( bool enable )
 {
 
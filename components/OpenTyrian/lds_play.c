@@ -79,6 +79,7 @@ static Uint8 fmchip[0xff], jumping, fadeonoff, allvolume, hardfade, tempo_now, p
 static Uint16 posplay, jumppos, speed;
 static Uint16 *patterns = NULL;
 static Uint16 numpatch, numposi, mainvolume;
+static int started_position;
 
 bool playing, songlooped;
 
@@ -251,6 +252,7 @@ int lds_update( void )
 	int i;
 	Channel *c;
 
+	started_position = -1;
 	if(!playing) return false;
 
 	/* handle fading */
@@ -297,6 +299,7 @@ int lds_update( void )
 	/* handle notes */
 	if(!tempo_now && positions)
 	{
+		if(!pattplay) started_position = posplay;
 		vbreak = false;
 		for(chan = 0; chan < 9; chan++)
 		{
@@ -651,6 +654,11 @@ int lds_update( void )
 	return (!playing || songlooped) ? false : true;
 }
 
+int lds_started_position( void )
+{
+	return started_position;
+}
+
 void lds_playsound(int inst_number, int channel_number, int tunehigh)
 {
 	Channel		*c = &channel[channel_number];		/* current channel */
@@ -30,6 +30,9 @@ bool lds_load( FILE *f, unsigned int music_offset, unsigned int music_size );
 void lds_free( void );
 void lds_rewind( void );
 
+// the position whose first row the last lds_update() played, or -1
+int lds_started_position( void );
+
 #define REFRESH 70.0f
 
 /*unsigned int getorders() { return numposi; }
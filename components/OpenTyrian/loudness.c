@@ -19,10 +19,19 @@
 #include "file.h"
 #include "lds_play.h"
 #include "loudness.h"
+#include "mix.h"
+#include "music_cache.h"
 #include "nortsong.h"
 #include "opentyr.h"
 #include "params.h"
 
+#include <stdatomic.h>
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
 float music_volume = 0, sample_volume = 0;
 float volume = 0;
 
@@ -37,12 +46,6 @@ Uint32 *song_offset;
 Uint16 song_count = 0;
 
 
-SAMPLE_TYPE *channel_buffer[SFX_CHANNELS] = { NULL };
-SAMPLE_TYPE *channel_pos[SFX_CHANNELS] = { NULL };
-Uint32 channel_len[SFX_CHANNELS] = { 0 };
-Uint8 channel_vol[SFX_CHANNELS];
-
-
 int sound_init_state = false;
 int freq = 11025 * OUTPUT_QUALITY;
 
@@ -51,188 +54,531 @@ SDL_AudioStream *audio_stream = NULL;
 void audio_cb( void *userdata, unsigned char *feedme, int howmuch );
 
 void load_song( unsigned int song_num );
-SDL_AudioDeviceID dev_id;
+
+/*
+ * The OPL emulation runs in its own task, rendering music a few blocks ahead
+ * of the audio callback, which only copies finished blocks out.  The game
+ * thread never touches the player: it posts commands that the task picks up
+ * between blocks.  Both rings have a single producer and a single consumer,
+ * so a pair of counters is all the synchronisation they need.
+ */
+#define MUSIC_TASK_CORE (portNUM_PROCESSORS - 1)  // the present task's, off the game's core 0
+#define MUSIC_TASK_STACK 12288  // adlib_getsample() keeps three block buffers on the stack
+#define MUSIC_TASK_PRIORITY 6  // a late frame is less noticeable than a gap
+
+#define MUSIC_BLOCKS 8
+#define MUSIC_BLOCK_SAMPLES MUSIC_CACHE_BLOCK_SAMPLES  // ~12 ms each at 44 kHz
+#define MUSIC_COMMANDS 16
+
+typedef struct
+{
+    Uint32 generation;  // music_generation the block was rendered for
+    SAMPLE_TYPE samples[MUSIC_BLOCK_SAMPLES];
+}
+MusicBlock;
+
+typedef enum
+{
+    MUSIC_PLAY,
+    MUSIC_STOP,
+    MUSIC_FADE,
+    MUSIC_QUIT,
+}
+MusicCommandType;
+
+typedef struct
+{
+    Uint8 type;
+    bool load;
+    Uint16 song;
+    Uint32 generation;
+}
+MusicCommand;
+
+DRAM_ATTR static MusicBlock music_blocks[MUSIC_BLOCKS];
+static atomic_uint music_blocks_written = 0, music_blocks_read = 0;
+static unsigned int music_block_offset = 0;  // samples of the oldest block already played
+
+static MusicCommand music_commands[MUSIC_COMMANDS];
+static atomic_uint music_commands_written = 0, music_commands_read = 0;
+
+// bumped whenever the game changes song, so blocks rendered ahead for the
+// old one are dropped instead of played
+static atomic_uint music_generation = 0;
+
+static atomic_uint music_underruns = 0;
+
+// owned by the music task: whether the song plays from the cache, and how
+// much of it the emulator has rendered, which the cache recorder needs
+static bool music_cached = false;
+static Uint32 music_rendered = 0;
+
+static TaskHandle_t music_task = NULL;
+static SemaphoreHandle_t music_task_done = NULL;
+
+/*
+ * Sound effects play in place out of the arena JE_loadSndFile() fills,
+ * resampled from 11 kHz as they are mixed, so the callback never allocates
+ * or frees.  The game posts triggers through a ring like the music
+ * commands; the callback starts them before each mix.
+ */
+#define SFX_RATE 11025
+#define SFX_TRIGGERS 16
+
+typedef struct
+{
+    const Sint8 *data;  // NULL while the channel is idle
+    Uint32 length;      // in source samples
+    Uint32 position;    // in source samples, 16.16
+    Uint8 vol;          // 1..8
+}
+SfxVoice;
+
+typedef struct
+{
+    const Sint8 *data;
+    Uint16 length;
+    Uint8 chan, vol;
+}
+SfxTrigger;
+
+static SfxVoice sfx_voices[SFX_CHANNELS];  // owned by the audio callback
+static SAMPLE_TYPE sfx_scratch[MUSIC_BLOCK_SAMPLES] __attribute__((aligned(16)));
+static Uint32 sfx_step;  // source samples per output sample, 16.16
+
+static SfxTrigger sfx_triggers[SFX_TRIGGERS];
+static atomic_uint sfx_triggers_written = 0, sfx_triggers_read = 0;
+
+static atomic_uint sample_level = 0;  // effects volume, 0..255
+
+static void music_task_main( void *arg );
+static void SDLCALL audio_stream_cb( void *userdata, SDL_AudioStream *stream, int additional_amount, int total_amount );
 
 bool init_audio(void) {
     if (audio_disabled)
         return false;
 
- /*   SDL_AudioSpec ask, got;
+    if (!SDL_InitSubSystem(SDL_INIT_AUDIO)) {
+        fprintf(stderr, "error: failed to initialize SDL audio: %s\n", SDL_GetError());
+        audio_disabled = true;
+        return false;
+    }
 
+    SDL_AudioSpec ask;
     ask.freq = freq;
     ask.format = (BYTES_PER_SAMPLE == 2) ? SDL_AUDIO_S16 : SDL_AUDIO_S8;
     ask.channels = 1;
 
     printf("\trequested %d Hz, %d channels\n", ask.freq, ask.channels);
 
-    // Update to SDL3 OpenAudioDevice
-    dev_id = SDL_OpenAudioDevice(0, &ask);
-    if (dev_id == 0) {
-        fprintf(stderr, "error: failed to initialize SDL audio: %s\n", SDL_GetError());
+    // the stream converts to whatever the device wants
+    audio_stream = SDL_OpenAudioDeviceStream(SDL_AUDIO_DEVICE_DEFAULT_PLAYBACK, &ask, audio_stream_cb, NULL);
+    if (!audio_stream) {
+        fprintf(stderr, "error: failed to open SDL audio stream: %s\n", SDL_GetError());
         audio_disabled = true;
         return false;
     }
 
-    printf("\tobtained  %d Hz, %d channels\n", got.freq, got.channels);
+    sfx_step = ((Uint32)SFX_RATE << 16) / freq;
 
-    // Create Audio Stream
-    audio_stream = SDL_CreateAudioStream(&ask, &got);
-    if (!audio_stream) {
-        fprintf(stderr, "error: failed to create SDL_AudioStream: %s\n", SDL_GetError());
-        audio_disabled = true;
-        return false;
+    opl_init();
+    music_cache_init();
+
+    music_task_done = xSemaphoreCreateBinary();
+    if (music_task_done == NULL ||
+        xTaskCreatePinnedToCore(music_task_main, "music", MUSIC_TASK_STACK, NULL, MUSIC_TASK_PRIORITY, &music_task, MUSIC_TASK_CORE) != pdPASS)
+    {
+        fprintf(stderr, "error: failed to create music task\n");
+        music_task = NULL;
+        music_disabled = true;
     }
 
-    opl_init();
+    SDL_ResumeAudioStreamDevice(audio_stream);  // Start playing audio
 
-    SDL_PauseAudioDevice(dev_id);  // Start playing audio
-*/
     return true;
 }
 
-IRAM_ATTR void audio_cb(void *user_data, unsigned char *sdl_buffer, int howmuch)
+static void post_music_command( MusicCommand command )
 {
-    (void)user_data;
+    if (music_task == NULL)
+        return;
+
+    const unsigned int written = atomic_load_explicit(&music_commands_written, memory_order_relaxed);
+
+    // only happens if the task is stuck; it drains the whole queue between blocks
+    while (written - atomic_load_explicit(&music_commands_read, memory_order_acquire) == MUSIC_COMMANDS)
+        vTaskDelay(1);
+
+    music_commands[written % MUSIC_COMMANDS] = command;
+    atomic_store_explicit(&music_commands_written, written + 1, memory_order_release);
+
+    xTaskNotifyGive(music_task);
+}
+
+static bool take_music_command( MusicCommand *command )
+{
+    const unsigned int read = atomic_load_explicit(&music_commands_read, memory_order_relaxed);
 
+    if (read == atomic_load_explicit(&music_commands_written, memory_order_acquire))
+        return false;
+
+    *command = music_commands[read % MUSIC_COMMANDS];
+    atomic_store_explicit(&music_commands_read, read + 1, memory_order_release);
+    return true;
+}
+
+static void render_music( SAMPLE_TYPE *music_pos, long remaining )
+{
     static long ct = 0;
 
-    SAMPLE_TYPE *feedme = (SAMPLE_TYPE *)sdl_buffer;
-    music_disabled = true;
-    if (!music_disabled && !music_stopped)
+    while (remaining > 0)
+    {
+        while (ct < 0)
+        {
+            ct += freq;
+            const bool looped = songlooped;
+            lds_update();
+            music_cache_record_tick(music_rendered, looped);
+        }
+
+        long i = (long)((ct / REFRESH) + 4) & ~3;
+        i = (i > remaining) ? remaining : i;
+        opl_update((SAMPLE_TYPE *)music_pos, i);
+        music_pos += i;
+        music_rendered += i;
+        remaining -= i;
+        ct -= (long)(REFRESH * i);
+    }
+}
+
+static void music_task_main( void *arg )
+{
+    (void)arg;
+
+    bool rendering = false;
+    Uint32 generation = 0;
+    long fade_remaining = 0;  // samples left until a fade reaches silence
+
+    for (;;)
     {
-        SAMPLE_TYPE *music_pos = feedme;
-        long remaining = howmuch / BYTES_PER_SAMPLE;
-        while (remaining > 0)
+        MusicCommand command;
+        while (take_music_command(&command))
         {
-            while (ct < 0)
+            switch (command.type)
             {
-                ct += freq;
-                lds_update();
+            case MUSIC_PLAY:
+                if (command.load)
+                    load_song(command.song);
+                generation = command.generation;
+                rendering = true;
+                fade_remaining = 0;
+                break;
+
+            case MUSIC_STOP:
+                rendering = false;
+                break;
+
+            case MUSIC_FADE:
+                if (rendering && fade_remaining == 0)
+                    fade_remaining = freq;  // one second
+                break;
+
+            case MUSIC_QUIT:
+                music_cache_record_abort();
+                music_cache_close();
+                xSemaphoreGive(music_task_done);
+                vTaskDelete(NULL);
+                return;
             }
-
-            long i = (long)((ct / REFRESH) + 4) & ~3;
-            i = (i > remaining) ? remaining : i;
-            opl_update((SAMPLE_TYPE *)music_pos, i);
-            music_pos += i;
-            remaining -= i;
-            ct -= (long)(REFRESH * i);
         }
 
-        int qu = howmuch / BYTES_PER_SAMPLE;
-        for (int smp = 0; smp < qu; smp++)
+        const unsigned int written = atomic_load_explicit(&music_blocks_written, memory_order_relaxed);
+
+        if (rendering && written - atomic_load_explicit(&music_blocks_read, memory_order_acquire) < MUSIC_BLOCKS)
         {
-            feedme[smp] *= music_volume;
+            MusicBlock *block = &music_blocks[written % MUSIC_BLOCKS];
+
+            if (music_cached)
+            {
+                music_cache_read(block->samples);
+            }
+            else
+            {
+                render_music(block->samples, MUSIC_BLOCK_SAMPLES);
+                music_cache_record_block(block->samples);
+            }
+
+            if (fade_remaining > 0)
+            {
+                for (unsigned int smp = 0; smp < MUSIC_BLOCK_SAMPLES; smp++)
+                {
+                    block->samples[smp] = (Sint32)block->samples[smp] * fade_remaining / freq;
+                    if (fade_remaining > 0)
+                        --fade_remaining;
+                }
+                if (fade_remaining == 0)
+                    rendering = false;
+            }
+
+            block->generation = generation;
+            atomic_store_explicit(&music_blocks_written, written + 1, memory_order_release);
+            continue;
         }
+
+        // woken by a new command or by the callback freeing a block
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
     }
-    samples_disabled = false;
-    if (!samples_disabled)
+}
+
+// Copies rendered music out of the ring, padding with silence if the task
+// has fallen behind.  Never waits: this runs on the audio device's thread.
+static void IRAM_ATTR read_music( SAMPLE_TYPE *feedme, unsigned int count )
+{
+    const unsigned int generation = atomic_load(&music_generation);
+
+    while (count > 0)
     {
-        for (int ch = 0; ch < SFX_CHANNELS; ch++)
+        const unsigned int read = atomic_load_explicit(&music_blocks_read, memory_order_relaxed);
+
+        if (read == atomic_load_explicit(&music_blocks_written, memory_order_acquire))
         {
-            volume = sample_volume * (channel_vol[ch] / (float)SFX_CHANNELS);
+            memset(feedme, 0, count * sizeof(*feedme));
+            if (!music_stopped)
+                atomic_fetch_add(&music_underruns, 1);
+            return;
+        }
 
-            unsigned int qu = ((unsigned)howmuch > channel_len[ch] ? channel_len[ch] : (unsigned)howmuch) / BYTES_PER_SAMPLE;
-            for (unsigned int smp = 0; smp < qu; smp++)
-            {
-#if (BYTES_PER_SAMPLE == 2)
-                Sint64 clip = (Sint32)feedme[smp] + (Sint32)(channel_pos[ch][smp] * volume);
-                feedme[smp] = (clip > 0x7fff) ? 0x7fff : (clip <= -0x8000) ? -0x8000 : (Sint16)clip;
-#else
-                Sint16 clip = (Sint16)feedme[smp] + (Sint16)(channel_pos[ch][smp] * volume);
-                feedme[smp] = (clip > 0x7f) ? 0x7f : (clip <= -0x80) ? -0x80 : (Sint8)clip;
-#endif
-            }
+        const MusicBlock *block = &music_blocks[read % MUSIC_BLOCKS];
 
-            channel_pos[ch] += qu;
-            channel_len[ch] -= qu * BYTES_PER_SAMPLE;
+        if (block->generation == generation)
+        {
+            unsigned int n = MUSIC_BLOCK_SAMPLES - music_block_offset;
+            n = (n > count) ? count : n;
+            memcpy(feedme, &block->samples[music_block_offset], n * sizeof(*feedme));
+            feedme += n;
+            count -= n;
+            music_block_offset += n;
+        }
+        else
+        {
+            music_block_offset = MUSIC_BLOCK_SAMPLES;  // left over from an older song
+        }
 
-            if (channel_len[ch] == 0)
-            {
-                free(channel_buffer[ch]);
-                channel_buffer[ch] = channel_pos[ch] = NULL;
-            }
+        if (music_block_offset == MUSIC_BLOCK_SAMPLES)
+        {
+            music_block_offset = 0;
+            atomic_store_explicit(&music_blocks_read, read + 1, memory_order_release);
+            xTaskNotifyGive(music_task);
         }
     }
+}
+
+// Starts the effects the game has triggered since the last callback.  A new
+// effect on a busy channel cuts off the one playing there.
+static void IRAM_ATTR take_sfx_triggers( void )
+{
+    unsigned int read = atomic_load_explicit(&sfx_triggers_read, memory_order_relaxed);
+    const unsigned int written = atomic_load_explicit(&sfx_triggers_written, memory_order_acquire);
+
+    for (; read != written; ++read)
+    {
+        const SfxTrigger *trigger = &sfx_triggers[read % SFX_TRIGGERS];
+        SfxVoice *voice = &sfx_voices[trigger->chan];
+
+        voice->data = trigger->data;
+        voice->length = trigger->length;
+        voice->position = 0;
+        voice->vol = trigger->vol;
+    }
+
+    atomic_store_explicit(&sfx_triggers_read, read, memory_order_release);
+}
+
+// Resamples one effect into sfx_scratch at its volume; returns how many
+// samples it had left, up to count.
+static unsigned int IRAM_ATTR render_sfx( SfxVoice *voice, Sint32 level, unsigned int count )
+{
+    // sample_volume * vol / SFX_CHANNELS, in Q15; at most one, so the
+    // results always fit
+    const Sint32 gain = (level * voice->vol << 15) / (255 * SFX_CHANNELS);
+
+    const Sint8 *data = voice->data;
+    const Uint32 last = voice->length - 1, end = voice->length << 16;
+    Uint32 position = voice->position;
+
+    unsigned int smp = 0;
+    for (; smp < count && position < end; smp++, position += sfx_step)
+    {
+        // linear interpolation between neighbouring source samples, in 8.8
+        const Uint32 i = position >> 16;
+        const Sint32 a = data[i], b = (i < last) ? data[i + 1] : a;
+        const Sint32 sample = (a << 8) + (b - a) * (Sint32)((position >> 8) & 0xff);
+
+        sfx_scratch[smp] = (sample * gain) >> 15;
+    }
 
-    // Use SDL_AudioStream for conversion
-    if (audio_stream) {
-        SDL_PutAudioStreamData(audio_stream, sdl_buffer, howmuch);
-        int converted_size = SDL_GetAudioStreamData(audio_stream, sdl_buffer, howmuch);
-        if (converted_size < 0) {
-            fprintf(stderr, "error: SDL_GetAudioStreamData failed: %s\n", SDL_GetError());
+    voice->position = position;
+    if (position >= end)
+        voice->data = NULL;
+
+    return smp;
+}
+
+static void IRAM_ATTR mix_sfx( SAMPLE_TYPE *feedme, unsigned int count )
+{
+    const Sint32 level = atomic_load_explicit(&sample_level, memory_order_relaxed);
+
+    for (unsigned int done = 0; done < count; done += MUSIC_BLOCK_SAMPLES)
+    {
+        const unsigned int n = (count - done > MUSIC_BLOCK_SAMPLES) ? MUSIC_BLOCK_SAMPLES : count - done;
+
+        for (int ch = 0; ch < SFX_CHANNELS; ch++)
+        {
+            if (sfx_voices[ch].data != NULL)
+                mix_add_s16(&feedme[done], sfx_scratch, render_sfx(&sfx_voices[ch], level, n));
         }
     }
 }
 
+IRAM_ATTR void audio_cb(void *user_data, unsigned char *sdl_buffer, int howmuch)
+{
+    (void)user_data;
+
+    SAMPLE_TYPE *feedme = (SAMPLE_TYPE *)sdl_buffer;
+    const unsigned int count = howmuch / BYTES_PER_SAMPLE;
+
+    memset(sdl_buffer, 0, howmuch);
+    if (!music_disabled && music_task != NULL)
+    {
+        read_music(feedme, count);
+        // volumes go to Q15 once per callback, not per sample
+        mix_scale_s16(feedme, count, mix_gain_q15(music_volume));
+    }
+    samples_disabled = false;
+    if (!samples_disabled)
+    {
+        take_sfx_triggers();
+        mix_sfx(feedme, count);
+    }
+}
+
+// SDL asks for more whenever its queue runs low; mix it a block at a time.
+static void SDLCALL audio_stream_cb( void *userdata, SDL_AudioStream *stream, int additional_amount, int total_amount )
+{
+    (void)total_amount;
+
+    // aligned for the vector mix kernels
+    static SAMPLE_TYPE mix_buffer[MUSIC_BLOCK_SAMPLES] __attribute__((aligned(16)));
+
+    while (additional_amount > 0)
+    {
+        int howmuch = (additional_amount > (int)sizeof(mix_buffer)) ? (int)sizeof(mix_buffer) : additional_amount;
+        howmuch &= ~(BYTES_PER_SAMPLE - 1);
+        if (howmuch == 0)
+            howmuch = BYTES_PER_SAMPLE;
+
+        audio_cb(userdata, (unsigned char *)mix_buffer, howmuch);
+        SDL_PutAudioStreamData(stream, mix_buffer, howmuch);
+
+        additional_amount -= howmuch;
+    }
+}
+
+void get_music_stats( Uint32 *underruns )
+{
+    *underruns = atomic_load(&music_underruns);
+}
+
 void deinit_audio(void) {
     if (audio_disabled)
         return;
-/*
-    SDL_PauseAudioDevice(dev_id);  // Pause audio
 
-    SDL_CloseAudioDevice(dev_id);  // Close audio device
+    SDL_DestroyAudioStream(audio_stream);  // closes the device, no more callbacks
+    audio_stream = NULL;
 
-    if (audio_stream) {
-        SDL_DestroyAudioStream(audio_stream);  // Destroy the audio stream
-        audio_stream = NULL;
+    if (music_task != NULL)
+    {
+        post_music_command((MusicCommand){ .type = MUSIC_QUIT });
+        xSemaphoreTake(music_task_done, portMAX_DELAY);
+        music_task = NULL;
     }
-
-    for (unsigned int i = 0; i < SFX_CHANNELS; i++) {
-        free(channel_buffer[i]);
-        channel_buffer[i] = channel_pos[i] = NULL;
-        channel_len[i] = 0;
+    if (music_task_done != NULL)
+    {
+        vSemaphoreDelete(music_task_done);
+        music_task_done = NULL;
     }
+    music_cache_quit();
+
+    // the samples belong to the arena; just forget what was playing
+    atomic_store(&sfx_triggers_read, atomic_load(&sfx_triggers_written));
+    for (unsigned int i = 0; i < SFX_CHANNELS; i++)
+        sfx_voices[i].data = NULL;
 
     lds_free();
-	*/
 }
 
 
 void load_music( void )
 {
-	// if (music_file == NULL)
-	// {
-	// 	music_file = dir_fopen_die(data_dir(), "music.mus", "rb");
+	if (music_file == NULL)
+	{
+		music_file = dir_fopen_die(data_dir(), "music.mus", "rb");
 		
-	// 	efread(&song_count, sizeof(song_count), 1, music_file);
+		efread(&song_count, sizeof(song_count), 1, music_file);
 		
-	// 	song_offset = malloc((song_count + 1) * sizeof(*song_offset));
+		song_offset = malloc((song_count + 1) * sizeof(*song_offset));
 		
-	// 	efread(song_offset, 4, song_count, music_file);
-	// 	song_offset[song_count] = ftell_eof(music_file);
-
-	// }
+		efread(song_offset, 4, song_count, music_file);
+		song_offset[song_count] = ftell_eof(music_file);
+	}
 }
 
+// called from the music task, which owns the player and music_file
 void load_song( unsigned int song_num )
 {
 	if (audio_disabled)
 		return;
 	
-	/*SDL_LockAudio();
+	music_cache_record_abort();
+	music_cache_close();
+	music_cached = false;
 	
 	if (song_num < song_count)
 	{
 		unsigned int song_size = song_offset[song_num + 1] - song_offset[song_num];
-		lds_load(music_file, song_offset[song_num], song_size);
+		
+		// play the recording from an earlier run if there is one, otherwise
+		// render the song and record it for next time
+		music_cached = music_cache_open(song_num, song_size, freq);
+		if (!music_cached && lds_load(music_file, song_offset[song_num], song_size))
+		{
+			music_rendered = 0;
+			music_cache_record_begin(song_num, song_size, freq);
+		}
 	}
 	else
 	{
 		fprintf(stderr, "warning: failed to load song %d\n", song_num + 1);
 	}
-	
-	SDL_UnlockAudio();
-	*/
 }
 
 void play_song( unsigned int song_num )
 {
-	if (song_num != song_playing)
-	{
-		load_song(song_num);
-		song_playing = song_num;
-	}
+	static unsigned int song_loaded = -1;  // last song the task was asked to load
+	
+	if (song_num == song_playing && song_num == song_loaded && !music_stopped)
+		return;
+	
+	MusicCommand command = {
+		.type = MUSIC_PLAY,
+		.load = song_num != song_playing || song_num != song_loaded,
+		.song = song_num,
+		.generation = atomic_fetch_add(&music_generation, 1) + 1,
+	};
+	post_music_command(command);
 	
+	song_loaded = song_num;
+	song_playing = song_num;
 	music_stopped = false;
 }
 
@@ -245,46 +591,43 @@ void restart_song( void )
 
 void stop_song( void )
 {
+	atomic_fetch_add(&music_generation, 1);
+	post_music_command((MusicCommand){ .type = MUSIC_STOP });
+	
 	music_stopped = true;
 }
 
 void fade_song( void )
 {
-	/* STUB: we have no implementation of this to port */
+	post_music_command((MusicCommand){ .type = MUSIC_FADE });
+	
+	// the task stops the song once it is silent; play_song() resumes it
+	music_stopped = true;
 }
 
 void set_volume( unsigned int music, unsigned int sample )
 {
 	music_volume = music * (1.5f / 255.0f);
 	sample_volume = sample * (1.0f / 255.0f);
+	atomic_store_explicit(&sample_level, sample > 255 ? 255 : sample, memory_order_relaxed);
 }
 
 void JE_multiSamplePlay(JE_byte *buffer, JE_word size, JE_byte chan, JE_byte vol)
 {
-	if (audio_disabled || samples_disabled)
+	if (audio_disabled || samples_disabled || buffer == NULL || size == 0 || chan >= SFX_CHANNELS)
 		return;
 	
-// 	SDL_LockAudio();
+	const unsigned int written = atomic_load_explicit(&sfx_triggers_written, memory_order_relaxed);
 	
-// 	free(channel_buffer[chan]);
+	// only fills up if the device has stopped pulling audio; drop the effect
+	if (written - atomic_load_explicit(&sfx_triggers_read, memory_order_acquire) == SFX_TRIGGERS)
+		return;
 	
-// 	channel_len[chan] = size * BYTES_PER_SAMPLE * SAMPLE_SCALING;
-// 	channel_buffer[chan] = malloc(channel_len[chan]);
-// 	channel_pos[chan] = channel_buffer[chan];
-// 	channel_vol[chan] = vol + 1;
-
-// 	for (int i = 0; i < size; i++)
-// 	{
-// 		for (int ex = 0; ex < SAMPLE_SCALING; ex++)
-// 		{
-// #if (BYTES_PER_SAMPLE == 2)
-// 			channel_buffer[chan][(i * SAMPLE_SCALING) + ex] = (Sint8)buffer[i] << 8;
-// #else  /* BYTES_PER_SAMPLE */
-// 			channel_buffer[chan][(i * SAMPLE_SCALING) + ex] = (Sint8)buffer[i];
-// #endif  /* BYTES_PER_SAMPLE */
-// 		}
-// 	}
-
-// 	SDL_UnlockAudio();
+	sfx_triggers[written % SFX_TRIGGERS] = (SfxTrigger){
+		.data = (const Sint8 *)buffer,
+		.length = size,
+		.chan = chan,
+		.vol = (vol < SFX_CHANNELS) ? vol + 1 : SFX_CHANNELS,
+	};
+	atomic_store_explicit(&sfx_triggers_written, written + 1, memory_order_release);
 }
-
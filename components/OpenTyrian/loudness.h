@@ -32,7 +32,6 @@
 #define OUTPUT_QUALITY 4  // 44 kHz
 #endif
 
-#define SAMPLE_SCALING OUTPUT_QUALITY
 #define SAMPLE_TYPE Bit16s
 #define BYTES_PER_SAMPLE 2
 
@@ -53,6 +52,10 @@ void fade_song( void );
 
 void set_volume( unsigned int music, unsigned int sample );
 
+// Number of audio callbacks that found no rendered music ready while a song
+// was playing.
+void get_music_stats( Uint32 *underruns );
+
 void JE_multiSamplePlay(JE_byte *buffer, JE_word size, JE_byte chan, JE_byte vol);
 
 #endif /* LOUDNESS_H */
@@ -19,6 +19,7 @@
 #include "backgrnd.h"
 #include "config.h"
 #include "editship.h"
+#include "enemy_grid.h"
 //extern "C" {
 #include "episodes.h"
 //}
@@ -1797,7 +1798,24 @@ void adjust_difficulty( void )
 bool load_next_demo( void )
 {
 	if (++demo_num > 5)
+	{
+		if (benchDemos)
+		{
+			Uint32 ticks, frames, ms;
+			get_frame_stats(&ticks, &frames, &ms);
+			printf("bench: %u ticks, %u frames in %u ms, %.1f ticks/s\n",
+			       (unsigned)ticks, (unsigned)frames, (unsigned)ms, ms ? ticks * 1000.0 / ms : 0.0);
+			Uint32 pair_tests, full_scan_tests;
+			get_collision_stats(&pair_tests, &full_scan_tests);
+			printf("bench: %u shot/enemy pairs tested, %u for a full scan\n",
+			       (unsigned)pair_tests, (unsigned)full_scan_tests);
+			printf("bench: pool high water: enemy shots %u/%u, explosions %u/%u, repeating explosions %u/%u, superpixels %u/%u\n",
+			       enemyShotPool.high_water, enemyShotPool.size, explosionPool.high_water, explosionPool.size,
+			       repExplosionPool.high_water, repExplosionPool.size, superpixelPool.high_water, superpixelPool.size);
+			JE_tyrianHalt(0);
+		}
 		demo_num = 1;
+	}
 
 	char demo_filename[9];
 	snprintf(demo_filename, sizeof(demo_filename), "demo.%d", demo_num);
@@ -1839,6 +1857,12 @@ bool load_next_demo( void )
 	demo_keys_wait = 0;
 	demo_keys = next_demo_keys = 0;
 
+	// the random numbers drawn so far depend on the start time and on how
+	// long the title screen was up; a fixed seed replays the same game
+	// every run, so benchmark numbers are comparable
+	if (benchDemos)
+		mt_srand(demo_num);
+
 	printf("loaded demo '%s'\n", demo_filename);
 
 	return true;
@@ -1875,7 +1899,10 @@ bool read_demo_keys( void )
 {
 	demo_keys = next_demo_keys;
 
-	efread(&demo_keys_wait, sizeof(Uint16), 1, demo_file);
+	// a demo that has fallen out of step with its recording can outlast its
+	// keys; that ends the demo rather than the game
+	if (fread(&demo_keys_wait, sizeof(Uint16), 1, demo_file) != 1)
+		return false;
 	demo_keys_wait = SDL_Swap16(demo_keys_wait);
 
 	next_demo_keys = getc(demo_file);
@@ -4180,7 +4207,7 @@ void JE_playerCollide( Player *this_player, JE_byte playerNum_ )
 {
 	char tempStr[1024];
 
-	for (int z = 0; z < 100; z++)
+	for (int z = enemy_live_next(0, 100); z >= 0; z = enemy_live_next(z + 1, 100))
 	{
 		if (enemyAvail[z] != 1)
 		{
@@ -0,0 +1,144 @@
+/*
+ * OpenTyrian: A modern cross-platform port of Tyrian
+ * Copyright (C) 2007-2009  The OpenTyrian Development Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+#include "mix.h"
+
+#ifdef ESP_PLATFORM
+#include "sdkconfig.h"
+#endif
+#include "esp_attr.h"
+
+#include <stdbool.h>
+
+#if defined(CONFIG_IDF_TARGET_ESP32S3)
+#define MIX_PIE 1
+#else
+#define MIX_PIE 0
+#endif
+
+#define MIX_VECTOR 8  // samples per 128-bit PIE register
+
+static inline int16_t saturate_s16( int32_t x )
+{
+	return (x > 0x7fff) ? 0x7fff : (x < -0x8000) ? -0x8000 : (int16_t)x;
+}
+
+int32_t mix_gain_q15( float gain )
+{
+	if (!(gain > 0))
+		return 0;
+	if (gain >= (float)MIX_GAIN_MAX / MIX_GAIN_ONE)
+		return MIX_GAIN_MAX;
+	return (int32_t)(gain * MIX_GAIN_ONE + 0.5f);
+}
+
+#if MIX_PIE
+static inline bool pie_aligned( const void *p )
+{
+	return ((uintptr_t)p & 15) == 0;
+}
+
+// ee.vmul.s16 shifts the products right by SAR.  Gains below one cannot
+// overflow; larger ones are applied as x + x * (gain - 1), which saturates
+// in the add, so both paths agree with the C version exactly.
+static void IRAM_ATTR pie_scale_s16( int16_t *samples, unsigned int vectors, int32_t gain )
+{
+	const bool boost = gain >= MIX_GAIN_ONE;
+	const int16_t factor = boost ? gain - MIX_GAIN_ONE : gain;
+
+	if (boost)
+	{
+		__asm__ volatile (
+			"wsr.sar %3\n"
+			"ee.vldbc.16 q1, %2\n"
+			"loopnez %1, 1f\n"
+			"ee.vld.128.ip q0, %0, 0\n"
+			"ee.vmul.s16 q2, q0, q1\n"
+			"ee.vadds.s16 q0, q0, q2\n"
+			"ee.vst.128.ip q0, %0, 16\n"
+			"1:\n"
+			: "+r" (samples)
+			: "r" (vectors), "r" (&factor), "r" (15)
+			: "memory");
+	}
+	else
+	{
+		__asm__ volatile (
+			"wsr.sar %3\n"
+			"ee.vldbc.16 q1, %2\n"
+			"loopnez %1, 1f\n"
+			"ee.vld.128.ip q0, %0, 0\n"
+			"ee.vmul.s16 q0, q0, q1\n"
+			"ee.vst.128.ip q0, %0, 16\n"
+			"1:\n"
+			: "+r" (samples)
+			: "r" (vectors), "r" (&factor), "r" (15)
+			: "memory");
+	}
+}
+
+static void IRAM_ATTR pie_add_s16( int16_t *dst, const int16_t *src, unsigned int vectors )
+{
+	__asm__ volatile (
+		"loopnez %2, 1f\n"
+		"ee.vld.128.ip q0, %0, 0\n"
+		"ee.vld.128.ip q1, %1, 16\n"
+		"ee.vadds.s16 q0, q0, q1\n"
+		"ee.vst.128.ip q0, %0, 16\n"
+		"1:\n"
+		: "+r" (dst), "+r" (src)
+		: "r" (vectors)
+		: "memory");
+}
+#endif /* MIX_PIE */
+
+void IRAM_ATTR mix_scale_s16( int16_t *samples, unsigned int count, int32_t gain )
+{
+	if (gain == MIX_GAIN_ONE)
+		return;
+
+#if MIX_PIE
+	if (pie_aligned(samples))
+	{
+		const unsigned int vectors = count / MIX_VECTOR;
+		pie_scale_s16(samples, vectors, gain);
+		samples += vectors * MIX_VECTOR;
+		count -= vectors * MIX_VECTOR;
+	}
+#endif
+
+	for (unsigned int i = 0; i < count; ++i)
+		samples[i] = saturate_s16((samples[i] * gain) >> 15);
+}
+
+void IRAM_ATTR mix_add_s16( int16_t *dst, const int16_t *src, unsigned int count )
+{
+#if MIX_PIE
+	if (pie_aligned(dst) && pie_aligned(src))
+	{
+		const unsigned int vectors = count / MIX_VECTOR;
+		pie_add_s16(dst, src, vectors);
+		dst += vectors * MIX_VECTOR;
+		src += vectors * MIX_VECTOR;
+		count -= vectors * MIX_VECTOR;
+	}
+#endif
+
+	for (unsigned int i = 0; i < count; ++i)
+		dst[i] = saturate_s16(dst[i] + src[i]);
+}
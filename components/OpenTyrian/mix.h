@@ -0,0 +1,40 @@
+/*
+ * OpenTyrian: A modern cross-platform port of Tyrian
+ * Copyright (C) 2007-2009  The OpenTyrian Development Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+#ifndef MIX_H
+#define MIX_H
+
+#include <stdint.h>
+
+// Saturating 16-bit PCM kernels for the audio callback.  On the ESP32-S3
+// they run on the PIE vector unit, eight samples per instruction, whenever
+// the buffers are 16-byte aligned; elsewhere, and for unaligned buffers or
+// leftover samples, plain C computes the same results bit for bit.
+
+// gains are Q15: MIX_GAIN_ONE leaves samples unchanged, up to just under 2.0
+#define MIX_GAIN_ONE 0x8000
+#define MIX_GAIN_MAX 0xffff
+
+int32_t mix_gain_q15( float gain );
+
+// samples = saturate(samples * gain >> 15)
+void mix_scale_s16( int16_t *samples, unsigned int count, int32_t gain );
+// dst = saturate(dst + src)
+void mix_add_s16( int16_t *dst, const int16_t *src, unsigned int count );
+
+#endif /* MIX_H */
@@ -0,0 +1,772 @@
+/*
+ * OpenTyrian: A modern cross-platform port of Tyrian
+ * Copyright (C) 2007-2009  The OpenTyrian Development Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+#include "config.h"
+#include "file.h"
+#include "lds_play.h"
+#include "music_cache.h"
+#include "opl.h"
+
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "esp_littlefs.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+#define CACHE_MAGIC 0x314d5954  // "TYM1"
+#define CACHE_VERSION 2
+#define CACHE_NONE 0xffffffff
+
+// each block starts from its own decoder state, so playback can seek to
+// any block, in particular the one holding the loop start
+#define CACHE_BLOCK_BYTES (4 + MUSIC_CACHE_BLOCK_SAMPLES / 2)
+
+// The OPL songs have next to nothing above 11 kHz, so they are stored at no
+// more than 22 kHz -- every other sample at 44 kHz -- and interpolated back
+// up as they play.
+#define CACHE_MAX_RATE 22050
+
+#define CACHE_MAX_SECONDS 360  // longer songs are left to the emulator
+#define CACHE_TAIL_SECONDS 2  // release tail kept after a song stops
+#define CACHE_RESERVE (256 * 1024)  // storage left free for configs and saves
+
+// File writes stall for as long as the flash takes to erase, so they happen
+// on a task of their own below everything else; the music task only queues
+// encoded blocks.  The queue covers about a third of a second at 22 kHz.
+#define WRITER_TASK_STACK 4096
+#define WRITER_TASK_PRIORITY 1
+#define WRITER_JOBS 16
+
+typedef struct
+{
+	Uint32 magic;
+	Uint16 version, song;
+	Uint32 key, rate;   // rate the song was rendered at
+	Uint16 opl_version; // OPL_VERSION and OPL_FIXED of the emulator that rendered it
+	Uint8 opl_fixed;
+	Uint8 decimation;   // rendered samples per stored sample
+	Uint32 length;      // samples stored, a whole number of blocks
+	Uint32 loop_start;  // CACHE_NONE if the song stops instead of looping
+	Uint32 loop_end;    // where it loops back or stops playing
+} CacheHeader;
+
+typedef enum
+{
+	WRITE_BEGIN,
+	WRITE_BLOCK,
+	WRITE_FINISH,
+	WRITE_ABORT,
+	WRITE_QUIT,
+} WriteJobType;
+
+typedef struct
+{
+	Uint8 type;
+	Uint8 song;
+	Uint32 id;  // recording the job belongs to
+	union
+	{
+		Uint8 data[CACHE_BLOCK_BYTES];  // WRITE_BLOCK
+		CacheHeader header;             // WRITE_FINISH
+	};
+} WriteJob;
+
+typedef struct
+{
+	int predictor;
+	int index;
+} AdpcmState;
+
+static const Sint16 ima_steps[89] =
+{
+	7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31,
+	34, 37, 41, 45, 50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143,
+	157, 173, 190, 209, 230, 253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658,
+	724, 796, 876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024,
+	3327, 3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899,
+	15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767,
+};
+
+static const Sint8 ima_index_adjust[8] = { -1, -1, -1, -1, 2, 4, 6, 8 };
+
+static struct
+{
+	FILE *f;
+	CacheHeader header;
+	Uint32 position;       // stored sample playing now, CACHE_NONE past the end
+	Uint32 next_position;  // the one after it, following the loop
+	Sint16 current, next;  // their values
+	unsigned int phase;    // output samples into the current one
+	Uint32 block;          // block held in decoded, CACHE_NONE if none
+	Sint16 decoded[MUSIC_CACHE_BLOCK_SAMPLES];
+} cache;
+
+// the music task's side of a recording; all of its positions are in stored
+// samples
+static struct
+{
+	bool active;
+	Uint32 id;
+	unsigned int song;
+	Uint32 key, rate;
+	unsigned int decimation;
+	Uint32 recorded;  // samples queued so far
+	Uint32 finish;    // samples to keep, 0 until the end is known
+	Uint32 loop_start, loop_end;
+	AdpcmState adpcm;
+	Sint32 sum, sum_next;        // rendered samples adding up to the next two stored ones
+	unsigned int phase;          // rendered samples since the last stored one
+	unsigned int pending_count;  // stored samples waiting for a whole block
+	Sint16 pending[MUSIC_CACHE_BLOCK_SAMPLES];
+	Uint32 position_start[256];  // sample each LDS position first started at
+} rec;
+
+// the writer task's side
+static struct
+{
+	FILE *f;
+	unsigned int song;
+	Uint32 id;
+	Uint32 written;  // bytes
+	Uint32 budget;   // bytes the recording may take
+} writer;
+
+static TaskHandle_t writer_task = NULL;
+static SemaphoreHandle_t writer_task_done = NULL;
+
+// single producer (the music task), single consumer (the writer)
+static WriteJob write_jobs[WRITER_JOBS];
+static atomic_uint write_jobs_written = 0, write_jobs_read = 0;
+
+// id of the last recording the writer gave up on, so the music task stops
+// encoding it
+static atomic_uint writer_dropped = 0;
+
+// songs too long or too big to record, set by both tasks
+static atomic_uint record_failed[2];
+
+static void cache_path( char *path, size_t size, unsigned int song, const char *ext )
+{
+	snprintf(path, size, "%s/music%02u.%s", get_user_directory(), song, ext);
+}
+
+static bool song_failed( unsigned int song )
+{
+	return song >= 64 || (atomic_load(&record_failed[song / 32]) & (1u << (song % 32)));
+}
+
+static void mark_song_failed( unsigned int song )
+{
+	if (song < 64)
+		atomic_fetch_or(&record_failed[song / 32], 1u << (song % 32));
+}
+
+// stored samples per rendered one: 1 up to CACHE_MAX_RATE, 2 at 44 kHz
+static unsigned int cache_decimation( unsigned int rate )
+{
+	return (rate > CACHE_MAX_RATE) ? rate / CACHE_MAX_RATE : 1;
+}
+
+// shared by the encoder and the decoder so they cannot drift apart
+static inline Sint16 adpcm_step( AdpcmState *state, unsigned int nibble )
+{
+	const int step = ima_steps[state->index];
+
+	int delta = step >> 3;
+	if (nibble & 4)
+		delta += step;
+	if (nibble & 2)
+		delta += step >> 1;
+	if (nibble & 1)
+		delta += step >> 2;
+
+	int predictor = state->predictor + ((nibble & 8) ? -delta : delta);
+	state->predictor = (predictor > 0x7fff) ? 0x7fff : (predictor < -0x8000) ? -0x8000 : predictor;
+
+	int index = state->index + ima_index_adjust[nibble & 7];
+	state->index = (index < 0) ? 0 : (index > 88) ? 88 : index;
+
+	return (Sint16)state->predictor;
+}
+
+static unsigned int adpcm_encode_sample( AdpcmState *state, Sint16 sample )
+{
+	const int step = ima_steps[state->index];
+
+	int diff = sample - state->predictor;
+	unsigned int nibble = 0;
+	if (diff < 0)
+	{
+		nibble = 8;
+		diff = -diff;
+	}
+	if (diff >= step)
+	{
+		nibble |= 4;
+		diff -= step;
+	}
+	if (diff >= step >> 1)
+	{
+		nibble |= 2;
+		diff -= step >> 1;
+	}
+	if (diff >= step >> 2)
+		nibble |= 1;
+
+	adpcm_step(state, nibble);
+	return nibble;
+}
+
+static void adpcm_encode_block( AdpcmState *state, const Sint16 *samples, Uint8 *data )
+{
+	data[0] = state->predictor & 0xff;
+	data[1] = (state->predictor >> 8) & 0xff;
+	data[2] = state->index;
+	data[3] = 0;
+
+	for (unsigned int i = 0; i < MUSIC_CACHE_BLOCK_SAMPLES; i += 2)
+	{
+		const unsigned int lo = adpcm_encode_sample(state, samples[i]);
+		const unsigned int hi = adpcm_encode_sample(state, samples[i + 1]);
+		data[4 + i / 2] = lo | (hi << 4);
+	}
+}
+
+static bool adpcm_decode_block( const Uint8 *data, Sint16 *samples )
+{
+	AdpcmState state =
+	{
+		.predictor = (Sint16)(data[0] | (data[1] << 8)),
+		.index = data[2],
+	};
+	if (state.index > 88)
+		return false;
+
+	for (unsigned int i = 0; i < MUSIC_CACHE_BLOCK_SAMPLES; i += 2)
+	{
+		samples[i] = adpcm_step(&state, data[4 + i / 2] & 0x0f);
+		samples[i + 1] = adpcm_step(&state, data[4 + i / 2] >> 4);
+	}
+	return true;
+}
+
+static bool decode_cache_block( Uint32 block )
+{
+	if (block == cache.block)
+		return true;
+
+	Uint8 data[CACHE_BLOCK_BYTES];
+
+	if (block != cache.block + 1 &&
+	    fseek(cache.f, sizeof(CacheHeader) + (long)block * CACHE_BLOCK_BYTES, SEEK_SET) != 0)
+		return false;
+
+	cache.block = CACHE_NONE;
+	if (fread(data, sizeof(data), 1, cache.f) != 1 || !adpcm_decode_block(data, cache.decoded))
+		return false;
+
+	cache.block = block;
+	return true;
+}
+
+// the stored sample that plays after position, following the loop
+static Uint32 following( Uint32 position )
+{
+	const CacheHeader *h = &cache.header;
+
+	if (position == CACHE_NONE)
+		return CACHE_NONE;
+	if (position + 1 == h->loop_end && h->loop_start != CACHE_NONE)
+		return h->loop_start;
+	return (position + 1 < h->length) ? position + 1 : CACHE_NONE;
+}
+
+static bool cache_sample( Uint32 position, Sint16 *sample )
+{
+	if (position == CACHE_NONE)
+	{
+		*sample = 0;
+		return true;
+	}
+	if (!decode_cache_block(position / MUSIC_CACHE_BLOCK_SAMPLES))
+		return false;
+	*sample = cache.decoded[position % MUSIC_CACHE_BLOCK_SAMPLES];
+	return true;
+}
+
+bool music_cache_open( unsigned int song, Uint32 key, unsigned int rate )
+{
+	music_cache_close();
+
+	char name[16];
+	snprintf(name, sizeof(name), "music%02u.tmc", song);
+	cache.f = dir_fopen(get_user_directory(), name, "rb");
+	if (cache.f == NULL)
+		return false;
+
+	const CacheHeader *h = &cache.header;
+	if (fread(&cache.header, sizeof(cache.header), 1, cache.f) != 1 ||
+	    h->magic != CACHE_MAGIC || h->version != CACHE_VERSION ||
+	    h->opl_version != OPL_VERSION || h->opl_fixed != OPL_FIXED ||
+	    h->song != song || h->key != key || h->rate != rate || h->decimation != cache_decimation(rate) ||
+	    h->length == 0 || h->length % MUSIC_CACHE_BLOCK_SAMPLES != 0 || h->loop_end > h->length ||
+	    (h->loop_start != CACHE_NONE && h->loop_start >= h->loop_end))
+	{
+		// left over from other song data, an older player or another build
+		// of the emulator; the recording that follows replaces it
+		fprintf(stderr, "warning: discarding stale music cache for song %u\n", song + 1);
+		music_cache_close();
+		return false;
+	}
+
+	cache.block = CACHE_NONE;
+	cache.position = 0;
+	cache.next_position = following(0);
+	cache.phase = 0;
+	if (!cache_sample(cache.position, &cache.current) || !cache_sample(cache.next_position, &cache.next))
+	{
+		fprintf(stderr, "warning: failed to read music cache for song %u\n", song + 1);
+		music_cache_close();
+		return false;
+	}
+
+	playing = h->loop_end != 0;
+	songlooped = false;
+	return true;
+}
+
+void music_cache_close( void )
+{
+	if (cache.f != NULL)
+	{
+		fclose(cache.f);
+		cache.f = NULL;
+	}
+}
+
+// moves on to the next stored sample
+static void advance_cache( void )
+{
+	const CacheHeader *h = &cache.header;
+
+	if (cache.position + 1 == h->loop_end)
+	{
+		if (h->loop_start != CACHE_NONE)
+			songlooped = true;
+		else
+			playing = false;
+	}
+
+	cache.position = cache.next_position;
+	cache.current = cache.next;
+	cache.next_position = following(cache.position);
+
+	if (!cache_sample(cache.next_position, &cache.next))
+	{
+		fprintf(stderr, "warning: failed to read music cache for song %u\n", h->song + 1);
+		music_cache_close();
+		playing = false;
+	}
+}
+
+void music_cache_read( Sint16 *samples )
+{
+	const unsigned int decimation = cache.header.decimation;
+
+	for (unsigned int i = 0; i < MUSIC_CACHE_BLOCK_SAMPLES; ++i)
+	{
+		if (cache.f == NULL || cache.position == CACHE_NONE)
+		{
+			memset(&samples[i], 0, (MUSIC_CACHE_BLOCK_SAMPLES - i) * sizeof(*samples));
+			return;
+		}
+
+		samples[i] = cache.current + (cache.next - cache.current) * (int)cache.phase / (int)decimation;
+
+		if (++cache.phase == decimation)
+		{
+			cache.phase = 0;
+			advance_cache();
+		}
+	}
+}
+
+static void post_write_job( const WriteJob *job )
+{
+	const unsigned int written = atomic_load_explicit(&write_jobs_written, memory_order_relaxed);
+
+	write_jobs[written % WRITER_JOBS] = *job;
+	atomic_store_explicit(&write_jobs_written, written + 1, memory_order_release);
+
+	xTaskNotifyGive(writer_task);
+}
+
+static unsigned int free_write_jobs( void )
+{
+	return WRITER_JOBS - (atomic_load_explicit(&write_jobs_written, memory_order_relaxed) -
+	                      atomic_load_explicit(&write_jobs_read, memory_order_acquire));
+}
+
+// While a recording is active the music task always leaves one job free, so
+// it can end the recording without waiting on the writer.
+static void stop_recording( bool failed )
+{
+	if (!rec.active)
+		return;
+
+	rec.active = false;
+	post_write_job(&(WriteJob){ .type = WRITE_ABORT, .id = rec.id });
+
+	if (failed)
+		mark_song_failed(rec.song);
+}
+
+void music_cache_record_begin( unsigned int song, Uint32 key, unsigned int rate )
+{
+	stop_recording(false);
+
+	if (writer_task == NULL || song_failed(song) || free_write_jobs() < 2)
+		return;
+
+	if (++rec.id == 0)
+		++rec.id;
+
+	post_write_job(&(WriteJob){ .type = WRITE_BEGIN, .song = song, .id = rec.id });
+
+	rec.active = true;
+	rec.song = song;
+	rec.key = key;
+	rec.rate = rate;
+	rec.decimation = cache_decimation(rate);
+	rec.recorded = 0;
+	rec.finish = 0;
+	rec.loop_start = rec.loop_end = CACHE_NONE;
+	rec.adpcm = (AdpcmState){ 0 };
+	rec.sum = rec.sum_next = 0;
+	rec.phase = 0;
+	rec.pending_count = 0;
+	memset(rec.position_start, 0xff, sizeof(rec.position_start));
+}
+
+void music_cache_record_tick( Uint32 rendered, bool looped )
+{
+	if (!rec.active || rec.finish != 0)
+		return;
+
+	const Uint32 sample = rendered / rec.decimation;
+
+	const int position = lds_started_position();
+	if (position >= 0)
+	{
+		if (looped)
+		{
+			// first row after the backward jump: the song repeats from here
+			const Uint32 start = rec.position_start[position];
+			if (start == CACHE_NONE || start >= sample)
+			{
+				stop_recording(true);
+				return;
+			}
+			rec.loop_start = start;
+			rec.loop_end = rec.finish = sample;
+			return;
+		}
+
+		if (rec.position_start[position] == CACHE_NONE)
+			rec.position_start[position] = sample;
+	}
+
+	if (!playing)
+	{
+		rec.loop_end = sample;
+		rec.finish = sample + rec.rate / rec.decimation * CACHE_TAIL_SECONDS;
+	}
+}
+
+// queues the block of stored samples in rec.pending
+static void record_pending( void )
+{
+	if (free_write_jobs() < 2)
+	{
+		fprintf(stderr, "warning: music cache writer fell behind, not recording song %u\n", rec.song + 1);
+		stop_recording(false);
+		return;
+	}
+
+	WriteJob job = { .type = WRITE_BLOCK, .id = rec.id };
+	adpcm_encode_block(&rec.adpcm, rec.pending, job.data);
+	post_write_job(&job);
+
+	rec.pending_count = 0;
+	rec.recorded += MUSIC_CACHE_BLOCK_SAMPLES;
+
+	if (rec.finish != 0 && rec.recorded >= rec.finish)
+	{
+		job = (WriteJob)
+		{
+			.type = WRITE_FINISH,
+			.id = rec.id,
+			.header =
+			{
+				.magic = CACHE_MAGIC,
+				.version = CACHE_VERSION,
+				.song = rec.song,
+				.key = rec.key,
+				.rate = rec.rate,
+				.opl_version = OPL_VERSION,
+				.opl_fixed = OPL_FIXED,
+				.decimation = rec.decimation,
+				.length = rec.recorded,
+				.loop_start = rec.loop_start,
+				.loop_end = rec.loop_end,
+			},
+		};
+		post_write_job(&job);
+		rec.active = false;
+	}
+	else if (rec.recorded >= rec.rate / rec.decimation * CACHE_MAX_SECONDS)
+	{
+		stop_recording(true);
+	}
+}
+
+void music_cache_record_block( const Sint16 *samples )
+{
+	if (!rec.active)
+		return;
+
+	if (atomic_load(&writer_dropped) == rec.id)
+	{
+		rec.active = false;
+		return;
+	}
+
+	// Each stored sample is a triangle-weighted average of the rendered ones
+	// around it, so it lines up with the rendered sample it replaces.
+	const Sint32 d = rec.decimation;
+
+	for (unsigned int i = 0; i < MUSIC_CACHE_BLOCK_SAMPLES; ++i)
+	{
+		rec.sum += (d - (Sint32)rec.phase) * samples[i];
+		rec.sum_next += (Sint32)rec.phase * samples[i];
+		if (++rec.phase < rec.decimation)
+			continue;
+
+		rec.pending[rec.pending_count++] = rec.sum / (d * d);
+		rec.sum = rec.sum_next;
+		rec.sum_next = 0;
+		rec.phase = 0;
+
+		if (rec.pending_count == MUSIC_CACHE_BLOCK_SAMPLES)
+		{
+			record_pending();
+			if (!rec.active)
+				return;
+		}
+	}
+}
+
+void music_cache_record_abort( void )
+{
+	stop_recording(false);
+}
+
+// everything below runs on the writer task
+
+static void drop_file( bool failed )
+{
+	if (writer.f == NULL)
+		return;
+
+	fclose(writer.f);
+	writer.f = NULL;
+
+	char path[128];
+	cache_path(path, sizeof(path), writer.song, "tmp");
+	remove(path);
+
+	if (failed)
+		mark_song_failed(writer.song);
+	atomic_store(&writer_dropped, writer.id);
+}
+
+static void begin_file( const WriteJob *job )
+{
+	drop_file(false);
+
+	writer.song = job->song;
+	writer.id = job->id;
+
+	// a stale recording of the song, if any, is no use now
+	char path[128];
+	cache_path(path, sizeof(path), writer.song, "tmc");
+	remove(path);
+
+	size_t total = 0, used = 0;
+	if (esp_littlefs_info("storage", &total, &used) != ESP_OK || total < used + CACHE_RESERVE)
+	{
+		atomic_store(&writer_dropped, writer.id);
+		return;
+	}
+
+	char name[16];
+	snprintf(name, sizeof(name), "music%02u.tmp", writer.song);
+	writer.f = dir_fopen(get_user_directory(), name, "wb");
+	if (writer.f == NULL)
+	{
+		atomic_store(&writer_dropped, writer.id);
+		return;
+	}
+
+	// the header is rewritten once the loop is known
+	const CacheHeader header = { 0 };
+	if (fwrite(&header, sizeof(header), 1, writer.f) != 1)
+	{
+		drop_file(false);
+		return;
+	}
+
+	writer.written = sizeof(header);
+	writer.budget = total - used - CACHE_RESERVE;
+}
+
+static void write_block( const WriteJob *job )
+{
+	if (writer.f == NULL || job->id != writer.id)
+		return;
+
+	if (writer.written + CACHE_BLOCK_BYTES > writer.budget ||
+	    fwrite(job->data, CACHE_BLOCK_BYTES, 1, writer.f) != 1)
+	{
+		drop_file(true);
+		return;
+	}
+	writer.written += CACHE_BLOCK_BYTES;
+}
+
+static void finish_file( const WriteJob *job )
+{
+	if (writer.f == NULL || job->id != writer.id)
+		return;
+
+	const CacheHeader *header = &job->header;
+
+	if (fseek(writer.f, 0, SEEK_SET) != 0 || fwrite(header, sizeof(*header), 1, writer.f) != 1)
+	{
+		drop_file(false);
+		return;
+	}
+	const bool closed = fclose(writer.f) == 0;
+	writer.f = NULL;
+
+	char tmp_path[128], path[128];
+	cache_path(tmp_path, sizeof(tmp_path), writer.song, "tmp");
+	cache_path(path, sizeof(path), writer.song, "tmc");
+
+	if (!closed || rename(tmp_path, path) != 0)
+	{
+		fprintf(stderr, "warning: failed to save music cache for song %u\n", writer.song + 1);
+		remove(tmp_path);
+		return;
+	}
+
+	printf("cached song %u: %lu samples at %u Hz, %s\n", writer.song + 1, (unsigned long)header->length,
+	       (unsigned int)(header->rate / header->decimation),
+	       header->loop_start != CACHE_NONE ? "looped" : "stops");
+}
+
+static void writer_task_main( void *arg )
+{
+	(void)arg;
+
+	for (;;)
+	{
+		const unsigned int read = atomic_load_explicit(&write_jobs_read, memory_order_relaxed);
+
+		if (read == atomic_load_explicit(&write_jobs_written, memory_order_acquire))
+		{
+			ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+			continue;
+		}
+
+		const WriteJob *job = &write_jobs[read % WRITER_JOBS];
+
+		switch (job->type)
+		{
+		case WRITE_BEGIN:
+			begin_file(job);
+			break;
+
+		case WRITE_BLOCK:
+			write_block(job);
+			break;
+
+		case WRITE_FINISH:
+			finish_file(job);
+			break;
+
+		case WRITE_ABORT:
+			if (job->id == writer.id)
+				drop_file(false);
+			break;
+
+		case WRITE_QUIT:
+			drop_file(false);
+			atomic_store_explicit(&write_jobs_read, read + 1, memory_order_release);
+			xSemaphoreGive(writer_task_done);
+			vTaskDelete(NULL);
+			return;
+		}
+
+		// the slot stays in use until its job is done
+		atomic_store_explicit(&write_jobs_read, read + 1, memory_order_release);
+	}
+}
+
+void music_cache_init( void )
+{
+	writer_task_done = xSemaphoreCreateBinary();
+	if (writer_task_done == NULL ||
+	    xTaskCreatePinnedToCore(writer_task_main, "music cache", WRITER_TASK_STACK, NULL, WRITER_TASK_PRIORITY, &writer_task, tskNO_AFFINITY) != pdPASS)
+	{
+		fprintf(stderr, "warning: failed to create music cache writer task, not recording songs\n");
+		writer_task = NULL;
+	}
+}
+
+void music_cache_quit( void )
+{
+	if (writer_task != NULL)
+	{
+		// only waits if the writer is still busy with the last song
+		while (free_write_jobs() == 0)
+			vTaskDelay(1);
+
+		post_write_job(&(WriteJob){ .type = WRITE_QUIT });
+		xSemaphoreTake(writer_task_done, portMAX_DELAY);
+		writer_task = NULL;
+	}
+	if (writer_task_done != NULL)
+	{
+		vSemaphoreDelete(writer_task_done);
+		writer_task_done = NULL;
+	}
+}
@@ -0,0 +1,63 @@
+/*
+ * OpenTyrian: A modern cross-platform port of Tyrian
+ * Copyright (C) 2007-2009  The OpenTyrian Development Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+#ifndef MUSIC_CACHE_H
+#define MUSIC_CACHE_H
+
+#include "opentyr.h"
+
+#include "SDL3/SDL.h"
+
+// Songs are recorded the first time they play live and kept in the user
+// directory as 4-bit IMA ADPCM, so later plays decode a file instead of
+// running the OPL emulator.  The recording stops where the song first loops
+// back, remembering the loop start, or shortly after a song that ends.
+// Recordings are kept at no more than 22 kHz and interpolated back up to the
+// output rate, and are thrown away if the emulator that made them differs
+// from this one (OPL_VERSION, OPL_FIXED).
+//
+// The music task only encodes; the files are written by a task of their own
+// at low priority, so a slow flash write cannot make the music underrun.
+// Apart from init and quit, everything here is called from the music task.
+
+#define MUSIC_CACHE_BLOCK_SAMPLES 512
+
+// Start and stop the writer task; quit only once the music task is gone.
+void music_cache_init( void );
+void music_cache_quit( void );
+
+// Opens the cached rendering of a song, if there is one.  key identifies the
+// song data it was rendered from (its size in music.mus).
+bool music_cache_open( unsigned int song, Uint32 key, unsigned int rate );
+void music_cache_close( void );
+
+// Decodes the next block of a cached song, following its loop.  Updates
+// playing and songlooped the way lds_update() would have.
+void music_cache_read( Sint16 *samples );
+
+// Starts recording a song that is about to be rendered live.  Does nothing
+// if the song has already failed to record or storage is short.
+void music_cache_record_begin( unsigned int song, Uint32 key, unsigned int rate );
+// Called after every lds_update(): rendered is the number of samples rendered
+// before that update, looped the value songlooped had before it.
+void music_cache_record_tick( Uint32 rendered, bool looped );
+// Called with every rendered block, in order.
+void music_cache_record_block( const Sint16 *samples );
+void music_cache_record_abort( void );
+
+#endif /* MUSIC_CACHE_H */
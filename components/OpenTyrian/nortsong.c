@@ -29,6 +29,8 @@
 
 #include "SDL3/SDL.h"
 
+#include "esp_heap_caps.h"
+
 Uint32 target, target2;
 
 JE_boolean notYetLoadedSound = true;
@@ -38,6 +40,8 @@ JE_word frameCount, frameCount2, frameCountMax;
 JE_byte *digiFx[SAMPLE_COUNT] = { NULL }; /* [1..soundnum + 9] */
 JE_word fxSize[SAMPLE_COUNT]; /* [1..soundnum + 9] */
 
+static JE_byte *sndArena = NULL;  // backs every digiFx entry
+
 JE_word tyrMusicVolume, fxVolume;
 JE_word fxPlayVol;
 JE_word tempVolume;
@@ -88,6 +92,83 @@ void service_wait_delay( void )
 	}
 }
 
+#define STEP_MAX_LAG  4  // ticks behind before the schedule gives up and restarts
+#define STEP_MAX_SKIP 3  // frames in a row that may go undrawn
+
+static Uint32 step_clock;
+static float step_accumulator;  // ms elapsed that have not yet been simulated
+static unsigned int step_skipped;
+static bool step_started;
+static Uint32 sim_ticks, render_frames, sim_ms;
+
+void frame_step_reset( void )
+{
+	step_clock = SDL_GetTicks();
+	step_accumulator = 0;
+	step_skipped = 0;
+	step_started = false;
+}
+
+bool frame_step( int delay )
+{
+	sim_ticks++;
+
+	if (benchDemos)
+	{
+		// the first tick of a level follows its loading, which is not counted
+		const Uint32 now = SDL_GetTicks();
+		if (step_started)
+			sim_ms += now - step_clock;
+		step_clock = now;
+		step_started = true;
+
+		render_frames++;
+		return true;
+	}
+
+#if FIXED_STEP
+	const float period = delay * jasondelay;
+
+	Uint32 now = SDL_GetTicks();
+	step_accumulator += now - step_clock;
+	step_clock = now;
+
+	if (step_accumulator < period)
+	{
+		SDL_Delay((Uint32)(period - step_accumulator) + 1);
+
+		now = SDL_GetTicks();
+		step_accumulator += now - step_clock;
+		step_clock = now;
+	}
+	step_accumulator -= period;
+
+	// a long stall (loading, a menu, the debugger) is not worth catching up on
+	if (step_accumulator > STEP_MAX_LAG * period)
+		step_accumulator = 0;
+
+	if (step_accumulator >= period && step_skipped < STEP_MAX_SKIP)
+	{
+		step_skipped++;
+		return false;
+	}
+	step_skipped = 0;
+#else
+	wait_delay();
+	setjasondelay(delay);
+#endif
+
+	render_frames++;
+	return true;
+}
+
+void get_frame_stats( Uint32 *sim_ticks_out, Uint32 *render_frames_out, Uint32 *sim_ms_out )
+{
+	*sim_ticks_out = sim_ticks;
+	*render_frames_out = render_frames;
+	*sim_ms_out = sim_ms;
+}
+
 void wait_delayorinput( JE_boolean keyboard, JE_boolean mouse, JE_boolean joystick )
 {
 	service_SDL_events(true);
@@ -99,67 +180,101 @@ void wait_delayorinput( JE_boolean keyboard, JE_boolean mouse, JE_boolean joysti
 	}
 }
 
-void JE_loadSndFile( const char *effects_sndfile, const char *voices_sndfile )
+// reads the sample offsets of a .snd file, with the file size as the end of the last one
+static FILE *open_snd_file( const char *sndfile, JE_word *sndNum, JE_longint sndPos[SAMPLE_COUNT + 1] )
 {
-	notYetLoadedSound = false;
-	return;
-	JE_byte y, z;
-	JE_word x;
-	JE_longint templ;
-	JE_longint sndPos[2][SAMPLE_COUNT + 1];
-	JE_word sndNum;
-
-	FILE *fi;	
-	/* SYN: Loading offsets into TYRIAN.SND */
-	fi = dir_fopen_die(data_dir(), effects_sndfile, "rb");
-	efread(&sndNum, sizeof(sndNum), 1, fi);
+	FILE *fi = dir_fopen_die(data_dir(), sndfile, "rb");
 	
-	for (x = 0; x < sndNum; x++)
+	efread(sndNum, sizeof(*sndNum), 1, fi);
+	if (*sndNum > SAMPLE_COUNT)
+		*sndNum = SAMPLE_COUNT;
+	
+	for (JE_word x = 0; x < *sndNum; x++)
 	{
-		efread(&sndPos[0][x], sizeof(sndPos[0][x]), 1, fi);
+		efread(&sndPos[x], sizeof(sndPos[x]), 1, fi);
 	}
 	efseek(fi, 0, SEEK_END);
-	sndPos[0][sndNum] = eftell(fi); /* Store file size */
+	sndPos[*sndNum] = eftell(fi); /* Store file size */
+	
+	return fi;
+}
 
-	for (z = 0; z < sndNum; z++)
+// All samples go into one arena that stays loaded until the game exits; the
+// mixer plays them in place, so nothing is allocated while sounds play.
+void JE_loadSndFile( const char *effects_sndfile, const char *voices_sndfile )
+{
+	JE_longint sndPos[2][SAMPLE_COUNT + 1];
+	JE_word sndNum[2];
+	
+	JE_freeSndFile();
+	
+	FILE *fi[2] =
 	{
-		efseek(fi, sndPos[0][z], SEEK_SET);
-		fxSize[z] = (sndPos[0][z+1] - sndPos[0][z]); /* Store sample sizes */
-		free(digiFx[z]);
-		digiFx[z] = malloc(fxSize[z]);
-		efread(digiFx[z], 1, fxSize[z], fi); /* JE: Load sample to buffer */
+		open_snd_file(effects_sndfile, &sndNum[0], sndPos[0]),
+		open_snd_file(voices_sndfile, &sndNum[1], sndPos[1]),
+	};
+	
+	/* SYN: Voices go after the effects, in the last 9 slots */
+	const JE_byte first[2] = { 0, SAMPLE_COUNT - 9 };
+	if (sndNum[0] > first[1])
+		sndNum[0] = first[1];
+	if (sndNum[1] > 9)
+		sndNum[1] = 9;
+	
+	size_t arena_size = 0;
+	for (int f = 0; f < 2; f++)
+	{
+		for (JE_word y = 0; y < sndNum[f]; y++)
+		{
+			JE_longint templ = sndPos[f][y + 1] - sndPos[f][y];
+			if (f == 1)
+				templ -= 100; /* SYN: I'm not entirely sure what's going on here. */
+			if (templ < 1)
+				templ = 1;
+			if (templ > 0xffff)
+				templ = 0xffff;
+			fxSize[first[f] + y] = templ; /* Store sample sizes */
+			arena_size += templ;
+		}
 	}
-
-	efclose(fi);
-
-	/* SYN: Loading offsets into VOICES.SND */
-	fi = dir_fopen_die(data_dir(), voices_sndfile, "rb");
 	
-	efread(&sndNum, sizeof(sndNum), 1, fi);
-
-	for (x = 0; x < sndNum; x++)
+	sndArena = heap_caps_malloc(arena_size, MALLOC_CAP_SPIRAM);
+	if (sndArena == NULL)
+		sndArena = malloc(arena_size);
+	if (sndArena == NULL)
 	{
-		efread(&sndPos[1][x], sizeof(sndPos[1][x]), 1, fi);
+		fprintf(stderr, "error: failed to allocate %zu bytes for sound effects\n", arena_size);
+		exit(EXIT_FAILURE);
 	}
-	efseek(fi, 0, SEEK_END);
-	sndPos[1][sndNum] = eftell(fi); /* Store file size */
-
-	z = SAMPLE_COUNT - 9;
-
-	for (y = 0; y < sndNum; y++)
+	
+	JE_byte *arena_pos = sndArena;
+	for (int f = 0; f < 2; f++)
 	{
-		efseek(fi, sndPos[1][y], SEEK_SET);
-
-		templ = (sndPos[1][y+1] - sndPos[1][y]) - 100; /* SYN: I'm not entirely sure what's going on here. */
-		if (templ < 1) templ = 1;
-		fxSize[z + y] = templ; /* Store sample sizes */
-		digiFx[z + y] = malloc(fxSize[z + y]);
-		efread(digiFx[z + y], 1, fxSize[z + y], fi); /* JE: Load sample to buffer */
+		for (JE_word y = 0; y < sndNum[f]; y++)
+		{
+			const JE_byte z = first[f] + y;
+			
+			efseek(fi[f], sndPos[f][y], SEEK_SET);
+			digiFx[z] = arena_pos;
+			efread(digiFx[z], 1, fxSize[z], fi[f]); /* JE: Load sample to buffer */
+			arena_pos += fxSize[z];
+		}
+		efclose(fi[f]);
 	}
-	efclose(fi);
-
+	
 	notYetLoadedSound = false;
+}
 
+void JE_freeSndFile( void )
+{
+	free(sndArena);
+	sndArena = NULL;
+	
+	for (int i = 0; i < SAMPLE_COUNT; i++)
+	{
+		digiFx[i] = NULL;
+		fxSize[i] = 0;
+	}
 }
 
 void JE_playSampleNum( JE_byte samplenum )
@@ -26,6 +26,19 @@
 
 #include "SDL3/SDL.h"
 
+#include <stdbool.h>
+
+// With FIXED_STEP the in-game loop is paced by frame_step(): game ticks are
+// scheduled on a fixed period with an accumulator, so a frame that runs long
+// is paid back by the following ones instead of slowing the game, and while
+// the game is behind its schedule the finished frame is not composed or
+// presented.  Without it, each tick waits a full period from the end of the
+// previous one, as the original game did.  With --bench-demos ticks are not
+// waited for at all.
+#ifndef FIXED_STEP
+#define FIXED_STEP 1
+#endif
+
 extern Uint32 target, target2;
 
 extern JE_word frameCount, frameCount2, frameCountMax;
@@ -51,6 +64,14 @@ void wait_delay( void );
 void service_wait_delay( void );
 void wait_delayorinput( JE_boolean keyboard, JE_boolean mouse, JE_boolean joystick );
 
+// Waits for the next game tick, delay jasondelays after the previous one, and
+// returns whether the frame just simulated should be drawn.
+bool frame_step( int delay );
+// Restarts the tick schedule, e.g. when a level starts.
+void frame_step_reset( void );
+// sim_ms is the time spent from one tick to the next within a level.
+void get_frame_stats( Uint32 *sim_ticks, Uint32 *render_frames, Uint32 *sim_ms );
+
 void JE_resetTimerInt( void );
 void JE_setTimerInt( void );
 
@@ -58,6 +79,7 @@ void JE_calcFXVol( void );
 void JE_changeVolume( JE_word *music, int music_delta, JE_word *sample, int sample_delta );
 
 void JE_loadSndFile( const char *effects_sndfile, const char *voices_sndfile );
+void JE_freeSndFile( void );
 void JE_playSampleNum( JE_byte samplenum );
 
 #endif /* NORTSONG_H */
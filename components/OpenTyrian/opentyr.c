@@ -36,6 +36,7 @@
 #include "network.h"
 #include "nortsong.h"
 #include "opentyr.h"
+#include "palette_lut.h"
 #include "params.h"
 #include "picload.h"
 #include "scroller.h"
@@ -328,6 +329,7 @@ int main( int argc, char *argv[] )
 	}
 
 	JE_loadPals();
+	init_palette_luts();
 	JE_loadMainShapeTables(xmas ? "tyrianc.shp" : "tyrian.shp");
 
 	if (xmas && !xmas_prompt())
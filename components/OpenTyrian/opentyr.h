@@ -42,7 +42,7 @@ typedef unsigned int uint;
 typedef unsigned long ulong;
 
 // Pascal types, yuck.
-typedef long JE_longint;
+typedef Sint32 JE_longint;  // 32 bits in the data files, also on 64-bit hosts
 //typedef int JE_integer;
 typedef short JE_integer;
 //typedef short  JE_shortint;
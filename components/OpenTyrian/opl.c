@@ -56,12 +56,39 @@ Bit32u tremtab_add;
 
 static Bit32u generator_add;	// should be a chip parameter
 
+#if OPL_FIXED
+// wave form, vibrato/tremolo, key scale level, sustain and volume tables
+#include "opl_tables.h"
+
+#define OPL_CLOCK		14318180			// INTFREQU is this divided by 288
+
+// envelope levels are 2.30 fixed point, the attack coefficients 6.56 and the
+// decay and release multipliers 1.63
+#define ENV_SHIFT		30
+#define ENV_ONE			(1 << ENV_SHIFT)
+#define ENV_FRAC_ONE	(1u << ENV_SHIFT)	// amp_frac counts in 2^-30 of amp's lsb
+#define ATTACK_SHIFT	56
+#define ENVMUL_SHIFT	63
+#define ENVMUL_ONE		((Bit64u)1 << ENVMUL_SHIFT)
+
+// constants folded into fixed point at compile time
+#define Q44(x)			((Bit64u)((x) * 17592186044416.0 + 0.5))
+#define Q50(x)			((Bit64u)((x) * 1125899906842624.0 + 0.5))
+#define Q60(x)			((Bit64u)((x) * 1152921504606846976.0 + 0.5))
+
+// the level the release phase stops at, 2.60 like amp and amp_frac together
+#define ENV_MIN			Q60(0.00000001)
+#else
+#define ENV_MIN			((fltype)0.00000001)	// where the release phase stops
+#define ENVMUL_ONE		((fltype)1.0)
+
 static fltype recipsamp;	// inverse of sampling rate
 static Bit16s wavtable[WAVEPREC*3];	// wave form table
 
 // vibrato/tremolo tables
 static Bit32s vib_table[VIBTAB_SIZE];
 static Bit32s trem_table[TREMTAB_SIZE*2];
+#endif
 
 static Bit32s vibval_const[BLOCKBUF_SIZE];
 static Bit32s tremval_const[BLOCKBUF_SIZE];
@@ -77,6 +104,21 @@ static Bit32s *vibval1, *vibval2, *vibval3, *vibval4;
 static Bit32s *tremval1, *tremval2, *tremval3, *tremval4;
 
 
+#if OPL_FIXED
+// key scale level lookup table, in quarter steps of the output level
+static const Bit8u kslmul[4] = {
+	0, 2, 1, 4		// -> 0, 3, 1.5, 6 dB/oct
+};
+
+// frequency multiplicator lookup table, doubled
+static const Bit8u frqmul_tab[16] = {
+	1,2,4,6,8,10,12,14,16,18,20,20,24,24,30,30
+};
+// calculated frequency multiplication values, over 9*int_samplerate; kept
+// as a fraction so the phase increment is exact, since a 32.32 multiplier
+// truncated it by one now and then and the phase drifted from then on
+static Bit64u frqmul[16];
+#else
 // key scale level lookup table
 static const fltype kslmul[4] = {
 	0.0, 0.5, 0.25, 1.0		// -> 0, 3, 1.5, 6 dB/oct
@@ -91,6 +133,7 @@ static fltype frqmul[16];
 
 // key scale levels
 static Bit8u kslev[8][16];
+#endif
 
 // map a channel number to the register offset of the modulator (=register base)
 static const Bit8u modulatorbase[9]	= {
@@ -156,6 +199,25 @@ static Bit32u wavestart[8] = {
 };
 
 // envelope generator function constants
+#if OPL_FIXED
+// the attack rate coefficients 0.0377, 10.73, -17.57 and 7.42 with attackconst
+// folded in, 14.50; slow attacks need all of these bits
+#define ATTACKCOEF(c)	{ Q50(0.0377/(c)), Q50(10.73/(c)), Q50(17.57/(c)), Q50(7.42/(c)) }
+static const Bit64u attackcoef[4][4] = {
+	ATTACKCOEF(2.82624),
+	ATTACKCOEF(2.25280),
+	ATTACKCOEF(1.88416),
+	ATTACKCOEF(1.59744)
+};
+// decay/release rates, with the -7.4493 factor applied, 20.44 so that
+// shifted by the rate and divided by the sample rate they keep enough bits
+static const Bit64u decrelconst[4] = {
+	Q44(7.4493/39.28064),
+	Q44(7.4493/31.41608),
+	Q44(7.4493/26.17344),
+	Q44(7.4493/22.44608)
+};
+#else
 static fltype attackconst[4] = {
 	(fltype)(1/2.82624),
 	(fltype)(1/2.25280),
@@ -168,14 +230,72 @@ static fltype decrelconst[4] = {
 	(fltype)(1/26.17344),
 	(fltype)(1/22.44608)
 };
+#endif
 
+#if OPL_FIXED
+// Decay and release multiply the level by a factor just below 1.0 every
+// sample.  Truncated to 2.30 each time, a quiet level would lose a whole lsb
+// per sample instead of a fraction of one, so slow releases died out and
+// switched their operator off long before the float emulator does -- which
+// moves every later envelope step of that operator.  The bits below amp's
+// lsb are kept in amp_frac and carried from sample to sample instead.
+// The multiplier needs the same care: one 2.30 lsb is an error of 1e-9 per
+// sample, enough after a few thousand samples of a long decay to reach the
+// sustain level a step early, so it is kept in 1.63.
+
+// high 64 bits of a*b, low by at most 2: the carries out of the low halves
+// of the partial products are dropped
+static inline Bit64u mulhi64(Bit64u a, Bit64u b) {
+	const Bit64u a_hi = a >> 32, a_lo = (Bit32u)a, b_hi = b >> 32, b_lo = (Bit32u)b;
+	const Bit64u mid = (a_hi*b_lo >> 32) + (a_lo*b_hi >> 32);
+	return a_hi*b_hi + mid;
+}
 
-void operator_advance(op_type* op_pt, Bit32s vib) {
+static inline void envelope_scale(op_type* op_pt, Bit64u mul) {
+	// the level is at most 1.0, so 2.60 shifted up by 3 still fits; the
+	// product is then 2.62, rounded back to 2.60
+	const Bit64u level = ((Bit64u)op_pt->amp << ENV_SHIFT) | op_pt->amp_frac;
+	const Bit64u scaled = (mulhi64(level << 3, mul) + 2) >> 2;
+	op_pt->amp = (Bit32s)(scaled >> ENV_SHIFT);
+	op_pt->amp_frac = (Bit32u)scaled & (ENV_FRAC_ONE - 1);
+}
+
+static inline void envelope_set(op_type* op_pt, Bit32s amp) {
+	op_pt->amp = amp;
+	op_pt->amp_frac = 0;
+}
+
+static inline bool envelope_above(const op_type* op_pt, Bit32s level) {
+	return (op_pt->amp > level) || ((op_pt->amp == level) && (op_pt->amp_frac != 0));
+}
+
+static inline bool envelope_above_min(const op_type* op_pt) {
+	return (((Bit64u)op_pt->amp << ENV_SHIFT) | op_pt->amp_frac) > ENV_MIN;
+}
+#else
+static inline void envelope_set(op_type* op_pt, fltype amp) {
+	op_pt->amp = amp;
+}
+
+static inline bool envelope_above(const op_type* op_pt, fltype level) {
+	return op_pt->amp > level;
+}
+
+static inline bool envelope_above_min(const op_type* op_pt) {
+	return op_pt->amp > ENV_MIN;
+}
+#endif
+
+static inline void operator_advance_phase(op_type* op_pt, Bit32s vib) {
 	op_pt->wfpos = op_pt->tcount;						// waveform position
 	
 	// advance waveform time
 	op_pt->tcount += op_pt->tinc;
 	op_pt->tcount += (Bit32s)(op_pt->tinc)*vib/FIXEDPT;
+}
+
+void operator_advance(op_type* op_pt, Bit32s vib) {
+	operator_advance_phase(op_pt, vib);
 
 	op_pt->generator_pos += generator_add;
 }
@@ -227,7 +347,16 @@ void operator_output(op_type* op_pt, Bit32s modulator, Bit32s trem) {
 		// step_amp: 0.0 to 1.0
 		// vol  : 1/2^14 to 1/2^29 (/0x4000; /1../0x8000)
 
+#if OPL_FIXED
+		// fold the envelope into the volume first so nothing is rounded
+		// before the final shift, FM modulators amplify every lost bit
+		const Bit64s gain = ((Bit64s)op_pt->step_amp*op_pt->vol) >> 30;
+		const Bit64s y = (Bit64s)(op_pt->cur_wform[i&op_pt->cur_wmask]*trem)*gain;
+		const Bit32u shift = ENV_SHIFT + 14 + 4 + op_pt->vol_shift;	// envelope, 2^-14 and /16
+		op_pt->cval = (shift > 62) ? 0 : (Bit32s)((y >= 0) ? (y >> shift) : -((-y) >> shift));
+#else
 		op_pt->cval = (Bit32s)(op_pt->step_amp*op_pt->vol*op_pt->cur_wform[i&op_pt->cur_wmask]*trem/16.0);
+#endif
 	}
 }
 
@@ -250,18 +379,22 @@ void operator_sustain(op_type* op_pt) {
 // operator in release mode, if output level reaches zero the operator is turned off
 void operator_release(op_type* op_pt) {
 	// ??? boundary?
-	if (op_pt->amp > 0.00000001) {
+	if (envelope_above_min(op_pt)) {
 		// release phase
+#if OPL_FIXED
+		envelope_scale(op_pt, op_pt->releasemul);
+#else
 		op_pt->amp *= op_pt->releasemul;
+#endif
 	}
 
 	Bit32u num_steps_add = op_pt->generator_pos/FIXEDPT;	// number of (standardized) samples
 	for (Bit32u ct=0; ct<num_steps_add; ct++) {
 		op_pt->cur_env_step++;						// sample counter
 		if ((op_pt->cur_env_step & op_pt->env_step_r)==0) {
-			if (op_pt->amp <= 0.00000001) {
+			if (!envelope_above_min(op_pt)) {
 				// release phase finished, turn off this operator
-				op_pt->amp = 0.0;
+				envelope_set(op_pt, 0);
 				if (op_pt->op_state == OF_TYPE_REL) {
 					op_pt->op_state = OF_TYPE_OFF;
 				}
@@ -275,21 +408,27 @@ void operator_release(op_type* op_pt) {
 // operator in decay mode, if sustain level is reached the output level is either
 // kept (sustain level keep enabled) or the operator is switched into release mode
 void operator_decay(op_type* op_pt) {
-	if (op_pt->amp > op_pt->sustain_level) {
+	if (envelope_above(op_pt, op_pt->sustain_level)) {
 		// decay phase
+#if OPL_FIXED
+		envelope_scale(op_pt, op_pt->decaymul);
+		// a sustain level of 0 is never reached, as with floats
+		if (op_pt->amp == 0 && op_pt->amp_frac == 0) op_pt->amp_frac = 1;
+#else
 		op_pt->amp *= op_pt->decaymul;
+#endif
 	}
 
 	Bit32u num_steps_add = op_pt->generator_pos/FIXEDPT;	// number of (standardized) samples
 	for (Bit32u ct=0; ct<num_steps_add; ct++) {
 		op_pt->cur_env_step++;
 		if ((op_pt->cur_env_step & op_pt->env_step_d)==0) {
-			if (op_pt->amp <= op_pt->sustain_level) {
+			if (!envelope_above(op_pt, op_pt->sustain_level)) {
 				// decay phase finished, sustain level reached
 				if (op_pt->sus_keep) {
 					// keep sustain level (until turned off)
 					op_pt->op_state = OF_TYPE_SUS;
-					op_pt->amp = op_pt->sustain_level;
+					envelope_set(op_pt, op_pt->sustain_level);
 				} else {
 					// next: release phase
 					op_pt->op_state = OF_TYPE_SUS_NOKEEP;
@@ -301,21 +440,57 @@ void operator_decay(op_type* op_pt) {
 	op_pt->generator_pos -= num_steps_add*FIXEDPT;
 }
 
+#if OPL_FIXED
+// a*level for an attack coefficient in 6.56, which goes well past 2.0 for
+// fast attacks at low sample rates, and a level in 2.60 below 2.0; both fit
+// shifted up so that the high half of the product comes out in 6.56
+static inline Bit64s attack_mul(Bit64s a, Bit64u level) {
+	const Bit64s p = (Bit64s)mulhi64((Bit64u)(a < 0 ? -a : a) << 1, level << 3);
+	return (a < 0) ? -p : p;
+}
+#endif
+
 // operator in attack mode, if full output level is reached,
 // the operator is switched into decay mode
 void operator_attack(op_type* op_pt) {
+#if OPL_FIXED
+	// slow attacks add only a few hundred lsb of 2.30 a step, so the step is
+	// worked out from amp and amp_frac together and added to both
+	const Bit64u amp = ((Bit64u)op_pt->amp << ENV_SHIFT) | op_pt->amp_frac;
+	Bit64s t = attack_mul(op_pt->a3, amp) + op_pt->a2;
+	t = attack_mul(t, amp) + op_pt->a1;
+	t = attack_mul(t, amp) + op_pt->a0;
+	const Bit64s level = (Bit64s)amp + t*(1 << (2*ENV_SHIFT-ATTACK_SHIFT));
+	// anything above 1.0 ends the attack at the next step
+	if ((level >> ENV_SHIFT) < INT32_MAX) {
+		op_pt->amp = (Bit32s)(level >> ENV_SHIFT);
+		op_pt->amp_frac = (Bit32u)level & (ENV_FRAC_ONE - 1);
+	} else {
+		envelope_set(op_pt, INT32_MAX);
+	}
+#else
 	op_pt->amp = ((op_pt->a3*op_pt->amp + op_pt->a2)*op_pt->amp + op_pt->a1)*op_pt->amp + op_pt->a0;
+#endif
 
 	Bit32u num_steps_add = op_pt->generator_pos/FIXEDPT;		// number of (standardized) samples
 	for (Bit32u ct=0; ct<num_steps_add; ct++) {
 		op_pt->cur_env_step++;	// next sample
 		if ((op_pt->cur_env_step & op_pt->env_step_a)==0) {		// check if next step already reached
+#if OPL_FIXED
+			if (op_pt->amp > ENV_ONE) {
+				// attack phase finished, next: decay
+				op_pt->op_state = OF_TYPE_DEC;
+				envelope_set(op_pt, ENV_ONE);
+				op_pt->step_amp = ENV_ONE;
+			}
+#else
 			if (op_pt->amp > 1.0) {
 				// attack phase finished, next: decay
 				op_pt->op_state = OF_TYPE_DEC;
 				op_pt->amp = 1.0;
 				op_pt->step_amp = 1.0;
 			}
+#endif
 			op_pt->step_skip_pos_a <<= 1;
 			if (op_pt->step_skip_pos_a==0) op_pt->step_skip_pos_a = 1;
 			if (op_pt->step_skip_pos_a & op_pt->env_step_skip_a) {	// check if required to skip next step
@@ -338,6 +513,143 @@ optype_fptr opfuncs[6] = {
 	operator_off
 };
 
+// true if the envelope level can't change before the next register write:
+// sustained or switched off, or decaying/releasing at rate 0 (common for
+// organ-like instruments that hold their note until key off)
+static bool operator_env_held(const op_type* op_pt) {
+	switch (op_pt->op_state) {
+	case OF_TYPE_SUS:
+	case OF_TYPE_OFF:
+		return true;
+	case OF_TYPE_DEC:
+		return (op_pt->decaymul == ENVMUL_ONE) && envelope_above(op_pt, op_pt->sustain_level) && (op_pt->step_amp == op_pt->amp);
+	case OF_TYPE_REL:
+	case OF_TYPE_SUS_NOKEEP:
+		return (op_pt->releasemul == ENVMUL_ONE) && envelope_above_min(op_pt) && (op_pt->step_amp == op_pt->amp);
+	}
+	return false;
+}
+
+// true if the operator can't produce a nonzero sample for the rest of the block:
+// its envelope only falls from here (a decay may still jump up to a raised
+// sustain level) and even a full scale wave form with the deepest tremolo
+// stays below one unit of output
+static bool operator_silent(const op_type* op_pt) {
+	if (op_pt->op_state == OF_TYPE_OFF) return true;
+	if (op_pt->op_state == OF_TYPE_ATT) return false;
+
+#if OPL_FIXED
+	Bit32s level = (op_pt->amp > op_pt->step_amp) ? op_pt->amp : op_pt->step_amp;
+	if ((op_pt->op_state == OF_TYPE_DEC) && (op_pt->sustain_level > level)) level = op_pt->sustain_level;
+	const Bit64u gain = ((Bit64u)level*op_pt->vol) >> 30;
+	const Bit32u shift = ENV_SHIFT + 14 + 4 + op_pt->vol_shift;
+	return (shift > 62) || (((gain << (15+17)) >> shift) == 0);
+#else
+	fltype level = (op_pt->amp > op_pt->step_amp) ? op_pt->amp : op_pt->step_amp;
+	if ((op_pt->op_state == OF_TYPE_DEC) && (op_pt->sustain_level > level)) level = op_pt->sustain_level;
+	return level*op_pt->vol*32768.0*(2*FIXEDPT)/16.0 < 1.0;
+#endif
+}
+
+// run the envelope of an operator over count samples without producing output;
+// held envelopes only count steps, so they take one update per block, the
+// others still need their level updated every sample
+static void operator_envelope_block(op_type* op_pt, Bits count) {
+	if (operator_env_held(op_pt)) {
+		op_pt->generator_pos += generator_add*count;
+		if (op_pt->op_state == OF_TYPE_OFF) return;		// operator_off leaves the position alone
+
+		Bit32u num_steps_add = op_pt->generator_pos/FIXEDPT;
+		op_pt->cur_env_step += num_steps_add;
+		op_pt->generator_pos -= num_steps_add*FIXEDPT;
+		return;
+	}
+
+	for (Bits i=0; i<count; i++) {
+		op_pt->generator_pos += generator_add;
+		opfuncs[op_pt->op_state](op_pt);
+	}
+}
+
+// advance an operator operator_silent() allows to skip over count samples,
+// leaving it in exactly the state sample by sample rendering would
+static void operator_skip(op_type* op_pt, const Bit32s* vib, Bits count) {
+	if (vib == vibval_const) {
+		op_pt->wfpos = op_pt->tcount + (Bit32u)(count-1)*op_pt->tinc;
+		op_pt->tcount += (Bit32u)count*op_pt->tinc;
+	} else {
+		for (Bits i=0; i<count; i++) operator_advance_phase(op_pt, vib[i]);
+	}
+
+	// what operator_output would have produced all along
+	if (op_pt->op_state != OF_TYPE_OFF) {
+		op_pt->cval = 0;
+		op_pt->lastcval = 0;
+	}
+
+	operator_envelope_block(op_pt, count);
+}
+
+#if OPL_FIXED
+// 2^(-x) for x in 20.44, as 1.63; only called on register writes
+static Bit64u env_exp2_neg(Bit64u x) {
+	Bit32u whole = (Bit32u)(x >> 44);
+	if (whole >= ENVMUL_SHIFT) return 0;
+
+	// e^-y with y = frac(x)*ln 2 in 0.64, summing the series until the terms
+	// vanish; the terms are 0.64 too, the sum 1.63
+	Bit64u y = mulhi64(x << 20, 0xb17217f7d1cf79abull);
+	Bit64u term = y;
+	Bit64u sum = ENVMUL_ONE - (term >> 1);
+	for (Bit32u k=2; term; k++) {
+		term = mulhi64(term, y)/k;
+		sum += (k&1) ? -(term >> 1) : (term >> 1);
+	}
+	return sum >> whole;
+}
+
+void change_attackrate(Bitu regbase, op_type* op_pt) {
+	Bits attackrate = adlibreg[ARC_ATTR_DECR+regbase]>>4;
+	if (attackrate) {
+		Bits step_skip = attackrate*4 + op_pt->toff;
+		Bits steps = step_skip >> 2;
+		op_pt->env_step_a = (1<<(steps<=12?12-steps:0))-1;
+
+		Bits step_num = (step_skip<=48)?(4-(step_skip&3)):0;
+		static Bit8u step_skip_mask[5] = {0xff, 0xfe, 0xee, 0xba, 0xaa}; 
+		op_pt->env_step_skip_a = step_skip_mask[step_num];
+
+#if defined(OPLTYPE_IS_OPL3)
+		if (step_skip>=60) {
+#else
+		if (step_skip>=62) {
+#endif
+			op_pt->a0 = (Bit64s)2 << ATTACK_SHIFT;	// something that triggers an immediate transition to amp:=1.0
+			op_pt->a1 = 0;
+			op_pt->a2 = 0;
+			op_pt->a3 = 0;
+		} else {
+			// coefficient*2^(attackrate+toff/4-1)*attackconst/samplerate
+			const Bit64u *coef = attackcoef[op_pt->toff&3];
+			const Bits shift = attackrate+(op_pt->toff>>2)-1;
+			// attack rate coefficients, a1 without its 1.0 so that the
+			// polynomial gives the step rather than the new level
+			op_pt->a0 = (Bit64s)(((coef[0] << (ATTACK_SHIFT-50))/int_samplerate) << shift);
+			op_pt->a1 = (Bit64s)((coef[1]/int_samplerate) << (ATTACK_SHIFT-50+shift));
+			op_pt->a2 = -(Bit64s)((coef[2]/int_samplerate) << (ATTACK_SHIFT-50+shift));
+			op_pt->a3 = (Bit64s)((coef[3]/int_samplerate) << (ATTACK_SHIFT-50+shift));
+		}
+	} else {
+		// attack disabled
+		op_pt->a0 = 0;
+		op_pt->a1 = 0;
+		op_pt->a2 = 0;
+		op_pt->a3 = 0;
+		op_pt->env_step_a = 0;
+		op_pt->env_step_skip_a = 0;
+	}
+}
+#else
 void change_attackrate(Bitu regbase, op_type* op_pt) {
 	Bits attackrate = adlibreg[ARC_ATTR_DECR+regbase]>>4;
 	if (attackrate) {
@@ -376,7 +688,40 @@ void change_attackrate(Bitu regbase, op_type* op_pt) {
 		op_pt->env_step_skip_a = 0;
 	}
 }
+#endif
+
+#if OPL_FIXED
+void change_decayrate(Bitu regbase, op_type* op_pt) {
+	Bits decayrate = adlibreg[ARC_ATTR_DECR+regbase]&15;
+	// decaymul should be 1.0 when decayrate==0
+	if (decayrate) {
+		op_pt->decaymul = env_exp2_neg((decrelconst[op_pt->toff&3] << (decayrate+(op_pt->toff>>2)))/int_samplerate);
+		Bits steps = (decayrate*4 + op_pt->toff) >> 2;
+		op_pt->env_step_d = (1<<(steps<=12?12-steps:0))-1;
+	} else {
+		op_pt->decaymul = ENVMUL_ONE;
+		op_pt->env_step_d = 0;
+	}
+}
+
+void change_releaserate(Bitu regbase, op_type* op_pt) {
+	Bits releaserate = adlibreg[ARC_SUSL_RELR+regbase]&15;
+	// releasemul should be 1.0 when releaserate==0
+	if (releaserate) {
+		op_pt->releasemul = env_exp2_neg((decrelconst[op_pt->toff&3] << (releaserate+(op_pt->toff>>2)))/int_samplerate);
+		Bits steps = (releaserate*4 + op_pt->toff) >> 2;
+		op_pt->env_step_r = (1<<(steps<=12?12-steps:0))-1;
+	} else {
+		op_pt->releasemul = ENVMUL_ONE;
+		op_pt->env_step_r = 0;
+	}
+}
 
+void change_sustainlevel(Bitu regbase, op_type* op_pt) {
+	// sustainlevel is 0 when sustainlevel==15 (max)
+	op_pt->sustain_level = sustain_levels[adlibreg[ARC_SUSL_RELR+regbase]>>4];
+}
+#else
 void change_decayrate(Bitu regbase, op_type* op_pt) {
 	Bits decayrate = adlibreg[ARC_ATTR_DECR+regbase]&15;
 	// decaymul should be 1.0 when decayrate==0
@@ -414,6 +759,7 @@ void change_sustainlevel(Bitu regbase, op_type* op_pt) {
 		op_pt->sustain_level = 0.0;
 	}
 }
+#endif
 
 void change_waveform(Bitu regbase, op_type* op_pt) {
 #if defined(OPLTYPE_IS_OPL3)
@@ -443,7 +789,11 @@ void change_vibrato(Bitu regbase, op_type* op_pt) {
 // change amount of self-feedback
 void change_feedback(Bitu chanbase, op_type* op_pt) {
 	Bits feedback = adlibreg[ARC_FEEDBACK+chanbase]&14;
+#if OPL_FIXED
+	if (feedback) op_pt->mfbi = 1 << ((feedback>>1)+8);
+#else
 	if (feedback) op_pt->mfbi = (Bit32s)(pow(FL2,(fltype)((feedback>>1)+8)));
+#endif
 	else op_pt->mfbi = 0;
 }
 
@@ -462,12 +812,22 @@ void change_frequency(Bitu chanbase, Bitu regbase, op_type* op_pt) {
 	// envelope scaling (KSR)
 	if (!(adlibreg[ARC_TVS_KSR_MUL+regbase]&0x10)) op_pt->toff >>= 2;
 
+#if OPL_FIXED
+	// 20+a0+b0:
+	op_pt->tinc = (Bit32u)((((Bit64u)(frn<<oct))*frqmul[adlibreg[ARC_TVS_KSR_MUL+regbase]&15])/(9*int_samplerate));
+	// 40+a0+b0: attenuation in quarter steps, 2^(vol_in/-32-14)
+	Bit32u vol_in = ((Bit32u)(adlibreg[ARC_KSL_OUTLEV+regbase]&63) << 2) +
+							kslmul[adlibreg[ARC_KSL_OUTLEV+regbase]>>6]*kslev[oct][frn>>6];
+	op_pt->vol = vol_mantissa[vol_in&31];
+	op_pt->vol_shift = vol_in>>5;
+#else
 	// 20+a0+b0:
 	op_pt->tinc = (Bit32u)((((fltype)(frn<<oct))*frqmul[adlibreg[ARC_TVS_KSR_MUL+regbase]&15]));
 	// 40+a0+b0:
 	fltype vol_in = (fltype)((fltype)(adlibreg[ARC_KSL_OUTLEV+regbase]&63) +
 							kslmul[adlibreg[ARC_KSL_OUTLEV+regbase]>>6]*kslev[oct][frn>>6]);
 	op_pt->vol = (fltype)(pow(FL2,(fltype)(vol_in * -0.125 - 14)));
+#endif
 
 	// operator frequency changed, care about features that depend on it
 	change_attackrate(regbase,op_pt);
@@ -500,10 +860,18 @@ void disable_operator(op_type* op_pt, Bit32u act_type) {
 }
 
 void adlib_init(Bit32u samplerate) {
+#if OPL_FIXED
+	Bits i;
+#else
 	Bits i, j, oct;
+#endif
 
 	int_samplerate = samplerate;
+#if OPL_FIXED
+	generator_add = (Bit32u)(((Bit64u)OPL_CLOCK*FIXEDPT)/(288*int_samplerate));
+#else
 	generator_add = (Bit32u)(INTFREQU*FIXEDPT/int_samplerate);
+#endif
 /*
 	if(wavtable == NULL)
 	{
@@ -522,9 +890,9 @@ void adlib_init(Bit32u samplerate) {
 	for (i=0;i<MAXOPERATORS;i++) {
 		op[i].op_state = OF_TYPE_OFF;
 		op[i].act_state = OP_ACT_OFF;
-		op[i].amp = 0.0;
-		op[i].step_amp = 0.0;
-		op[i].vol = 0.0;
+		op[i].amp = 0;
+		op[i].step_amp = 0;
+		op[i].vol = 0;
 		op[i].tcount = 0;
 		op[i].tinc = 0;
 		op[i].toff = 0;
@@ -548,15 +916,35 @@ void adlib_init(Bit32u samplerate) {
 #endif
 	}
 
+#if OPL_FIXED
+	// frqmul_tab/2*INTFREQU/WAVEPREC*FIXEDPT/samplerate, with the division by
+	// 9*samplerate left to change_frequency
+	for (i=15;i>=0;i--) {
+		frqmul[i] = (Bit64u)frqmul_tab[i]*OPL_CLOCK;
+	}
+#else
 	recipsamp = 1.0 / (fltype)int_samplerate;
 	for (i=15;i>=0;i--) {
 		frqmul[i] = (fltype)(frqmul_tab[i]*INTFREQU/(fltype)WAVEPREC*(fltype)FIXEDPT*recipsamp);
 	}
+#endif
 
 	status = 0;
 	opl_index = 0;
 
 
+#if OPL_FIXED
+	vibtab_add = (Bit32u)(((Bit64u)VIBTAB_SIZE*FIXEDPT_LFO/8192*OPL_CLOCK)/(288*int_samplerate));
+	vibtab_pos = 0;
+
+	for (i=0; i<BLOCKBUF_SIZE; i++) vibval_const[i] = 0;
+
+	// tremolo at 3.7hz
+	tremtab_add = (Bit32u)(((Bit64u)TREMTAB_SIZE*37*FIXEDPT_LFO)/(10*int_samplerate));
+	tremtab_pos = 0;
+
+	for (i=0; i<BLOCKBUF_SIZE; i++) tremval_const[i] = FIXEDPT;
+#else
 	// create vibrato table
 	vib_table[0] = 8;
 	vib_table[1] = 4;
@@ -629,6 +1017,7 @@ void adlib_init(Bit32u samplerate) {
 			}
 		}
 	}
+#endif
 
 }
 
@@ -1041,8 +1430,8 @@ void adlib_getsample(Bit16s* sndptr, Bits numsamples) {
 						for (i=0;i<endsamples;i++)
 							vibval1[i] = (Bit32s)((vib_lut[i]*cptr[9].freq_high/8)*FIXEDPT*VIBFAC);
 					} else vibval1 = vibval_const;
-					// if (cptr[9].tremolo) tremval1 = trem_lut;	// tremolo enabled, use table
-					// else tremval1 = tremval_const;
+					if (cptr[9].tremolo) tremval1 = trem_lut;	// tremolo enabled, use table
+					else tremval1 = tremval_const;
 
 					// calculate channel output
 					for (i=0;i<endsamples;i++) {
@@ -1067,10 +1456,10 @@ void adlib_getsample(Bit16s* sndptr, Bits numsamples) {
 						for (i=0;i<endsamples;i++)
 							vibval2[i] = (Bit32s)((vib_lut[i]*cptr[9].freq_high/8)*FIXEDPT*VIBFAC);
 					} else vibval2 = vibval_const;
-					// if (cptr[0].tremolo) tremval1 = trem_lut;	// tremolo enabled, use table
-					// else tremval1 = tremval_const;
-					// if (cptr[9].tremolo) tremval2 = trem_lut;	// tremolo enabled, use table
-					// else tremval2 = tremval_const;
+					if (cptr[0].tremolo) tremval1 = trem_lut;	// tremolo enabled, use table
+					else tremval1 = tremval_const;
+					if (cptr[9].tremolo) tremval2 = trem_lut;	// tremolo enabled, use table
+					else tremval2 = tremval_const;
 
 					// calculate channel output
 					for (i=0;i<endsamples;i++) {
@@ -1097,8 +1486,8 @@ void adlib_getsample(Bit16s* sndptr, Bits numsamples) {
 						vibval3[i] = (Bit32s)((vib_lut[i]*cptr[0].freq_high/8)*FIXEDPT*VIBFAC);
 				} else vibval3 = vibval_const;
 
-				// if (cptr[0].tremolo) tremval3 = trem_lut;	// tremolo enabled, use table
-				// else tremval3 = tremval_const;
+				if (cptr[0].tremolo) tremval3 = trem_lut;	// tremolo enabled, use table
+				else tremval3 = tremval_const;
 
 				// calculate channel output
 				for (i=0;i<endsamples;i++) {
@@ -1125,10 +1514,10 @@ void adlib_getsample(Bit16s* sndptr, Bits numsamples) {
 						vibval2[i] = (Bit32s)((vib_lut[i]*cptr[9].freq_high/8)*FIXEDPT*VIBFAC);
 				} else vibval2 = vibval_const;
 
-				// if (cptr[0].tremolo) tremval1 = trem_lut;	// tremolo enabled, use table
-				// else tremval1 = tremval_const;
-				// if (cptr[9].tremolo) tremval2 = trem_lut;	// tremolo enabled, use table
-				// else tremval2 = tremval_const;
+				if (cptr[0].tremolo) tremval1 = trem_lut;	// tremolo enabled, use table
+				else tremval1 = tremval_const;
+				if (cptr[9].tremolo) tremval2 = trem_lut;	// tremolo enabled, use table
+				else tremval2 = tremval_const;
 
 				cptr = &op[8];
 				if ((cptr[9].vibrato) && (cptr[9].op_state == OF_TYPE_OFF)) {
@@ -1137,8 +1526,8 @@ void adlib_getsample(Bit16s* sndptr, Bits numsamples) {
 						vibval4[i] = (Bit32s)((vib_lut[i]*cptr[9].freq_high/8)*FIXEDPT*VIBFAC);
 				} else vibval4 = vibval_const;
 
-				// if (cptr[9].tremolo) tremval4 = trem_lut;	// tremolo enabled, use table
-				// else tremval4 = tremval_const;
+				if (cptr[9].tremolo) tremval4 = trem_lut;	// tremolo enabled, use table
+				else tremval4 = tremval_const;
 
 				// calculate channel output
 				for (i=0;i<endsamples;i++) {
@@ -1316,25 +1705,60 @@ void adlib_getsample(Bit16s* sndptr, Bits numsamples) {
 					for (i=0;i<endsamples;i++)
 						vibval2[i] = (Bit32s)((vib_lut[i]*cptr[9].freq_high/8)*FIXEDPT*VIBFAC);
 				} else vibval2 = vibval_const;
-				// if (cptr[0].tremolo) tremval1 = trem_lut;	// tremolo enabled, use table
-				// else tremval1 = tremval_const;
-				// if (cptr[9].tremolo) tremval2 = trem_lut;	// tremolo enabled, use table
-				// else tremval2 = tremval_const;
+				if (cptr[0].tremolo) tremval1 = trem_lut;	// tremolo enabled, use table
+				else tremval1 = tremval_const;
+				if (cptr[9].tremolo) tremval2 = trem_lut;	// tremolo enabled, use table
+				else tremval2 = tremval_const;
+
+				// carriers nobody can hear only keep time
+				bool silent1 = operator_silent(&cptr[0]), silent2 = operator_silent(&cptr[9]);
+				if (silent1) operator_skip(&cptr[0],vibval1,endsamples);
+				if (silent2) operator_skip(&cptr[9],vibval2,endsamples);
+				if (silent1 && silent2) continue;
+
+				if (silent1 || silent2) {
+					// a single carrier left
+					op_type* live = silent1 ? &cptr[9] : &cptr[0];
+					Bit32s* vibval = silent1 ? vibval2 : vibval1;
+					Bit32s* tremval = silent1 ? tremval2 : tremval1;
+					for (i=0;i<endsamples;i++) {
+						operator_advance(live,vibval[i]);
+						opfuncs[live->op_state](live);
+						operator_output(live,silent1 ? 0 : (live->lastcval+live->cval)*live->mfbi/2,tremval[i]);
 
-				// calculate channel output
-				for (i=0;i<endsamples;i++) {
-					// carrier1
-					operator_advance(&cptr[0],vibval1[i]);
-					opfuncs[cptr[0].op_state](&cptr[0]);
-					operator_output(&cptr[0],(cptr[0].lastcval+cptr[0].cval)*cptr[0].mfbi/2,tremval1[i]);
+						Bit32s chanval = live->cval;
+						CHANVAL_OUT
+					}
+				} else if (operator_env_held(&cptr[0]) && operator_env_held(&cptr[9])) {
+					// held notes, the envelopes only count steps
+					operator_envelope_block(&cptr[0],endsamples);
+					operator_envelope_block(&cptr[9],endsamples);
+					for (i=0;i<endsamples;i++) {
+						operator_advance_phase(&cptr[0],vibval1[i]);
+						operator_output(&cptr[0],(cptr[0].lastcval+cptr[0].cval)*cptr[0].mfbi/2,tremval1[i]);
 
-					// carrier2
-					operator_advance(&cptr[9],vibval2[i]);
-					opfuncs[cptr[9].op_state](&cptr[9]);
-					operator_output(&cptr[9],0,tremval2[i]);
+						operator_advance_phase(&cptr[9],vibval2[i]);
+						operator_output(&cptr[9],0,tremval2[i]);
 
-					Bit32s chanval = cptr[9].cval + cptr[0].cval;
-					CHANVAL_OUT
+						Bit32s chanval = cptr[9].cval + cptr[0].cval;
+						CHANVAL_OUT
+					}
+				} else {
+					// calculate channel output
+					for (i=0;i<endsamples;i++) {
+						// carrier1
+						operator_advance(&cptr[0],vibval1[i]);
+						opfuncs[cptr[0].op_state](&cptr[0]);
+						operator_output(&cptr[0],(cptr[0].lastcval+cptr[0].cval)*cptr[0].mfbi/2,tremval1[i]);
+
+						// carrier2
+						operator_advance(&cptr[9],vibval2[i]);
+						opfuncs[cptr[9].op_state](&cptr[9]);
+						operator_output(&cptr[9],0,tremval2[i]);
+
+						Bit32s chanval = cptr[9].cval + cptr[0].cval;
+						CHANVAL_OUT
+					}
 				}
 			} else {
 #if defined(OPLTYPE_IS_OPL3)
@@ -1454,25 +1878,54 @@ void adlib_getsample(Bit16s* sndptr, Bits numsamples) {
 					for (i=0;i<endsamples;i++)
 						vibval2[i] = (Bit32s)((vib_lut[i]*cptr[9].freq_high/8)*FIXEDPT*VIBFAC);
 				} else vibval2 = vibval_const;
-				// if (cptr[0].tremolo) tremval1 = trem_lut;	// tremolo enabled, use table
-				// else tremval1 = tremval_const;
-				// if (cptr[9].tremolo) tremval2 = trem_lut;	// tremolo enabled, use table
-				// else tremval2 = tremval_const;
+				if (cptr[0].tremolo) tremval1 = trem_lut;	// tremolo enabled, use table
+				else tremval1 = tremval_const;
+				if (cptr[9].tremolo) tremval2 = trem_lut;	// tremolo enabled, use table
+				else tremval2 = tremval_const;
+
+				if (operator_silent(&cptr[9])) {
+					// nothing reaches the output, but the modulator keeps its
+					// feedback history exact for when the carrier comes back
+					operator_skip(&cptr[9],vibval2,endsamples);
+					if (operator_silent(&cptr[0])) {
+						operator_skip(&cptr[0],vibval1,endsamples);
+					} else {
+						for (i=0;i<endsamples;i++) {
+							operator_advance(&cptr[0],vibval1[i]);
+							opfuncs[cptr[0].op_state](&cptr[0]);
+							operator_output(&cptr[0],(cptr[0].lastcval+cptr[0].cval)*cptr[0].mfbi/2,tremval1[i]);
+						}
+					}
+				} else if (operator_env_held(&cptr[0]) && operator_env_held(&cptr[9])) {
+					// held note, the envelopes only count steps
+					operator_envelope_block(&cptr[0],endsamples);
+					operator_envelope_block(&cptr[9],endsamples);
+					for (i=0;i<endsamples;i++) {
+						operator_advance_phase(&cptr[0],vibval1[i]);
+						operator_output(&cptr[0],(cptr[0].lastcval+cptr[0].cval)*cptr[0].mfbi/2,tremval1[i]);
 
-				// calculate channel output
-				for (i=0;i<endsamples;i++) {
-					// modulator
-					operator_advance(&cptr[0],vibval1[i]);
-					opfuncs[cptr[0].op_state](&cptr[0]);
-					operator_output(&cptr[0],(cptr[0].lastcval+cptr[0].cval)*cptr[0].mfbi/2,tremval1[i]);
+						operator_advance_phase(&cptr[9],vibval2[i]);
+						operator_output(&cptr[9],cptr[0].cval*FIXEDPT,tremval2[i]);
+
+						Bit32s chanval = cptr[9].cval;
+						CHANVAL_OUT
+					}
+				} else {
+					// calculate channel output
+					for (i=0;i<endsamples;i++) {
+						// modulator
+						operator_advance(&cptr[0],vibval1[i]);
+						opfuncs[cptr[0].op_state](&cptr[0]);
+						operator_output(&cptr[0],(cptr[0].lastcval+cptr[0].cval)*cptr[0].mfbi/2,tremval1[i]);
 
-					// carrier
-					operator_advance(&cptr[9],vibval2[i]);
-					opfuncs[cptr[9].op_state](&cptr[9]);
-					operator_output(&cptr[9],cptr[0].cval*FIXEDPT,tremval2[i]);
+						// carrier
+						operator_advance(&cptr[9],vibval2[i]);
+						opfuncs[cptr[9].op_state](&cptr[9]);
+						operator_output(&cptr[9],cptr[0].cval*FIXEDPT,tremval2[i]);
 
-					Bit32s chanval = cptr[9].cval;
-					CHANVAL_OUT
+						Bit32s chanval = cptr[9].cval;
+						CHANVAL_OUT
+					}
 				}
 			}
 		}
@@ -28,6 +28,18 @@
 //#define OPLTYPE_IS_OPL3 1
 #define fltype double
 
+// Integer-only synthesis: envelopes and volumes in fixed point and every table
+// constant (see opl_tables.h).  The floating point emulator stays available as
+// the reference; the ESP32 cores only have a single precision FPU, so every
+// double operation there is a library call.
+#ifndef OPL_FIXED
+#define OPL_FIXED 1
+#endif
+
+// Bumped by every change that alters the rendered output, so that recordings
+// of the old output (see music_cache.c) are thrown away instead of played.
+#define OPL_VERSION 2
+
 #include <stdbool.h>
 #include <stdint.h>
 #include "esp_heap_caps.h"
@@ -35,6 +47,8 @@
 
 typedef uintptr_t	Bitu;
 typedef intptr_t	Bits;
+typedef uint64_t	Bit64u;
+typedef int64_t		Bit64s;
 typedef uint32_t	Bit32u;
 typedef int32_t		Bit32s;
 typedef uint16_t	Bit16u;
@@ -133,16 +147,27 @@ typedef signed char		Bit8s;
 typedef struct operator_struct {
 	Bit32s cval, lastcval;			// current output/last output (used for feedback)
 	Bit32u tcount, wfpos, tinc;		// time (position in waveform) and time increment
+#if OPL_FIXED
+	Bit32s amp, step_amp;			// and amplification (envelope), 2.30
+	Bit32u amp_frac;				// bits of amp below its lsb, 0.30, carried by the envelope
+	Bit32s vol;						// volume mantissa, 2.30
+	Bit32u vol_shift;				// and exponent
+	Bit32s sustain_level;			// sustain level, 2.30
+	Bit32s mfbi;					// feedback amount
+	Bit64s a0, a1, a2, a3;			// attack rate function coefficients, 6.56
+	Bit64u decaymul, releasemul;	// decay/release rate functions, 1.63
+#else
 	fltype amp, step_amp;			// and amplification (envelope)
 	fltype vol;						// volume
 	fltype sustain_level;			// sustain level
 	Bit32s mfbi;					// feedback amount
 	fltype a0, a1, a2, a3;			// attack rate function coefficients
 	fltype decaymul, releasemul;	// decay/release rate functions
+#endif
 	Bit32u op_state;				// current state of operator (attack/decay/sustain/release/off)
 	Bit32u toff;
 	Bit32s freq_high;				// highest three bits of the frequency, used for vibrato calculations
-	Bit16s* cur_wform;				// start of selected waveform
+	const Bit16s* cur_wform;		// start of selected waveform
 	Bit32u cur_wmask;				// mask for selected waveform
 	Bit32u act_state;				// activity state (regular, percussion)
 	bool sus_keep;					// keep sustain level when decay finished
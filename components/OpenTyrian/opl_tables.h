@@ -0,0 +1,244 @@
+/* generated by tools/opl/gen_opl_tables.c -- do not edit */
+#ifndef OPL_TABLES_H
+#define OPL_TABLES_H
+
+DRAM_ATTR static const Bit16s wavtable[WAVEPREC*3] = {
+	0, 201, 402, 603, 803, 1004, 1205, 1405, 1605, 1805, 2005, 2204, 2404, 2602, 2801, 2998,
+	3196, 3393, 3589, 3785, 3980, 4175, 4369, 4563, 4756, 4948, 5139, 5329, 5519, 5708, 5896, 6083,
+	6269, 6455, 6639, 6822, 7005, 7186, 7366, 7545, 7723, 7900, 8075, 8249, 8423, 8594, 8765, 8934,
+	9102, 9268, 9434, 9597, 9759, 9920, 10079, 10237, 10393, 10548, 10701, 10853, 11002, 11150, 11297, 11442,
+	11585, 11726, 11866, 12003, 12139, 12273, 12406, 12536, 12665, 12791, 12916, 13038, 13159, 13278, 13395, 13510,
+	13622, 13733, 13842, 13948, 14053, 14155, 14255, 14353, 14449, 14543, 14634, 14723, 14810, 14895, 14978, 15058,
+	15136, 15212, 15286, 15357, 15426, 15492, 15557, 15618, 15678, 15735, 15790, 15842, 15892, 15940, 15985, 16028,
+	16069, 16107, 16142, 16175, 16206, 16234, 16260, 16284, 16305, 16323, 16339, 16353, 16364, 16372, 16379, 16382,
+	16384, 16382, 16379, 16372, 16364, 16353, 16339, 16323, 16305, 16284, 16260, 16234, 16206, 16175, 16142, 16107,
+	16069, 16028, 15985, 15940, 15892, 15842, 15790, 15735, 15678, 15618, 15557, 15492, 15426, 15357, 15286, 15212,
+	15136, 15058, 14978, 14895, 14810, 14723, 14634, 14543, 14449, 14353, 14255, 14155, 14053, 13948, 13842, 13733,
+	13622, 13510, 13395, 13278, 13159, 13038, 12916, 12791, 12665, 12536, 12406, 12273, 12139, 12003, 11866, 11726,
+	11585, 11442, 11297, 11150, 11002, 10853, 10701, 10548, 10393, 10237, 10079, 9920, 9759, 9597, 9434, 9268,
+	9102, 8934, 8765, 8594, 8423, 8249, 8075, 7900, 7723, 7545, 7366, 7186, 7005, 6822, 6639, 6455,
+	6269, 6083, 5896, 5708, 5519, 5329, 5139, 4948, 4756, 4563, 4369, 4175, 3980, 3785, 3589, 3393,
+	3196, 2998, 2801, 2602, 2404, 2204, 2005, 1805, 1605, 1405, 1205, 1004, 803, 603, 402, 201,
+	0, -201, -402, -603, -803, -1004, -1205, -1405, -1605, -1805, -2005, -2204, -2404, -2602, -2801, -2998,
+	-3196, -3393, -3589, -3785, -3980, -4175, -4369, -4563, -4756, -4948, -5139, -5329, -5519, -5708, -5896, -6083,
+	-6269, -6455, -6639, -6822, -7005, -7186, -7366, -7545, -7723, -7900, -8075, -8249, -8423, -8594, -8765, -8934,
+	-9102, -9268, -9434, -9597, -9759, -9920, -10079, -10237, -10393, -10548, -10701, -10853, -11002, -11150, -11297, -11442,
+	-11585, -11726, -11866, -12003, -12139, -12273, -12406, -12536, -12665, -12791, -12916, -13038, -13159, -13278, -13395, -13510,
+	-13622, -13733, -13842, -13948, -14053, -14155, -14255, -14353, -14449, -14543, -14634, -14723, -14810, -14895, -14978, -15058,
+	-15136, -15212, -15286, -15357, -15426, -15492, -15557, -15618, -15678, -15735, -15790, -15842, -15892, -15940, -15985, -16028,
+	-16069, -16107, -16142, -16175, -16206, -16234, -16260, -16284, -16305, -16323, -16339, -16353, -16364, -16372, -16379, -16382,
+	-16384, -16382, -16379, -16372, -16364, -16353, -16339, -16323, -16305, -16284, -16260, -16234, -16206, -16175, -16142, -16107,
+	-16069, -16028, -15985, -15940, -15892, -15842, -15790, -15735, -15678, -15618, -15557, -15492, -15426, -15357, -15286, -15212,
+	-15136, -15058, -14978, -14895, -14810, -14723, -14634, -14543, -14449, -14353, -14255, -14155, -14053, -13948, -13842, -13733,
+	-13622, -13510, -13395, -13278, -13159, -13038, -12916, -12791, -12665, -12536, -12406, -12273, -12139, -12003, -11866, -11726,
+	-11585, -11442, -11297, -11150, -11002, -10853, -10701, -10548, -10393, -10237, -10079, -9920, -9759, -9597, -9434, -9268,
+	-9102, -8934, -8765, -8594, -8423, -8249, -8075, -7900, -7723, -7545, -7366, -7186, -7005, -6822, -6639, -6455,
+	-6269, -6083, -5896, -5708, -5519, -5329, -5139, -4948, -4756, -4563, -4369, -4175, -3980, -3785, -3589, -3393,
+	-3196, -2998, -2801, -2602, -2404, -2204, -2005, -1805, -1605, -1405, -1205, -1004, -803, -603, -402, -201,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 100, 201, 301, 402, 502, 603, 703, 803, 904, 1004, 1105, 1205, 1305, 1405, 1505,
+	1605, 1705, 1805, 1905, 2005, 2105, 2204, 2304, 2404, 2503, 2602, 2701, 2801, 2900, 2998, 3097,
+	3196, 3294, 3393, 3491, 3589, 3687, 3785, 3883, 3980, 4078, 4175, 4272, 4369, 4466, 4563, 4659,
+	4756, 4852, 4948, 5043, 5139, 5234, 5329, 5424, 5519, 5614, 5708, 5802, 5896, 5990, 6083, 6176,
+	6269, 6362, 6455, 6547, 6639, 6731, 6822, 6914, 7005, 7095, 7186, 7276, 7366, 7456, 7545, 7634,
+	7723, 7811, 7900, 7988, 8075, 8162, 8249, 8336, 8423, 8509, 8594, 8680, 8765, 8850, 8934, 9018,
+	9102, 9185, 9268, 9351, 9434, 9516, 9597, 9679, 9759, 9840, 9920, 10000, 10079, 10159, 10237, 10315,
+	10393, 10471, 10548, 10625, 10701, 10777, 10853, 10928, 11002, 11077, 11150, 11224, 11297, 11370, 11442, 11513,
+	11585, 11656, 11726, 11796, 11866, 11935, 12003, 12072, 12139, 12207, 12273, 12340, 12406, 12471, 12536, 12600,
+	12665, 12728, 12791, 12854, 12916, 12977, 13038, 13099, 13159, 13219, 13278, 13337, 13395, 13452, 13510, 13566,
+	13622, 13678, 13733, 13788, 13842, 13895, 13948, 14001, 14053, 14104, 14155, 14205, 14255, 14304, 14353, 14401,
+	14449, 14496, 14543, 14589, 14634, 14679, 14723, 14767, 14810, 14853, 14895, 14937, 14978, 15018, 15058, 15098,
+	15136, 15175, 15212, 15249, 15286, 15322, 15357, 15392, 15426, 15459, 15492, 15525, 15557, 15588, 15618, 15649,
+	15678, 15707, 15735, 15763, 15790, 15817, 15842, 15868, 15892, 15917, 15940, 15963, 15985, 16007, 16028, 16049,
+	16069, 16088, 16107, 16125, 16142, 16159, 16175, 16191, 16206, 16221, 16234, 16248, 16260, 16272, 16284, 16294,
+	16305, 16314, 16323, 16331, 16339, 16346, 16353, 16359, 16364, 16368, 16372, 16376, 16379, 16381, 16382, 16383,
+	16384, 16383, 16382, 16381, 16379, 16376, 16372, 16368, 16364, 16359, 16353, 16346, 16339, 16331, 16323, 16314,
+	16305, 16294, 16284, 16272, 16260, 16248, 16234, 16221, 16206, 16191, 16175, 16159, 16142, 16125, 16107, 16088,
+	16069, 16049, 16028, 16007, 15985, 15963, 15940, 15917, 15892, 15868, 15842, 15817, 15790, 15763, 15735, 15707,
+	15678, 15649, 15618, 15588, 15557, 15525, 15492, 15459, 15426, 15392, 15357, 15322, 15286, 15249, 15212, 15175,
+	15136, 15098, 15058, 15018, 14978, 14937, 14895, 14853, 14810, 14767, 14723, 14679, 14634, 14589, 14543, 14496,
+	14449, 14401, 14353, 14304, 14255, 14205, 14155, 14104, 14053, 14001, 13948, 13895, 13842, 13788, 13733, 13678,
+	13622, 13566, 13510, 13452, 13395, 13337, 13278, 13219, 13159, 13099, 13038, 12977, 12916, 12854, 12791, 12728,
+	12665, 12600, 12536, 12471, 12406, 12340, 12273, 12207, 12139, 12072, 12003, 11935, 11866, 11796, 11726, 11656,
+	11585, 11513, 11442, 11370, 11297, 11224, 11150, 11077, 11002, 10928, 10853, 10777, 10701, 10625, 10548, 10471,
+	10393, 10315, 10237, 10159, 10079, 10000, 9920, 9840, 9759, 9679, 9597, 9516, 9434, 9351, 9268, 9185,
+	9102, 9018, 8934, 8850, 8765, 8680, 8594, 8509, 8423, 8336, 8249, 8162, 8075, 7988, 7900, 7811,
+	7723, 7634, 7545, 7456, 7366, 7276, 7186, 7095, 7005, 6914, 6822, 6731, 6639, 6547, 6455, 6362,
+	6269, 6176, 6083, 5990, 5896, 5802, 5708, 5614, 5519, 5424, 5329, 5234, 5139, 5043, 4948, 4852,
+	4756, 4659, 4563, 4466, 4369, 4272, 4175, 4078, 3980, 3883, 3785, 3687, 3589, 3491, 3393, 3294,
+	3196, 3097, 2998, 2900, 2801, 2701, 2602, 2503, 2404, 2304, 2204, 2105, 2005, 1905, 1805, 1705,
+	1605, 1505, 1405, 1305, 1205, 1105, 1004, 904, 803, 703, 603, 502, 402, 301, 201, 100,
+	0, -100, -201, -301, -402, -502, -603, -703, -803, -904, -1004, -1105, -1205, -1305, -1405, -1505,
+	-1605, -1705, -1805, -1905, -2005, -2105, -2204, -2304, -2404, -2503, -2602, -2701, -2801, -2900, -2998, -3097,
+	-3196, -3294, -3393, -3491, -3589, -3687, -3785, -3883, -3980, -4078, -4175, -4272, -4369, -4466, -4563, -4659,
+	-4756, -4852, -4948, -5043, -5139, -5234, -5329, -5424, -5519, -5614, -5708, -5802, -5896, -5990, -6083, -6176,
+	-6269, -6362, -6455, -6547, -6639, -6731, -6822, -6914, -7005, -7095, -7186, -7276, -7366, -7456, -7545, -7634,
+	-7723, -7811, -7900, -7988, -8075, -8162, -8249, -8336, -8423, -8509, -8594, -8680, -8765, -8850, -8934, -9018,
+	-9102, -9185, -9268, -9351, -9434, -9516, -9597, -9679, -9759, -9840, -9920, -10000, -10079, -10159, -10237, -10315,
+	-10393, -10471, -10548, -10625, -10701, -10777, -10853, -10928, -11002, -11077, -11150, -11224, -11297, -11370, -11442, -11513,
+	-11585, -11656, -11726, -11796, -11866, -11935, -12003, -12072, -12139, -12207, -12273, -12340, -12406, -12471, -12536, -12600,
+	-12665, -12728, -12791, -12854, -12916, -12977, -13038, -13099, -13159, -13219, -13278, -13337, -13395, -13452, -13510, -13566,
+	-13622, -13678, -13733, -13788, -13842, -13895, -13948, -14001, -14053, -14104, -14155, -14205, -14255, -14304, -14353, -14401,
+	-14449, -14496, -14543, -14589, -14634, -14679, -14723, -14767, -14810, -14853, -14895, -14937, -14978, -15018, -15058, -15098,
+	-15136, -15175, -15212, -15249, -15286, -15322, -15357, -15392, -15426, -15459, -15492, -15525, -15557, -15588, -15618, -15649,
+	-15678, -15707, -15735, -15763, -15790, -15817, -15842, -15868, -15892, -15917, -15940, -15963, -15985, -16007, -16028, -16049,
+	-16069, -16088, -16107, -16125, -16142, -16159, -16175, -16191, -16206, -16221, -16234, -16248, -16260, -16272, -16284, -16294,
+	-16305, -16314, -16323, -16331, -16339, -16346, -16353, -16359, -16364, -16368, -16372, -16376, -16379, -16381, -16382, -16383,
+	-16384, -16383, -16382, -16381, -16379, -16376, -16372, -16368, -16364, -16359, -16353, -16346, -16339, -16331, -16323, -16314,
+	-16305, -16294, -16284, -16272, -16260, -16248, -16234, -16221, -16206, -16191, -16175, -16159, -16142, -16125, -16107, -16088,
+	-16069, -16049, -16028, -16007, -15985, -15963, -15940, -15917, -15892, -15868, -15842, -15817, -15790, -15763, -15735, -15707,
+	-15678, -15649, -15618, -15588, -15557, -15525, -15492, -15459, -15426, -15392, -15357, -15322, -15286, -15249, -15212, -15175,
+	-15136, -15098, -15058, -15018, -14978, -14937, -14895, -14853, -14810, -14767, -14723, -14679, -14634, -14589, -14543, -14496,
+	-14449, -14401, -14353, -14304, -14255, -14205, -14155, -14104, -14053, -14001, -13948, -13895, -13842, -13788, -13733, -13678,
+	-13622, -13566, -13510, -13452, -13395, -13337, -13278, -13219, -13159, -13099, -13038, -12977, -12916, -12854, -12791, -12728,
+	-12665, -12600, -12536, -12471, -12406, -12340, -12273, -12207, -12139, -12072, -12003, -11935, -11866, -11796, -11726, -11656,
+	-11585, -11513, -11442, -11370, -11297, -11224, -11150, -11077, -11002, -10928, -10853, -10777, -10701, -10625, -10548, -10471,
+	-10393, -10315, -10237, -10159, -10079, -10000, -9920, -9840, -9759, -9679, -9597, -9516, -9434, -9351, -9268, -9185,
+	-9102, -9018, -8934, -8850, -8765, -8680, -8594, -8509, -8423, -8336, -8249, -8162, -8075, -7988, -7900, -7811,
+	-7723, -7634, -7545, -7456, -7366, -7276, -7186, -7095, -7005, -6914, -6822, -6731, -6639, -6547, -6455, -6362,
+	-6269, -6176, -6083, -5990, -5896, -5802, -5708, -5614, -5519, -5424, -5329, -5234, -5139, -5043, -4948, -4852,
+	-4756, -4659, -4563, -4466, -4369, -4272, -4175, -4078, -3980, -3883, -3785, -3687, -3589, -3491, -3393, -3294,
+	-3196, -3097, -2998, -2900, -2801, -2701, -2602, -2503, -2404, -2304, -2204, -2105, -2005, -1905, -1805, -1705,
+	-1605, -1505, -1405, -1305, -1205, -1105, -1004, -904, -803, -703, -603, -502, -402, -301, -201, -100,
+	0, -2, -5, -12, -20, -31, -45, -61, -79, -100, -124, -150, -178, -209, -242, -277,
+	-315, -356, -399, -444, -492, -542, -594, -649, -706, -766, -827, -892, -958, -1027, -1098, -1172,
+	-1248, -1326, -1406, -1489, -1574, -1661, -1750, -1841, -1935, -2031, -2129, -2229, -2331, -2436, -2542, -2651,
+	-2762, -2874, -2989, -3106, -3225, -3346, -3468, -3593, -3719, -3848, -3978, -4111, -4245, -4381, -4518, -4658,
+	-4799, -4942, -5087, -5234, -5382, -5531, -5683, -5836, -5991, -6147, -6305, -6464, -6625, -6787, -6950, -7116,
+	-7282, -7450, -7619, -7790, -7961, -8135, -8309, -8484, -8661, -8839, -9018, -9198, -9379, -9562, -9745, -9929,
+	-10115, -10301, -10488, -10676, -10865, -11055, -11245, -11436, -11628, -11821, -12015, -12209, -12404, -12599, -12795, -12991,
+	-13188, -13386, -13583, -13782, -13980, -14180, -14379, -14579, -14779, -14979, -15179, -15380, -15581, -15781, -15982, -16183,
+	16384, 16183, 15982, 15781, 15581, 15380, 15179, 14979, 14779, 14579, 14379, 14180, 13980, 13782, 13583, 13386,
+	13188, 12991, 12795, 12599, 12404, 12209, 12015, 11821, 11628, 11436, 11245, 11055, 10865, 10676, 10488, 10301,
+	10115, 9929, 9745, 9562, 9379, 9198, 9018, 8839, 8661, 8484, 8309, 8135, 7961, 7790, 7619, 7450,
+	7282, 7116, 6950, 6787, 6625, 6464, 6305, 6147, 5991, 5836, 5683, 5531, 5382, 5234, 5087, 4942,
+	4799, 4658, 4518, 4381, 4245, 4111, 3978, 3848, 3719, 3593, 3468, 3346, 3225, 3106, 2989, 2874,
+	2762, 2651, 2542, 2436, 2331, 2229, 2129, 2031, 1935, 1841, 1750, 1661, 1574, 1489, 1406, 1326,
+	1248, 1172, 1098, 1027, 958, 892, 827, 766, 706, 649, 594, 542, 492, 444, 399, 356,
+	315, 277, 242, 209, 178, 150, 124, 100, 79, 61, 45, 31, 20, 12, 5, 2,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+};
+
+static const Bit32s vib_table[VIBTAB_SIZE] = {
+	8, 4, 0, -4, -8, -4, 0, 4,
+};
+
+static const Bit32s trem_table[TREMTAB_SIZE*2] = {
+	49667, 50737, 51831, 52948, 54090, 55256, 56447, 57664,
+	58907, 60176, 61474, 62799, 64153, 65536, 65536, 64153,
+	62799, 61474, 60176, 58907, 57664, 56447, 55256, 54090,
+	52948, 51831, 50737, 49667, 48618, 47592, 46588, 45605,
+	44643, 43701, 42779, 41876, 40992, 40127, 39280, 38451,
+	37640, 38451, 39280, 40127, 40992, 41876, 42779, 43701,
+	44643, 45605, 46588, 47592, 48618, 61147, 61147, 62576,
+	62576, 62576, 62576, 64039, 64039, 64039, 64039, 65536,
+	65536, 65536, 65536, 65536, 65536, 65536, 65536, 64039,
+	64039, 64039, 64039, 62576, 62576, 62576, 62576, 61147,
+	61147, 61147, 61147, 59750, 59750, 59750, 59750, 58385,
+	58385, 58385, 58385, 57052, 57052, 57052, 57052, 57052,
+	58385, 58385, 58385, 58385, 59750, 59750, 59750, 59750,
+	61147, 61147,
+};
+
+static const Bit8u kslev[8][16] = {
+	{ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 },
+	{ 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 3, 4, 5, 6, 7, 8 },
+	{ 0, 0, 0, 0, 0, 3, 5, 7, 8, 10, 11, 12, 13, 14, 15, 16 },
+	{ 0, 0, 0, 5, 8, 11, 13, 15, 16, 18, 19, 20, 21, 22, 23, 24 },
+	{ 0, 0, 8, 13, 16, 19, 21, 23, 24, 26, 27, 28, 29, 30, 31, 32 },
+	{ 0, 8, 16, 21, 24, 27, 29, 31, 32, 34, 35, 36, 37, 38, 39, 40 },
+	{ 0, 16, 24, 29, 32, 35, 37, 39, 40, 42, 43, 44, 45, 46, 47, 48 },
+	{ 0, 24, 32, 37, 40, 43, 45, 47, 48, 50, 51, 52, 53, 54, 55, 56 },
+};
+
+static const Bit32s sustain_levels[16] = {
+	1073741824, 759250125, 536870912, 379625062, 268435456, 189812531, 134217728, 94906266,
+	67108864, 47453133, 33554432, 23726566, 16777216, 11863283, 8388608, 0,
+};
+
+static const Bit32s vol_mantissa[32] = {
+	1073741824, 1050733751, 1028218693, 1006186087, 984625594, 963527098, 942880699, 922676710,
+	902905651, 883558244, 864625413, 846098274, 827968132, 810226483, 792865000, 775875538,
+	759250125, 742980960, 727060411, 711481005, 696235434, 681316545, 666717336, 652430958,
+	638450708, 624770026, 611382493, 598281827, 585461881, 572916640, 560640218, 548626854,
+};
+
+#endif /* OPL_TABLES_H */
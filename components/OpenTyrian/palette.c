@@ -24,7 +24,7 @@
 
 #include <assert.h>
 
-static Uint32 rgb_to_yuv( int r, int g, int b );
+static void update_palette_lut( unsigned int first_color, unsigned int last_color );
 
 #ifdef TYRIAN2000
 #define PALETTE_COUNT 24
@@ -40,6 +40,9 @@ SDL_Palette *palette;
 
 EXT_RAM_BSS_ATTR Uint32 rgb_palette[256], yuv_palette[256];
 
+// looked up for every pixel presented, so keep it in internal RAM
+DRAM_ATTR Uint16 rgb565_palette[256];
+
 EXT_RAM_BSS_ATTR Palette colors;
 
 void JE_loadPals( void )
@@ -78,6 +81,7 @@ void set_palette(Palette colors, unsigned int first_color, unsigned int last_col
 
     // Update the colors in the palette
     SDL_SetPaletteColors(palette, colors, first_color, last_color - first_color + 1);
+    update_palette_lut(first_color, last_color);
 
     // Make sure to apply the palette to all relevant surfaces
     SDL_SetSurfacePalette(VGAScreen, palette);
@@ -92,6 +96,7 @@ void set_colors(SDL_Color color, unsigned int first_color, unsigned int last_col
 
     // Update the colors in the palette
     SDL_SetPaletteColors(palette, &palette->colors[first_color], first_color, last_color - first_color + 1);
+    update_palette_lut(first_color, last_color);
 }
 
 
@@ -129,6 +134,7 @@ void step_fade_palette(int diff[256][3], int steps, unsigned int first_color, un
     }
 
     SDL_SetPaletteColors(palette, &palette->colors[first_color], first_color, last_color - first_color + 1);
+    update_palette_lut(first_color, last_color);
 }
 
 
@@ -183,7 +189,21 @@ void fade_white( int steps )
 	fade_solid(white, steps, 0, 255);
 }
 
-static Uint32 rgb_to_yuv( int r, int g, int b )
+// Rebuilds the lookup tables used to expand indexed pixels for the display.
+// Only palette changes touch these, so presenting a frame is a plain lookup.
+static void update_palette_lut( unsigned int first_color, unsigned int last_color )
+{
+	for (unsigned int i = first_color; i <= last_color; ++i)
+	{
+		const SDL_Color c = palette->colors[i];
+
+		rgb565_palette[i] = ((c.r & 0xf8) << 8) | ((c.g & 0xfc) << 3) | (c.b >> 3);
+		rgb_palette[i] = (c.r << 16) | (c.g << 8) | c.b;
+		yuv_palette[i] = rgb_to_yuv(c.r, c.g, c.b);
+	}
+}
+
+Uint32 rgb_to_yuv( int r, int g, int b )
 {
 	int y = (r + g + b) >> 2,
 	    u = 128 + ((r - b) >> 2),
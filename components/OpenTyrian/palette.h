@@ -29,6 +29,7 @@ EXT_RAM_BSS_ATTR extern Palette palettes[];
 extern int palette_count;
 
 EXT_RAM_BSS_ATTR extern Uint32 rgb_palette[256], yuv_palette[256];
+extern Uint16 rgb565_palette[256];
 
 EXT_RAM_BSS_ATTR extern Palette colors; // TODO: get rid of this
 extern SDL_Palette *palette;
@@ -48,5 +49,7 @@ void fade_solid( SDL_Color color, int steps, unsigned int first_color, unsigned
 void fade_black( int steps );
 void fade_white( int steps );
 
+Uint32 rgb_to_yuv( int r, int g, int b );
+
 #endif /* PALETTE_H */
 
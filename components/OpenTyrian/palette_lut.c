@@ -0,0 +1,98 @@
+/*
+ * OpenTyrian: A modern cross-platform port of Tyrian
+ * Copyright (C) 2007-2009  The OpenTyrian Development Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+#include "palette_lut.h"
+
+// the blitters read these for every pixel, keep them out of PSRAM
+DRAM_ATTR Uint8 palette_lut_halve[256];
+DRAM_ATTR Uint8 palette_lut_light[PALETTE_LUT_LIGHT_EDGE + 1][256];
+
+#define LUT_SLOTS 8
+
+typedef struct
+{
+	Uint16 key;        // 0x100 | delta, 0 while unused
+	Uint16 last_used;
+	Uint8 table[256];
+} LutSlot;
+
+DRAM_ATTR static LutSlot lut_slots[LUT_SLOTS];
+static Uint16 lut_clock;
+
+void init_palette_luts( void )
+{
+	for (unsigned int i = 0; i < 256; ++i)
+	{
+		const unsigned int hue = i & 0xf0, value = i & 0x0f;
+
+		palette_lut_halve[i] = hue | (value / 2);
+
+		for (unsigned int d = 0; d <= PALETTE_LUT_LIGHT_EDGE; ++d)
+			palette_lut_light[d][i] = hue | ((value + 3 * (PALETTE_LUT_LIGHT_EDGE - d)) / 4);
+	}
+
+	for (unsigned int i = 0; i < LUT_SLOTS; ++i)
+		lut_slots[i].key = 0;
+}
+
+static Uint8 *get_lut_slot( Uint8 parameter, bool *fresh )
+{
+	const Uint16 key = 0x100 | parameter;
+
+	LutSlot *victim = &lut_slots[0];
+	for (unsigned int i = 0; i < LUT_SLOTS; ++i)
+	{
+		LutSlot *slot = &lut_slots[i];
+		if (slot->key == key)
+		{
+			slot->last_used = ++lut_clock;
+			*fresh = false;
+			return slot->table;
+		}
+		if ((Uint16)(lut_clock - slot->last_used) > (Uint16)(lut_clock - victim->last_used))
+			victim = slot;
+	}
+
+	victim->key = key;
+	victim->last_used = ++lut_clock;
+	*fresh = true;
+	return victim->table;
+}
+
+const Uint8 *palette_lut_brightness( int delta )
+{
+	// every delta outside this range maps the whole palette the same way
+	if (delta < -16)
+		delta = -16;
+	else if (delta > 31)
+		delta = 31;
+
+	bool fresh;
+	Uint8 *table = get_lut_slot((Uint8)delta, &fresh);
+
+	if (fresh)
+	{
+		for (unsigned int i = 0; i < 256; ++i)
+		{
+			const int temp = (int)(i & 0x0f) + delta;
+			table[i] = (i & 0xf0) | (temp < 0 || temp >= 0x1f ? 0 : (temp >= 0x0f ? 0x0f : temp));
+		}
+	}
+
+	return table;
+}
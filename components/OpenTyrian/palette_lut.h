@@ -0,0 +1,50 @@
+/*
+ * OpenTyrian: A modern cross-platform port of Tyrian
+ * Copyright (C) 2007-2009  The OpenTyrian Development Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+#ifndef PALETTE_LUT_H
+#define PALETTE_LUT_H
+
+#include "opentyr.h"
+
+#include "SDL3/SDL.h"
+
+// Palette indices are a hue in the high nibble and a brightness in the low
+// nibble, so the shading effects are all functions of the index alone.  These
+// tables hold those functions; every effect is then one lookup per pixel.
+
+// hue kept, brightness halved (shadows, dark text)
+extern Uint8 palette_lut_halve[256];
+
+// star field lighting: entry d is the brightness at d pixels past the edge
+// of the lit cone; the last entry is the fully shadowed quarter brightness
+#define PALETTE_LUT_LIGHT_EDGE 5
+extern Uint8 palette_lut_light[PALETTE_LUT_LIGHT_EDGE + 1][256];
+
+void init_palette_luts( void );
+
+// brightness + delta, saturating to 15 and wrapping to black past 30 or
+// below 0, as JE_filterScreen has always done.  Built on first use and kept
+// in a handful of slots, since only a few deltas are live at once.
+//
+// The hue filters (bits | (index & 0x0f)) have no table: a mask and an or
+// are cheaper than the load, and enemy filters would keep evicting slots.
+// Neither has JE_darkenBackground, whose 4 KiB table indexed by the dither
+// term tools/palette/palette_lut_bench.c timed slower than the arithmetic.
+const Uint8 *palette_lut_brightness( int delta );
+
+#endif /* PALETTE_LUT_H */
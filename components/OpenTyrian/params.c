@@ -33,6 +33,7 @@
 #include <string.h>
 
 JE_boolean richMode = false, constantPlay = false, constantDie = false;
+JE_boolean benchDemos = false;
 
 /* YKS: Note: LOOT cheat had non letters removed. */
 const char pars[][9] = {
@@ -62,6 +63,7 @@ void JE_paramCheck( int argc, char *argv[] )
 		{ 'k', 'k', "death",             false },
 		{ 'r', 'r', "record",            false },
 		{ 'l', 'l', "loot",              false },
+		{ 258, 0,   "bench-demos",       false },
 		
 		{ 0, 0, NULL, false}
 	};
@@ -99,7 +101,9 @@ void JE_paramCheck( int argc, char *argv[] )
 			       "  --net-player-number=NUMBER   Sets local player number in a networked game\n"
 			       "                               (1 or 2)\n"
 			       "  -p, --net-port=PORT          Local port to bind (default is 1333)\n"
-			       "  -d, --net-delay=FRAMES       Set lag-compensation delay (default is 1)\n", argv[0]);
+			       "  -d, --net-delay=FRAMES       Set lag-compensation delay (default is 1)\n\n"
+			       "  --bench-demos                Play demo.1 to demo.5 unthrottled, report the\n"
+			       "                               simulation rate and quit\n", argv[0]);
 			exit(0);
 			break;
 		}
@@ -220,6 +224,10 @@ void JE_paramCheck( int argc, char *argv[] )
 			richMode = true;
 			break;
 			
+		case 258: // --bench-demos
+			benchDemos = true;
+			break;
+			
 		default:
 			assert(false);
 			break;
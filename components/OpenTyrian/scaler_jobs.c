@@ -0,0 +1,171 @@
+/*
+ * OpenTyrian: A modern cross-platform port of Tyrian
+ * Copyright (C) 2007-2009  The OpenTyrian Development Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+#include "scaler_jobs.h"
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+// the hqNx kernels keep 2 KiB of palette tables on the stack
+#define SCALER_WORKER_STACK 6144
+#define SCALER_WORKER_PRIORITY 5
+
+// splitting a handful of rows costs more in task switches than it saves
+#define SCALER_SPLIT_MIN_ROWS 16
+
+typedef struct
+{
+	TaskHandle_t task;
+	SemaphoreHandle_t done;
+
+	Uint8 *dst;
+	int first_row, last_row;
+}
+ScalerBand;
+
+// what every band of the current job shares
+static struct
+{
+	ExpandScalerFunction scaler;
+	int dst_pitch;
+	const Uint8 *src;
+	int src_pitch;
+	const Uint16 *palette;
+}
+job;
+
+static ScalerBand bands[SCALER_BANDS];
+static unsigned int worker_count = 0;
+static atomic_bool workers_quit = false;
+
+static atomic_uint band_time_us[SCALER_BANDS];
+
+static void run_band( unsigned int i )
+{
+	const ScalerBand *band = &bands[i];
+
+	const Uint64 start = SDL_GetTicksNS();
+	job.scaler(band->dst, job.dst_pitch, job.src, job.src_pitch, job.palette, band->first_row, band->last_row);
+	atomic_fetch_add(&band_time_us[i], (unsigned int)((SDL_GetTicksNS() - start) / 1000));
+}
+
+static void scaler_worker_main( void *arg )
+{
+	const unsigned int i = (unsigned int)(uintptr_t)arg;
+
+	while (true)
+	{
+		ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+		if (atomic_load(&workers_quit))
+			break;
+
+		run_band(i);
+		xSemaphoreGive(bands[i].done);
+	}
+
+	xSemaphoreGive(bands[i].done);
+	vTaskDelete(NULL);
+}
+
+void init_scaler_jobs( BaseType_t caller_core, BaseType_t game_core )
+{
+	atomic_store(&workers_quit, false);
+
+	worker_count = 0;
+	for (BaseType_t core = 0; core < portNUM_PROCESSORS && worker_count < SCALER_BANDS - 1; ++core)
+	{
+		if (core == caller_core || core == game_core)
+			continue;
+
+		ScalerBand *band = &bands[worker_count];
+		band->done = xSemaphoreCreateBinary();
+		if (band->done == NULL ||
+		    xTaskCreatePinnedToCore(scaler_worker_main, "scaler", SCALER_WORKER_STACK, (void *)(uintptr_t)worker_count, SCALER_WORKER_PRIORITY, &band->task, core) != pdPASS)
+		{
+			printf("Failed to create scaler worker on core %d, scaling on fewer cores\n", (int)core);
+			if (band->done != NULL)
+				vSemaphoreDelete(band->done);
+			band->done = NULL;
+			break;
+		}
+		++worker_count;
+	}
+}
+
+void deinit_scaler_jobs( void )
+{
+	atomic_store(&workers_quit, true);
+
+	for (unsigned int i = 0; i < worker_count; ++i)
+	{
+		xTaskNotifyGive(bands[i].task);
+		xSemaphoreTake(bands[i].done, portMAX_DELAY);
+		vSemaphoreDelete(bands[i].done);
+		bands[i].task = NULL;
+		bands[i].done = NULL;
+	}
+	worker_count = 0;
+}
+
+void run_scaler_bands( ExpandScalerFunction scaler, Uint8 *dst, int dst_pitch, int scale_y, const Uint8 *src, int src_pitch, const Uint16 *palette, int first_row, int last_row )
+{
+	const int rows = last_row - first_row + 1;
+
+	job.scaler = scaler;
+	job.dst_pitch = dst_pitch;
+	job.src = src;
+	job.src_pitch = src_pitch;
+	job.palette = palette;
+
+	const unsigned int band_count = rows >= SCALER_SPLIT_MIN_ROWS ? worker_count + 1 : 1;
+	const unsigned int caller_band = SCALER_BANDS - 1;
+
+	// The bands only write their own output rows.  Scalers that look at the
+	// rows above and below read them straight from the shared source frame,
+	// so the one row of overlap needs no copying.
+	int row = first_row;
+	for (unsigned int b = 0; b < band_count; ++b)
+	{
+		const unsigned int i = (b == band_count - 1) ? caller_band : b;
+		const int band_rows = rows / band_count + (b < rows % band_count ? 1 : 0);
+
+		bands[i].dst = dst + (row - first_row) * scale_y * dst_pitch;
+		bands[i].first_row = row;
+		bands[i].last_row = row + band_rows - 1;
+		row += band_rows;
+
+		if (i != caller_band)
+			xTaskNotifyGive(bands[i].task);
+	}
+
+	run_band(caller_band);
+
+	for (unsigned int b = 0; b + 1 < band_count; ++b)
+		xSemaphoreTake(bands[b].done, portMAX_DELAY);
+}
+
+void get_scaler_band_stats( Uint32 band_us[SCALER_BANDS] )
+{
+	for (unsigned int i = 0; i < SCALER_BANDS; ++i)
+		band_us[i] = atomic_load(&band_time_us[i]);
+}
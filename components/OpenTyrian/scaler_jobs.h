@@ -0,0 +1,45 @@
+/*
+ * OpenTyrian: A modern cross-platform port of Tyrian
+ * Copyright (C) 2007-2009  The OpenTyrian Development Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+#ifndef SCALER_JOBS_H
+#define SCALER_JOBS_H
+
+#include "opentyr.h"
+#include "video_scale.h"
+
+#include "freertos/FreeRTOS.h"
+
+// one band per core; the calling task works on the last one itself
+#define SCALER_BANDS portNUM_PROCESSORS
+
+// Starts a worker pinned to every core except caller_core, which is the core
+// run_scaler_bands() will be called from, and game_core, which the game
+// thread runs on: a band scaled there would be time taken from the next
+// frame.  With two cores that leaves none, and the caller scales alone.
+void init_scaler_jobs( BaseType_t caller_core, BaseType_t game_core );
+void deinit_scaler_jobs( void );
+
+// Runs scaler over rows first_row..last_row of the source, split into
+// horizontal bands that are expanded in parallel.  dst points at the output
+// of first_row and every source row produces scale_y output rows.
+void run_scaler_bands( ExpandScalerFunction scaler, Uint8 *dst, int dst_pitch, int scale_y, const Uint8 *src, int src_pitch, const Uint16 *palette, int first_row, int last_row );
+
+// Cumulative time spent in each band, in microseconds, for load balancing.
+void get_scaler_band_stats( Uint32 band_us[SCALER_BANDS] );
+
+#endif /* SCALER_JOBS_H */
@@ -471,15 +471,15 @@ JE_integer player_shot_create( JE_word portNum, uint bay_i, JE_word PX, JE_word
 			uint best_dist = 65000;
 			JE_byte closest_enemy = 0;
 			/*Find Closest Enemy*/
-			for (x = 0; x < 100; x++)
+			for (int e = enemy_live_next(0, 100); e >= 0; e = enemy_live_next(e + 1, 100))
 			{
-				if (enemyAvail[x] != 1 && !enemy[x].scoreitem)
+				if (enemyAvail[e] != 1 && !enemy[e].scoreitem)
 				{
-					y = abs(enemy[x].ex - shot->shotX) + abs(enemy[x].ey - shot->shotY);
+					y = abs(enemy[e].ex - shot->shotX) + abs(enemy[e].ey - shot->shotY);
 					if (y < best_dist)
 					{
 						best_dist = y;
-						closest_enemy = x + 1;
+						closest_enemy = e + 1;
 					}
 				}
 			}
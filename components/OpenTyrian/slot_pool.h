@@ -0,0 +1,126 @@
+/*
+ * OpenTyrian: A modern cross-platform port of Tyrian
+ * Copyright (C) 2007-2009  The OpenTyrian Development Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+#ifndef SLOT_POOL_H
+#define SLOT_POOL_H
+
+#include "opentyr.h"
+
+#include <stdbool.h>
+
+// Occupancy of a fixed array of slots, one bit per slot, so that finding a
+// free slot or the next used one is a few word tests instead of a pass over
+// the array (which for the effect pools lives in PSRAM).  Allocation always
+// takes the lowest free slot and iteration runs in slot order, exactly like
+// the linear scans these replace, so the order entries are updated and
+// drawn in, and the random numbers they draw, are unchanged.
+
+#define SLOT_POOL_MAX 224
+
+typedef struct {
+	unsigned int size;
+	unsigned int count;       // slots in use
+	unsigned int high_water;  // most slots ever in use at once, for tuning the pool size
+	Uint32 used[(SLOT_POOL_MAX + 31) / 32];
+} slot_pool_type;
+
+// Frees every slot; keeps the high-water mark.
+static inline void slot_pool_reset( slot_pool_type *pool, unsigned int size )
+{
+	pool->size = size;
+	pool->count = 0;
+	for (unsigned int w = 0; w < COUNTOF(pool->used); w++)
+		pool->used[w] = 0;
+}
+
+static inline bool slot_pool_used( const slot_pool_type *pool, unsigned int i )
+{
+	return pool->used[i / 32] & (1u << (i % 32));
+}
+
+static inline void slot_pool_take( slot_pool_type *pool, unsigned int i )
+{
+	if (!slot_pool_used(pool, i))
+	{
+		pool->used[i / 32] |= 1u << (i % 32);
+		if (++pool->count > pool->high_water)
+			pool->high_water = pool->count;
+	}
+}
+
+static inline void slot_pool_free( slot_pool_type *pool, unsigned int i )
+{
+	if (slot_pool_used(pool, i))
+	{
+		pool->used[i / 32] &= ~(1u << (i % 32));
+		pool->count--;
+	}
+}
+
+// Marks the lowest free slot used and returns it, or -1 if the pool is full.
+static inline int slot_pool_alloc( slot_pool_type *pool )
+{
+	for (unsigned int w = 0; w * 32 < pool->size; w++)
+	{
+		if (pool->used[w] != ~0u)
+		{
+			const unsigned int i = w * 32 + __builtin_ctz(~pool->used[w]);
+			if (i >= pool->size)
+				break;
+			slot_pool_take(pool, i);
+			return i;
+		}
+	}
+	return -1;
+}
+
+// Returns the first used slot at or after i, or -1.  Reads the bits afresh
+// each call, so a slot taken mid-iteration ahead of i is still visited.
+static inline int slot_pool_next( const slot_pool_type *pool, int i )
+{
+	while (i < (int)pool->size)
+	{
+		const Uint32 word = pool->used[i / 32] >> (i % 32);
+		if (word == 0)
+		{
+			i = (i / 32 + 1) * 32;
+			continue;
+		}
+		i += __builtin_ctz(word);
+		return (i < (int)pool->size) ? i : -1;
+	}
+	return -1;
+}
+
+// Returns the last used slot at or before i, or -1.
+static inline int slot_pool_prev( const slot_pool_type *pool, int i )
+{
+	while (i >= 0)
+	{
+		const Uint32 word = pool->used[i / 32] << (31 - i % 32);
+		if (word == 0)
+		{
+			i = (i / 32) * 32 - 1;
+			continue;
+		}
+		return i - __builtin_clz(word);
+	}
+	return -1;
+}
+
+#endif /* SLOT_POOL_H */
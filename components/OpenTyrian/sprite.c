@@ -18,6 +18,7 @@
  */
 #include "file.h"
 #include "opentyr.h"
+#include "palette_lut.h"
 #include "sprite.h"
 #include "video.h"
 
@@ -30,6 +31,11 @@ EXT_RAM_BSS_ATTR Sprite_array sprite_table[SPRITE_TABLES_MAX];
 Sprite2_array eShapes[6];
 Sprite2_array shapesC1, shapes6, shapes9, shapesW2;
 
+#if SPRITE_SPANS
+static void compile_sprite_spans( Sprite *cur_sprite );
+static void compile_sprite2_spans( Sprite2_array *sprite2s );
+#endif
+
 void load_sprites_file( unsigned int table, const char *filename )
 {
 	printf("Loading Sprites: %s\n", filename);
@@ -75,10 +81,152 @@ void load_sprites( unsigned int table, FILE *f )
 
 
 		efread(cur_sprite->data, sizeof(Uint8), cur_sprite->size, f);
+
+#if SPRITE_SPANS
+		compile_sprite_spans(cur_sprite);
+#endif
 	}
     printf("Loading Sprites - Table: %d - Done\n", table);
 }
 
+#if SPRITE_SPANS
+// Walks the RLE opcodes the same way the decoding blitters do and records
+// each run of opaque pixels within a row.  Returns the number of spans; they
+// are only stored if spans is not NULL.
+static unsigned int build_sprite_spans( const Sprite *cur_sprite, SpriteSpan *spans )
+{
+	const Uint8 *data = cur_sprite->data;
+	const Uint8 * const data_ul = data + cur_sprite->size;
+
+	const unsigned int width = cur_sprite->width;
+	unsigned int x_offset = 0, y_offset = 0;
+
+	unsigned int count = 0;
+	SpriteSpan run = { 0, 0, 0, 0 };
+
+	for (; data < data_ul; ++data)
+	{
+		switch (*data)
+		{
+		case 255:  // transparent pixels
+			data++;  // next byte tells how many
+			x_offset += *data;
+			break;
+
+		case 254:  // next pixel row
+			x_offset = width;
+			break;
+
+		case 253:  // 1 transparent pixel
+			x_offset++;
+			break;
+
+		default:  // a pixel
+		{
+			const unsigned int offset = data - cur_sprite->data;
+
+			if (run.length > 0 && run.y == y_offset &&
+			    run.x + run.length == x_offset && run.offset + run.length == offset)
+			{
+				run.length++;
+			}
+			else
+			{
+				if (run.length > 0 && spans != NULL)
+					spans[count - 1] = run;
+
+				run.x = x_offset;
+				run.y = y_offset;
+				run.length = 1;
+				run.offset = offset;
+				count++;
+			}
+
+			x_offset++;
+			break;
+		}
+		}
+		if (x_offset >= width)
+		{
+			x_offset = 0;
+			y_offset++;
+		}
+	}
+
+	if (run.length > 0 && spans != NULL)
+		spans[count - 1] = run;
+
+	return count;
+}
+
+static void compile_sprite_spans( Sprite *cur_sprite )
+{
+	cur_sprite->span_count = 0;
+	cur_sprite->spans = NULL;
+
+	if (cur_sprite->width == 0)
+		return;
+
+	const unsigned int count = build_sprite_spans(cur_sprite, NULL);
+	if (count == 0)
+		return;
+
+	cur_sprite->spans = (SpriteSpan *)heap_caps_malloc(count * sizeof(SpriteSpan), MALLOC_CAP_8BIT);
+	if (cur_sprite->spans == NULL)
+		return;  // fall back to decoding
+
+	build_sprite_spans(cur_sprite, cur_sprite->spans);
+	cur_sprite->span_count = count;
+}
+
+// Clips a span at (*x, y) to clip.  Returns false once spans
+// start below it; length is 0 if no part of the span is visible.
+static inline bool clip_sprite_span( const SDL_Rect *clip, int *x, int y, const Uint8 **data, unsigned int *length )
+{
+	if (y >= clip->y + clip->h)
+		return false;
+	if (y < clip->y)
+	{
+		*length = 0;
+		return true;
+	}
+
+	const int left = MAX(*x, clip->x),
+	          right = MIN(*x + (int)*length, clip->x + clip->w);
+	if (left >= right)
+	{
+		*length = 0;
+		return true;
+	}
+
+	*data += left - *x;
+	*x = left;
+	*length = right - left;
+
+	return true;
+}
+#endif
+
+// the clip rectangle of the surface blitted to last
+static SDL_Surface *blit_clip_surface = NULL;
+static SDL_Rect blit_clip;
+
+void set_blit_clip( SDL_Surface *surface, const SDL_Rect *clip )
+{
+	SDL_SetSurfaceClipRect(surface, clip);
+	blit_clip_surface = NULL;
+}
+
+const SDL_Rect *get_blit_clip( SDL_Surface *surface )
+{
+	if (surface != blit_clip_surface)
+	{
+		SDL_GetSurfaceClipRect(surface, &blit_clip);
+		blit_clip_surface = surface;
+	}
+	return &blit_clip;
+}
+
 void free_sprites( unsigned int table )
 {
 	printf("sprite_table: %d count: %d\n", table, sprite_table[table].count);
@@ -90,6 +238,10 @@ void free_sprites( unsigned int table )
 		cur_sprite->height = 0;
 		cur_sprite->size   = 0;
 
+		free(cur_sprite->spans);
+		cur_sprite->span_count = 0;
+		cur_sprite->spans = NULL;
+
 		//if(cur_sprite->data != NULL)
 		//	free(cur_sprite->data);
 		cur_sprite->data = NULL;
@@ -98,7 +250,6 @@ void free_sprites( unsigned int table )
 	sprite_table[table].count = 0;
 }
 
-// does not clip on left or right edges of surface
 void IRAM_ATTR blit_sprite( SDL_Surface *surface, int x, int y, unsigned int table, unsigned int index )
 {
 	if (index >= sprite_table[table].count || !sprite_exists(table, index))
@@ -109,6 +260,31 @@ void IRAM_ATTR blit_sprite( SDL_Surface *surface, int x, int y, unsigned int tab
 
 	const Sprite * const cur_sprite = sprite(table, index);
 
+	const SDL_Rect clip = *get_blit_clip(surface);
+
+#if SPRITE_SPANS
+	if (cur_sprite->spans != NULL)
+	{
+		for (unsigned int i = 0; i < cur_sprite->span_count; ++i)
+		{
+			const SpriteSpan * const span = &cur_sprite->spans[i];
+
+			int span_x = x + span->x;
+			const int span_y = y + span->y;
+			const Uint8 *data = cur_sprite->data + span->offset;
+			unsigned int length = span->length;
+
+			if (!clip_sprite_span(&clip, &span_x, span_y, &data, &length))
+				return;
+
+			Uint8 *pixels = (Uint8 *)surface->pixels + (span_y * surface->pitch) + span_x;
+
+			memcpy(pixels, data, length);
+		}
+		return;
+	}
+#endif
+
 	const Uint8 *data = cur_sprite->data;
 	const Uint8 * const data_ul = data + cur_sprite->size;
 
@@ -117,8 +293,8 @@ void IRAM_ATTR blit_sprite( SDL_Surface *surface, int x, int y, unsigned int tab
 
 	// assert(surface->format->BitsPerPixel == 8);
 	Uint8 *             pixels =    (Uint8 *)surface->pixels + (y * surface->pitch) + x;
-	const Uint8 * const pixels_ll = (Uint8 *)surface->pixels,  // lower limit
-	            * const pixels_ul = (Uint8 *)surface->pixels + (surface->h * surface->pitch);  // upper limit
+	const Uint8 * const pixels_ll = (Uint8 *)surface->pixels + (clip.y * surface->pitch),  // lower limit
+	            * const pixels_ul = (Uint8 *)surface->pixels + ((clip.y + clip.h) * surface->pitch);  // upper limit
 
 	for (; data < data_ul; ++data)
 	{
@@ -143,7 +319,7 @@ void IRAM_ATTR blit_sprite( SDL_Surface *surface, int x, int y, unsigned int tab
 		default:  // set a pixel
 			if (pixels >= pixels_ul)
 				return;
-			if (pixels >= pixels_ll)
+			if (pixels >= pixels_ll && x + (int)x_offset >= clip.x && x + (int)x_offset < clip.x + clip.w)
 				*pixels = *data;
 
 			pixels++;
@@ -158,7 +334,6 @@ void IRAM_ATTR blit_sprite( SDL_Surface *surface, int x, int y, unsigned int tab
 	}
 }
 
-// does not clip on left or right edges of surface
 void IRAM_ATTR blit_sprite_blend( SDL_Surface *surface, int x, int y, unsigned int table, unsigned int index )
 {
 	if (index >= sprite_table[table].count || !sprite_exists(table, index))
@@ -169,6 +344,32 @@ void IRAM_ATTR blit_sprite_blend( SDL_Surface *surface, int x, int y, unsigned i
 
 	const Sprite * const cur_sprite = sprite(table, index);
 
+	const SDL_Rect clip = *get_blit_clip(surface);
+
+#if SPRITE_SPANS
+	if (cur_sprite->spans != NULL)
+	{
+		for (unsigned int i = 0; i < cur_sprite->span_count; ++i)
+		{
+			const SpriteSpan * const span = &cur_sprite->spans[i];
+
+			int span_x = x + span->x;
+			const int span_y = y + span->y;
+			const Uint8 *data = cur_sprite->data + span->offset;
+			unsigned int length = span->length;
+
+			if (!clip_sprite_span(&clip, &span_x, span_y, &data, &length))
+				return;
+
+			Uint8 *pixels = (Uint8 *)surface->pixels + (span_y * surface->pitch) + span_x;
+
+			for (; length > 0; --length, ++pixels, ++data)
+				*pixels = (*data & 0xf0) | (((*pixels & 0x0f) + (*data & 0x0f)) / 2);
+		}
+		return;
+	}
+#endif
+
 	const Uint8 *data = cur_sprite->data;
 	const Uint8 * const data_ul = data + cur_sprite->size;
 
@@ -177,8 +378,8 @@ void IRAM_ATTR blit_sprite_blend( SDL_Surface *surface, int x, int y, unsigned i
 
 	// assert(surface->BitsPerPixel == 8);
 	Uint8 *             pixels =    (Uint8 *)surface->pixels + (y * surface->pitch) + x;
-	const Uint8 * const pixels_ll = (Uint8 *)surface->pixels,  // lower limit
-	            * const pixels_ul = (Uint8 *)surface->pixels + (surface->h * surface->pitch);  // upper limit
+	const Uint8 * const pixels_ll = (Uint8 *)surface->pixels + (clip.y * surface->pitch),  // lower limit
+	            * const pixels_ul = (Uint8 *)surface->pixels + ((clip.y + clip.h) * surface->pitch);  // upper limit
 
 	for (; data < data_ul; ++data)
 	{
@@ -203,7 +404,7 @@ void IRAM_ATTR blit_sprite_blend( SDL_Surface *surface, int x, int y, unsigned i
 		default:  // set a pixel
 			if (pixels >= pixels_ul)
 				return;
-			if (pixels >= pixels_ll)
+			if (pixels >= pixels_ll && x + (int)x_offset >= clip.x && x + (int)x_offset < clip.x + clip.w)
 				*pixels = (*data & 0xf0) | (((*pixels & 0x0f) + (*data & 0x0f)) / 2);
 
 			pixels++;
@@ -218,7 +419,6 @@ void IRAM_ATTR blit_sprite_blend( SDL_Surface *surface, int x, int y, unsigned i
 	}
 }
 
-// does not clip on left or right edges of surface
 // unsafe because it doesn't check that value won't overflow into hue
 // we can replace it when we know that we don't rely on that 'feature'
 void IRAM_ATTR blit_sprite_hv_unsafe( SDL_Surface *surface, int x, int y, unsigned int table, unsigned int index, Uint8 hue, Sint8 value )
@@ -233,6 +433,32 @@ void IRAM_ATTR blit_sprite_hv_unsafe( SDL_Surface *surface, int x, int y, unsign
 
 	const Sprite * const cur_sprite = sprite(table, index);
 
+	const SDL_Rect clip = *get_blit_clip(surface);
+
+#if SPRITE_SPANS
+	if (cur_sprite->spans != NULL)
+	{
+		for (unsigned int i = 0; i < cur_sprite->span_count; ++i)
+		{
+			const SpriteSpan * const span = &cur_sprite->spans[i];
+
+			int span_x = x + span->x;
+			const int span_y = y + span->y;
+			const Uint8 *data = cur_sprite->data + span->offset;
+			unsigned int length = span->length;
+
+			if (!clip_sprite_span(&clip, &span_x, span_y, &data, &length))
+				return;
+
+			Uint8 *pixels = (Uint8 *)surface->pixels + (span_y * surface->pitch) + span_x;
+
+			for (; length > 0; --length, ++pixels, ++data)
+				*pixels = hue | ((*data & 0x0f) + value);
+		}
+		return;
+	}
+#endif
+
 	const Uint8 *data = cur_sprite->data;
 	const Uint8 * const data_ul = data + cur_sprite->size;
 
@@ -241,8 +467,8 @@ void IRAM_ATTR blit_sprite_hv_unsafe( SDL_Surface *surface, int x, int y, unsign
 
 	// assert(surface->BitsPerPixel == 8);
 	Uint8 *             pixels =    (Uint8 *)surface->pixels + (y * surface->pitch) + x;
-	const Uint8 * const pixels_ll = (Uint8 *)surface->pixels,  // lower limit
-	            * const pixels_ul = (Uint8 *)surface->pixels + (surface->h * surface->pitch);  // upper limit
+	const Uint8 * const pixels_ll = (Uint8 *)surface->pixels + (clip.y * surface->pitch),  // lower limit
+	            * const pixels_ul = (Uint8 *)surface->pixels + ((clip.y + clip.h) * surface->pitch);  // upper limit
 
 	for (; data < data_ul; ++data)
 	{
@@ -267,7 +493,7 @@ void IRAM_ATTR blit_sprite_hv_unsafe( SDL_Surface *surface, int x, int y, unsign
 		default:  // set a pixel
 			if (pixels >= pixels_ul)
 				return;
-			if (pixels >= pixels_ll)
+			if (pixels >= pixels_ll && x + (int)x_offset >= clip.x && x + (int)x_offset < clip.x + clip.w)
 				*pixels = hue | ((*data & 0x0f) + value);
 
 			pixels++;
@@ -282,7 +508,6 @@ void IRAM_ATTR blit_sprite_hv_unsafe( SDL_Surface *surface, int x, int y, unsign
 	}
 }
 
-// does not clip on left or right edges of surface
 void IRAM_ATTR blit_sprite_hv( SDL_Surface *surface, int x, int y, unsigned int table, unsigned int index, Uint8 hue, Sint8 value )
 {
 	if (index >= sprite_table[table].count || !sprite_exists(table, index))
@@ -295,6 +520,38 @@ void IRAM_ATTR blit_sprite_hv( SDL_Surface *surface, int x, int y, unsigned int
 
 	const Sprite * const cur_sprite = sprite(table, index);
 
+	const SDL_Rect clip = *get_blit_clip(surface);
+
+#if SPRITE_SPANS
+	if (cur_sprite->spans != NULL)
+	{
+		for (unsigned int i = 0; i < cur_sprite->span_count; ++i)
+		{
+			const SpriteSpan * const span = &cur_sprite->spans[i];
+
+			int span_x = x + span->x;
+			const int span_y = y + span->y;
+			const Uint8 *data = cur_sprite->data + span->offset;
+			unsigned int length = span->length;
+
+			if (!clip_sprite_span(&clip, &span_x, span_y, &data, &length))
+				return;
+
+			Uint8 *pixels = (Uint8 *)surface->pixels + (span_y * surface->pitch) + span_x;
+
+			for (; length > 0; --length, ++pixels, ++data)
+			{
+				Uint8 temp_value = (*data & 0x0f) + value;
+				if (temp_value > 0xf)
+					temp_value = (temp_value >= 0x1f) ? 0x0 : 0xf;
+
+				*pixels = hue | temp_value;
+			}
+		}
+		return;
+	}
+#endif
+
 	const Uint8 *data = cur_sprite->data;
 	const Uint8 * const data_ul = data + cur_sprite->size;
 
@@ -303,8 +560,8 @@ void IRAM_ATTR blit_sprite_hv( SDL_Surface *surface, int x, int y, unsigned int
 
 	// assert(surface->BitsPerPixel == 8);
 	Uint8 *             pixels =    (Uint8 *)surface->pixels + (y * surface->pitch) + x;
-	const Uint8 * const pixels_ll = (Uint8 *)surface->pixels,  // lower limit
-	            * const pixels_ul = (Uint8 *)surface->pixels + (surface->h * surface->pitch);  // upper limit
+	const Uint8 * const pixels_ll = (Uint8 *)surface->pixels + (clip.y * surface->pitch),  // lower limit
+	            * const pixels_ul = (Uint8 *)surface->pixels + ((clip.y + clip.h) * surface->pitch);  // upper limit
 
 	for (; data < data_ul; ++data)
 	{
@@ -329,7 +586,7 @@ void IRAM_ATTR blit_sprite_hv( SDL_Surface *surface, int x, int y, unsigned int
 		default:  // set a pixel
 			if (pixels >= pixels_ul)
 				return;
-			if (pixels >= pixels_ll)
+			if (pixels >= pixels_ll && x + (int)x_offset >= clip.x && x + (int)x_offset < clip.x + clip.w)
 			{
 				Uint8 temp_value = (*data & 0x0f) + value;
 				if (temp_value > 0xf)
@@ -350,7 +607,6 @@ void IRAM_ATTR blit_sprite_hv( SDL_Surface *surface, int x, int y, unsigned int
 	}
 }
 
-// does not clip on left or right edges of surface
 void IRAM_ATTR blit_sprite_hv_blend( SDL_Surface *surface, int x, int y, unsigned int table, unsigned int index, Uint8 hue, Sint8 value )
 {
 	if (index >= sprite_table[table].count || !sprite_exists(table, index))
@@ -363,6 +619,38 @@ void IRAM_ATTR blit_sprite_hv_blend( SDL_Surface *surface, int x, int y, unsigne
 
 	const Sprite * const cur_sprite = sprite(table, index);
 
+	const SDL_Rect clip = *get_blit_clip(surface);
+
+#if SPRITE_SPANS
+	if (cur_sprite->spans != NULL)
+	{
+		for (unsigned int i = 0; i < cur_sprite->span_count; ++i)
+		{
+			const SpriteSpan * const span = &cur_sprite->spans[i];
+
+			int span_x = x + span->x;
+			const int span_y = y + span->y;
+			const Uint8 *data = cur_sprite->data + span->offset;
+			unsigned int length = span->length;
+
+			if (!clip_sprite_span(&clip, &span_x, span_y, &data, &length))
+				return;
+
+			Uint8 *pixels = (Uint8 *)surface->pixels + (span_y * surface->pitch) + span_x;
+
+			for (; length > 0; --length, ++pixels, ++data)
+			{
+				Uint8 temp_value = (*data & 0x0f) + value;
+				if (temp_value > 0xf)
+					temp_value = (temp_value >= 0x1f) ? 0x0 : 0xf;
+
+				*pixels = hue | (((*pixels & 0x0f) + temp_value) / 2);
+			}
+		}
+		return;
+	}
+#endif
+
 	const Uint8 *data = cur_sprite->data;
 	const Uint8 * const data_ul = data + cur_sprite->size;
 
@@ -371,8 +659,8 @@ void IRAM_ATTR blit_sprite_hv_blend( SDL_Surface *surface, int x, int y, unsigne
 
 	// assert(surface->BitsPerPixel == 8);
 	Uint8 *             pixels =    (Uint8 *)surface->pixels + (y * surface->pitch) + x;
-	const Uint8 * const pixels_ll = (Uint8 *)surface->pixels,  // lower limit
-	            * const pixels_ul = (Uint8 *)surface->pixels + (surface->h * surface->pitch);  // upper limit
+	const Uint8 * const pixels_ll = (Uint8 *)surface->pixels + (clip.y * surface->pitch),  // lower limit
+	            * const pixels_ul = (Uint8 *)surface->pixels + ((clip.y + clip.h) * surface->pitch);  // upper limit
 
 	for (; data < data_ul; ++data)
 	{
@@ -397,7 +685,7 @@ void IRAM_ATTR blit_sprite_hv_blend( SDL_Surface *surface, int x, int y, unsigne
 		default:  // set a pixel
 			if (pixels >= pixels_ul)
 				return;
-			if (pixels >= pixels_ll)
+			if (pixels >= pixels_ll && x + (int)x_offset >= clip.x && x + (int)x_offset < clip.x + clip.w)
 			{
 				Uint8 temp_value = (*data & 0x0f) + value;
 				if (temp_value > 0xf)
@@ -418,7 +706,6 @@ void IRAM_ATTR blit_sprite_hv_blend( SDL_Surface *surface, int x, int y, unsigne
 	}
 }
 
-// does not clip on left or right edges of surface
 void IRAM_ATTR blit_sprite_dark( SDL_Surface *surface, int x, int y, unsigned int table, unsigned int index, bool black )
 {
 	if (index >= sprite_table[table].count || !sprite_exists(table, index))
@@ -429,6 +716,35 @@ void IRAM_ATTR blit_sprite_dark( SDL_Surface *surface, int x, int y, unsigned in
 
 	const Sprite * const cur_sprite = sprite(table, index);
 
+	const SDL_Rect clip = *get_blit_clip(surface);
+
+#if SPRITE_SPANS
+	if (cur_sprite->spans != NULL)
+	{
+		for (unsigned int i = 0; i < cur_sprite->span_count; ++i)
+		{
+			const SpriteSpan * const span = &cur_sprite->spans[i];
+
+			int span_x = x + span->x;
+			const int span_y = y + span->y;
+			const Uint8 *data = cur_sprite->data + span->offset;
+			unsigned int length = span->length;
+
+			if (!clip_sprite_span(&clip, &span_x, span_y, &data, &length))
+				return;
+
+			Uint8 *pixels = (Uint8 *)surface->pixels + (span_y * surface->pitch) + span_x;
+
+			if (black)
+				memset(pixels, 0x00, length);
+			else
+				for (; length > 0; --length, ++pixels)
+					*pixels = palette_lut_halve[*pixels];
+		}
+		return;
+	}
+#endif
+
 	const Uint8 *data = cur_sprite->data;
 	const Uint8 * const data_ul = data + cur_sprite->size;
 
@@ -437,8 +753,8 @@ void IRAM_ATTR blit_sprite_dark( SDL_Surface *surface, int x, int y, unsigned in
 
 	// assert(surface->BitsPerPixel == 8);
 	Uint8 *             pixels =    (Uint8 *)surface->pixels + (y * surface->pitch) + x;
-	const Uint8 * const pixels_ll = (Uint8 *)surface->pixels,  // lower limit
-	            * const pixels_ul = (Uint8 *)surface->pixels + (surface->h * surface->pitch);  // upper limit
+	const Uint8 * const pixels_ll = (Uint8 *)surface->pixels + (clip.y * surface->pitch),  // lower limit
+	            * const pixels_ul = (Uint8 *)surface->pixels + ((clip.y + clip.h) * surface->pitch);  // upper limit
 
 	for (; data < data_ul; ++data)
 	{
@@ -463,8 +779,8 @@ void IRAM_ATTR blit_sprite_dark( SDL_Surface *surface, int x, int y, unsigned in
 		default:  // set a pixel
 			if (pixels >= pixels_ul)
 				return;
-			if (pixels >= pixels_ll)
-				*pixels = black ? 0x00 : ((*pixels & 0xf0) | ((*pixels & 0x0f) / 2));
+			if (pixels >= pixels_ll && x + (int)x_offset >= clip.x && x + (int)x_offset < clip.x + clip.w)
+				*pixels = black ? 0x00 : palette_lut_halve[*pixels];
 
 			pixels++;
 			x_offset++;
@@ -503,32 +819,178 @@ void JE_loadCompShapesB( Sprite2_array *sprite2s, FILE *f )
         return;
     }
 	efread(sprite2s->data, sizeof(Uint8), sprite2s->size, f);
+
+#if SPRITE_SPANS
+	compile_sprite2_spans(sprite2s);
+#endif
 }
 
 void free_sprite2s( Sprite2_array *sprite2s )
 {
 	free(sprite2s->data);
 	sprite2s->data = NULL;
+
+	free(sprite2s->span_index);
+	free(sprite2s->spans);
+	sprite2s->sprite_count = 0;
+	sprite2s->span_index = NULL;
+	sprite2s->spans = NULL;
+}
+
+#if SPRITE_SPANS
+// Walks the nibble-packed stream of one sprite the same way the decoding
+// blitters do and records each run of opaque pixels within a row.  Returns
+// the number of spans; they are only stored if spans is not NULL.  A sprite
+// whose stream runs past the end of the data gets no spans.
+static unsigned int build_sprite2_spans( const Sprite2_array *sprite2s, unsigned int index, Sprite2Span *spans )
+{
+	const Uint8 * const data_ll = sprite2s->data,
+	            * const data_ul = sprite2s->data + sprite2s->size;
+
+	const Uint8 *data = data_ll + SDL_Swap16LE(((Uint16 *)sprite2s->data)[index - 1]);
+
+	int x_offset = 0, y_offset = 0;
+
+	unsigned int count = 0;
+	Sprite2Span run = { 0, 0, 0, 0 };
+
+	for (; data < data_ul && *data != 0x0f; ++data)
+	{
+		x_offset += *data & 0x0f;                 // second nibble: transparent pixel count
+		unsigned int opaque = (*data & 0xf0) >> 4; // first nibble: opaque pixel count
+
+		if (opaque == 0) // move to next pixel row
+		{
+			x_offset -= 12;
+			y_offset++;
+			continue;
+		}
+
+		if (data + opaque >= data_ul)
+			return 0;
+
+		const unsigned int offset = (data + 1) - data_ll;
+
+		if (run.length > 0 && run.y == y_offset &&
+		    run.x + run.length == x_offset && run.offset + run.length == offset)
+		{
+			run.length += opaque;
+		}
+		else
+		{
+			if (run.length > 0 && spans != NULL)
+				spans[count - 1] = run;
+
+			run.x = x_offset;
+			run.y = y_offset;
+			run.length = opaque;
+			run.offset = offset;
+			count++;
+		}
+
+		x_offset += opaque;
+		data += opaque;
+	}
+	if (data >= data_ul)
+		return 0;
+
+	if (run.length > 0 && spans != NULL)
+		spans[count - 1] = run;
+
+	return count;
+}
+
+static void compile_sprite2_spans( Sprite2_array *sprite2s )
+{
+	sprite2s->sprite_count = 0;
+	sprite2s->span_index = NULL;
+	sprite2s->spans = NULL;
+
+	if (sprite2s->size < sizeof(Uint16))
+		return;
+
+	// Sprite2Span.offset is 16 bits; decode any larger array instead
+	if (sprite2s->size - 1 > UINT16_MAX)
+		return;
+
+	// the offset table ends where the first sprite begins
+	const unsigned int sprite_count = SDL_Swap16LE(((Uint16 *)sprite2s->data)[0]) / sizeof(Uint16);
+	if (sprite_count == 0 || sprite_count * sizeof(Uint16) > sprite2s->size)
+		return;
+
+	Uint32 *span_index = (Uint32 *)heap_caps_malloc((sprite_count + 1) * sizeof(Uint32), MALLOC_CAP_8BIT);
+	if (span_index == NULL)
+		return;
+
+	span_index[0] = 0;
+	for (unsigned int i = 1; i <= sprite_count; ++i)
+		span_index[i] = span_index[i - 1] + build_sprite2_spans(sprite2s, i, NULL);
+
+	Sprite2Span *spans = NULL;
+	if (span_index[sprite_count] > 0)
+		spans = (Sprite2Span *)heap_caps_malloc(span_index[sprite_count] * sizeof(Sprite2Span), MALLOC_CAP_8BIT);
+	if (spans == NULL)
+	{
+		free(span_index);
+		return;  // fall back to decoding
+	}
+
+	for (unsigned int i = 1; i <= sprite_count; ++i)
+		build_sprite2_spans(sprite2s, i, &spans[span_index[i - 1]]);
+
+	sprite2s->sprite_count = sprite_count;
+	sprite2s->span_index = span_index;
+	sprite2s->spans = spans;
 }
+#endif
 
-// does not clip on left or right edges of surface
 void IRAM_ATTR blit_sprite2( SDL_Surface *surface, int x, int y, Sprite2_array sprite2s, unsigned int index )
 {
+	const SDL_Rect clip = *get_blit_clip(surface);
+
+#if SPRITE_SPANS
+	if (sprite2s.spans != NULL && index - 1 < sprite2s.sprite_count)
+	{
+		const Sprite2Span *span = &sprite2s.spans[sprite2s.span_index[index - 1]];
+		const Sprite2Span * const span_end = &sprite2s.spans[sprite2s.span_index[index]];
+
+		for (; span < span_end; ++span)
+		{
+			int span_x = x + span->x;
+			const int span_y = y + span->y;
+			const Uint8 *data = sprite2s.data + span->offset;
+			unsigned int length = span->length;
+
+			if (!clip_sprite_span(&clip, &span_x, span_y, &data, &length))
+				return;
+
+			Uint8 *pixels = (Uint8 *)surface->pixels + (span_y * surface->pitch) + span_x;
+
+			memcpy(pixels, data, length);
+		}
+		return;
+	}
+#endif
+
 	// assert(surface->BitsPerPixel == 8);
 	Uint8 *             pixels =    (Uint8 *)surface->pixels + (y * surface->pitch) + x;
-	const Uint8 * const pixels_ll = (Uint8 *)surface->pixels,  // lower limit
-	            * const pixels_ul = (Uint8 *)surface->pixels + (surface->h * surface->pitch);  // upper limit
+	const Uint8 * const pixels_ll = (Uint8 *)surface->pixels + (clip.y * surface->pitch),  // lower limit
+	            * const pixels_ul = (Uint8 *)surface->pixels + ((clip.y + clip.h) * surface->pitch);  // upper limit
 
 	const Uint8 *data = sprite2s.data + SDL_Swap16LE(((Uint16 *)sprite2s.data)[index - 1]);
 
+	int column = x;
+
 	for (; *data != 0x0f; ++data)
 	{
 		pixels += *data & 0x0f;                   // second nibble: transparent pixel count
+		column += *data & 0x0f;
 		unsigned int count = (*data & 0xf0) >> 4; // first nibble: opaque pixel count
 
 		if (count == 0) // move to next pixel row
 		{
 			pixels += VGAScreen->pitch - 12;
+			column -= 12;
 		}
 		else
 		{
@@ -538,33 +1000,64 @@ void IRAM_ATTR blit_sprite2( SDL_Surface *surface, int x, int y, Sprite2_array s
 
 				if (pixels >= pixels_ul)
 					return;
-				if (pixels >= pixels_ll)
+				if (pixels >= pixels_ll && column >= clip.x && column < clip.x + clip.w)
 					*pixels = *data;
 
 				++pixels;
+				++column;
 			}
 		}
 	}
 }
 
-// does not clip on left or right edges of surface
 void IRAM_ATTR blit_sprite2_blend( SDL_Surface *surface,  int x, int y, Sprite2_array sprite2s, unsigned int index )
 {
+	const SDL_Rect clip = *get_blit_clip(surface);
+
+#if SPRITE_SPANS
+	if (sprite2s.spans != NULL && index - 1 < sprite2s.sprite_count)
+	{
+		const Sprite2Span *span = &sprite2s.spans[sprite2s.span_index[index - 1]];
+		const Sprite2Span * const span_end = &sprite2s.spans[sprite2s.span_index[index]];
+
+		for (; span < span_end; ++span)
+		{
+			int span_x = x + span->x;
+			const int span_y = y + span->y;
+			const Uint8 *data = sprite2s.data + span->offset;
+			unsigned int length = span->length;
+
+			if (!clip_sprite_span(&clip, &span_x, span_y, &data, &length))
+				return;
+
+			Uint8 *pixels = (Uint8 *)surface->pixels + (span_y * surface->pitch) + span_x;
+
+			for (; length > 0; --length, ++pixels, ++data)
+				*pixels = (((*data & 0x0f) + (*pixels & 0x0f)) / 2) | (*data & 0xf0);
+		}
+		return;
+	}
+#endif
+
 	// assert(surface->BitsPerPixel == 8);
 	Uint8 *             pixels =    (Uint8 *)surface->pixels + (y * surface->pitch) + x;
-	const Uint8 * const pixels_ll = (Uint8 *)surface->pixels,  // lower limit
-	            * const pixels_ul = (Uint8 *)surface->pixels + (surface->h * surface->pitch);  // upper limit
+	const Uint8 * const pixels_ll = (Uint8 *)surface->pixels + (clip.y * surface->pitch),  // lower limit
+	            * const pixels_ul = (Uint8 *)surface->pixels + ((clip.y + clip.h) * surface->pitch);  // upper limit
 
 	const Uint8 *data = sprite2s.data + SDL_Swap16LE(((Uint16 *)sprite2s.data)[index - 1]);
 
+	int column = x;
+
 	for (; *data != 0x0f; ++data)
 	{
 		pixels += *data & 0x0f;                   // second nibble: transparent pixel count
+		column += *data & 0x0f;
 		unsigned int count = (*data & 0xf0) >> 4; // first nibble: opaque pixel count
 
 		if (count == 0) // move to next pixel row
 		{
 			pixels += VGAScreen->pitch - 12;
+			column -= 12;
 		}
 		else
 		{
@@ -574,33 +1067,64 @@ void IRAM_ATTR blit_sprite2_blend( SDL_Surface *surface,  int x, int y, Sprite2_
 
 				if (pixels >= pixels_ul)
 					return;
-				if (pixels >= pixels_ll)
+				if (pixels >= pixels_ll && column >= clip.x && column < clip.x + clip.w)
 					*pixels = (((*data & 0x0f) + (*pixels & 0x0f)) / 2) | (*data & 0xf0);
 
 				++pixels;
+				++column;
 			}
 		}
 	}
 }
 
-// does not clip on left or right edges of surface
 void IRAM_ATTR blit_sprite2_darken( SDL_Surface *surface, int x, int y, Sprite2_array sprite2s, unsigned int index )
 {
+	const SDL_Rect clip = *get_blit_clip(surface);
+
+#if SPRITE_SPANS
+	if (sprite2s.spans != NULL && index - 1 < sprite2s.sprite_count)
+	{
+		const Sprite2Span *span = &sprite2s.spans[sprite2s.span_index[index - 1]];
+		const Sprite2Span * const span_end = &sprite2s.spans[sprite2s.span_index[index]];
+
+		for (; span < span_end; ++span)
+		{
+			int span_x = x + span->x;
+			const int span_y = y + span->y;
+			const Uint8 *data = sprite2s.data + span->offset;
+			unsigned int length = span->length;
+
+			if (!clip_sprite_span(&clip, &span_x, span_y, &data, &length))
+				return;
+
+			Uint8 *pixels = (Uint8 *)surface->pixels + (span_y * surface->pitch) + span_x;
+
+			for (; length > 0; --length, ++pixels)
+				*pixels = palette_lut_halve[*pixels];
+		}
+		return;
+	}
+#endif
+
 	// assert(surface->BitsPerPixel == 8);
 	Uint8 *             pixels =    (Uint8 *)surface->pixels + (y * surface->pitch) + x;
-	const Uint8 * const pixels_ll = (Uint8 *)surface->pixels,  // lower limit
-	            * const pixels_ul = (Uint8 *)surface->pixels + (surface->h * surface->pitch);  // upper limit
+	const Uint8 * const pixels_ll = (Uint8 *)surface->pixels + (clip.y * surface->pitch),  // lower limit
+	            * const pixels_ul = (Uint8 *)surface->pixels + ((clip.y + clip.h) * surface->pitch);  // upper limit
 
 	const Uint8 *data = sprite2s.data + SDL_Swap16LE(((Uint16 *)sprite2s.data)[index - 1]);
 
+	int column = x;
+
 	for (; *data != 0x0f; ++data)
 	{
 		pixels += *data & 0x0f;                   // second nibble: transparent pixel count
+		column += *data & 0x0f;
 		unsigned int count = (*data & 0xf0) >> 4; // first nibble: opaque pixel count
 
 		if (count == 0) // move to next pixel row
 		{
 			pixels += VGAScreen->pitch - 12;
+			column -= 12;
 		}
 		else
 		{
@@ -610,33 +1134,64 @@ void IRAM_ATTR blit_sprite2_darken( SDL_Surface *surface, int x, int y, Sprite2_
 
 				if (pixels >= pixels_ul)
 					return;
-				if (pixels >= pixels_ll)
-					*pixels = ((*pixels & 0x0f) / 2) + (*pixels & 0xf0);
+				if (pixels >= pixels_ll && column >= clip.x && column < clip.x + clip.w)
+					*pixels = palette_lut_halve[*pixels];
 
 				++pixels;
+				++column;
 			}
 		}
 	}
 }
 
-// does not clip on left or right edges of surface
 void IRAM_ATTR blit_sprite2_filter( SDL_Surface *surface, int x, int y, Sprite2_array sprite2s, unsigned int index, Uint8 filter )
 {
+	const SDL_Rect clip = *get_blit_clip(surface);
+
+#if SPRITE_SPANS
+	if (sprite2s.spans != NULL && index - 1 < sprite2s.sprite_count)
+	{
+		const Sprite2Span *span = &sprite2s.spans[sprite2s.span_index[index - 1]];
+		const Sprite2Span * const span_end = &sprite2s.spans[sprite2s.span_index[index]];
+
+		for (; span < span_end; ++span)
+		{
+			int span_x = x + span->x;
+			const int span_y = y + span->y;
+			const Uint8 *data = sprite2s.data + span->offset;
+			unsigned int length = span->length;
+
+			if (!clip_sprite_span(&clip, &span_x, span_y, &data, &length))
+				return;
+
+			Uint8 *pixels = (Uint8 *)surface->pixels + (span_y * surface->pitch) + span_x;
+
+			for (; length > 0; --length, ++pixels, ++data)
+				*pixels = filter | (*data & 0x0f);
+		}
+		return;
+	}
+#endif
+
 	// assert(surface->BitsPerPixel == 8);
 	Uint8 *             pixels =    (Uint8 *)surface->pixels + (y * surface->pitch) + x;
-	const Uint8 * const pixels_ll = (Uint8 *)surface->pixels,  // lower limit
-	            * const pixels_ul = (Uint8 *)surface->pixels + (surface->h * surface->pitch);  // upper limit
+	const Uint8 * const pixels_ll = (Uint8 *)surface->pixels + (clip.y * surface->pitch),  // lower limit
+	            * const pixels_ul = (Uint8 *)surface->pixels + ((clip.y + clip.h) * surface->pitch);  // upper limit
 
 	const Uint8 *data = sprite2s.data + SDL_Swap16LE(((Uint16 *)sprite2s.data)[index - 1]);
 
+	int column = x;
+
 	for (; *data != 0x0f; ++data)
 	{
 		pixels += *data & 0x0f;                   // second nibble: transparent pixel count
+		column += *data & 0x0f;
 		unsigned int count = (*data & 0xf0) >> 4; // first nibble: opaque pixel count
 
 		if (count == 0) // move to next pixel row
 		{
 			pixels += VGAScreen->pitch - 12;
+			column -= 12;
 		}
 		else
 		{
@@ -646,16 +1201,16 @@ void IRAM_ATTR blit_sprite2_filter( SDL_Surface *surface, int x, int y, Sprite2_
 
 				if (pixels >= pixels_ul)
 					return;
-				if (pixels >= pixels_ll)
+				if (pixels >= pixels_ll && column >= clip.x && column < clip.x + clip.w)
 					*pixels = filter | (*data & 0x0f);
 
 				++pixels;
+				++column;
 			}
 		}
 	}
 }
 
-// does not clip on left or right edges of surface
 void blit_sprite2x2( SDL_Surface *surface, int x, int y, Sprite2_array sprite2s, unsigned int index )
 {
 	blit_sprite2(surface, x,      y,      sprite2s, index);
@@ -664,7 +1219,6 @@ void blit_sprite2x2( SDL_Surface *surface, int x, int y, Sprite2_array sprite2s,
 	blit_sprite2(surface, x + 12, y + 14, sprite2s, index + 20);
 }
 
-// does not clip on left or right edges of surface
 void blit_sprite2x2_blend( SDL_Surface *surface, int x, int y, Sprite2_array sprite2s, unsigned int index )
 {
 	blit_sprite2_blend(surface, x,      y,      sprite2s, index);
@@ -673,7 +1227,6 @@ void blit_sprite2x2_blend( SDL_Surface *surface, int x, int y, Sprite2_array spr
 	blit_sprite2_blend(surface, x + 12, y + 14, sprite2s, index + 20);
 }
 
-// does not clip on left or right edges of surface
 void blit_sprite2x2_darken( SDL_Surface *surface, int x, int y, Sprite2_array sprite2s, unsigned int index )
 {
 	blit_sprite2_darken(surface, x,      y,      sprite2s, index);
@@ -41,11 +41,29 @@
 #define SPRITES_PER_TABLE_MAX  151
 #endif
 
+// Compile RLE sprites into span lists at load time; set to 0 to always use
+// the byte-by-byte decoder.
+#ifndef SPRITE_SPANS
+#define SPRITE_SPANS 1
+#endif
+
+// A run of opaque pixels within one row of a sprite.
+typedef struct
+{
+	Uint16 x, y;
+	Uint16 length;
+	Uint16 offset;  // of the first pixel in Sprite.data
+}
+SpriteSpan;
+
 typedef struct
 {
 	Uint16 width, height;
 	Uint16 size;
 	Uint8 *data;
+
+	Uint16 span_count;
+	SpriteSpan *spans;  // NULL if the sprite must be decoded from data
 }
 Sprite;
 
@@ -82,6 +100,13 @@ void load_sprites_file( unsigned table, const char *filename );
 void load_sprites( unsigned int table, FILE *f );
 void free_sprites( unsigned int table );
 
+// All blitters, and the background row blitters in backgrnd.c, clip to the
+// destination surface's SDL clip rectangle.  It is read once and cached for
+// the surface last blitted to, so change it with set_blit_clip() rather than
+// SDL_SetSurfaceClipRect(); NULL clips to the whole surface again.
+void set_blit_clip( SDL_Surface *, const SDL_Rect *clip );
+const SDL_Rect *get_blit_clip( SDL_Surface * );
+
 void blit_sprite( SDL_Surface *, int x, int y, unsigned int table, unsigned int index ); // JE_newDrawCShapeNum
 void blit_sprite_blend( SDL_Surface *, int x, int y, unsigned int table, unsigned int index ); // JE_newDrawCShapeTrick
 void blit_sprite_hv_unsafe( SDL_Surface *, int x, int y, unsigned int table, unsigned int index, Uint8 hue, Sint8 value ); // JE_newDrawCShapeBright
@@ -89,10 +114,25 @@ void blit_sprite_hv( SDL_Surface *, int x, int y, unsigned int table, unsigned i
 void blit_sprite_hv_blend( SDL_Surface *, int x, int y, unsigned int table, unsigned int index, Uint8 hue, Sint8 value ); // JE_newDrawCShapeModify
 void blit_sprite_dark( SDL_Surface *, int x, int y, unsigned int table, unsigned int index, bool black ); // JE_newDrawCShapeDarken, JE_newDrawCShapeShadow
 
+// A run of opaque pixels within one row of a Sprite2; x is relative to the
+// sprite origin and may be negative.
+typedef struct
+{
+	Sint16 x;
+	Uint16 y;
+	Uint16 length;
+	Uint16 offset;  // of the first pixel in Sprite2_array.data, so arrays over 64 KiB get no spans
+}
+Sprite2Span;
+
 typedef struct
 {
 	unsigned int size;
 	Uint8 *data;
+
+	unsigned int sprite_count;
+	Uint32 *span_index;  // spans of sprite i are [span_index[i - 1], span_index[i])
+	Sprite2Span *spans;  // NULL if sprites must be decoded from data
 }
 Sprite2_array;
 
@@ -18,6 +18,7 @@
  */
 #include "animlib.h"
 #include "backgrnd.h"
+#include "enemy_grid.h"
 //extern "C" {
 #include "episodes.h"
 //}
@@ -38,6 +39,7 @@
 #include "nortsong.h"
 #include "nortvars.h"
 #include "opentyr.h"
+#include "palette_lut.h"
 #include "params.h"
 #include "pcxload.h"
 #include "pcxmast.h"
@@ -51,6 +53,7 @@
 
 #include <assert.h>
 #include <ctype.h>
+#include <limits.h>
 #include <math.h>
 #include <stdlib.h>
 #include <string.h>
@@ -86,15 +89,20 @@ void JE_starShowVGA( void )
 	if (!playerEndLevel && !skipStarShowVGA)
 	{
 
+		// The playfield is drawn into game_screen's columns 24..287 and copied
+		// here rather than drawn into VGAScreenSeg through set_blit_clip():
+		// game_screen's margins and bottom rows would land on the sidebar and
+		// the HUD, the water, lava and blur filters write all 320 columns, and
+		// the menus copy the playfield back out of VGAScreenSeg.
 		s = (Uint8 *)VGAScreenSeg->pixels;
 
 		src = (JE_byte *)game_screen->pixels;
 		src += 24;
 
-		if (smoothScroll != 0 /*&& thisPlayerNum != 2*/)
+		if (smoothScroll != 0 /*&& thisPlayerNum != 2*/ || benchDemos)
 		{
-			wait_delay();
-			setjasondelay(frameCountMax);
+			if (!frame_step(frameCountMax))
+				goto star_show_end;
 		}
 
 		if (starShowVGASpecialCode == 1)
@@ -118,7 +126,7 @@ void JE_starShowVGA( void )
 				{
 					for (x = 320 - 56; x; x--)
 					{
-						*s = (*src & 0xf0) | ((*src >> 2) & 0x03);
+						*s = palette_lut_light[PALETTE_LUT_LIGHT_EDGE][*src];
 						s++;
 						src++;
 					}
@@ -130,10 +138,10 @@ void JE_starShowVGA( void )
 						lightdist = abs(lightx - x) + lighty;
 						if (lightdist < y)
 							*s = *src;
-						else if (lightdist - y <= 5)
-							*s = (*src & 0xf0) | (((*src & 0x0f) + (3 * (5 - (lightdist - y)))) / 4);
+						else if (lightdist - y <= PALETTE_LUT_LIGHT_EDGE)
+							*s = palette_lut_light[lightdist - y][*src];
 						else
-							*s = (*src & 0xf0) | ((*src & 0x0f) >> 2);
+							*s = palette_lut_light[PALETTE_LUT_LIGHT_EDGE][*src];
 						s++;
 						src++;
 					}
@@ -154,6 +162,7 @@ void JE_starShowVGA( void )
 		JE_showVGA();
 	}
 
+star_show_end:
 	quitRequested = false;
 	skipStarShowVGA = false;
 }
@@ -180,7 +189,7 @@ void JE_drawEnemy( int enemyOffset ) // actually does a whole lot more than just
 {
 	player[0].x -= 25;
 
-	for (int i = enemyOffset - 25; i < enemyOffset; i++)
+	for (int i = enemy_live_next(enemyOffset - 25, enemyOffset); i >= 0; i = enemy_live_next(i + 1, enemyOffset))
 	{
 		if (enemyAvail[i] != 1)
 		{
@@ -442,16 +451,10 @@ enemy_still_exists:
 						/*Rot*/
 							for (int tempCount = weapons[temp3].multi; tempCount > 0; tempCount--)
 							{
-								for (b = 0; b < ENEMY_SHOT_MAX; b++)
-								{
-									if (enemyShotAvail[b] == 1)
-										break;
-								}
-								if (b == ENEMY_SHOT_MAX)
+								b = slot_pool_alloc(&enemyShotPool);
+								if (b < 0)
 									goto draw_enemy_end;
 
-								enemyShotAvail[b] = !enemyShotAvail[b];
-
 								if (weapons[temp3].sound > 0)
 								{
 									do
@@ -1021,8 +1024,7 @@ start_level_first:
 	}
 
 	memset(enemyAvail,       1, sizeof(enemyAvail));
-	for (uint i = 0; i < COUNTOF(enemyShotAvail); i++)
-		enemyShotAvail[i] = 1;
+	slot_pool_reset(&enemyShotPool, ENEMY_SHOT_MAX);
 
 	/*Initialize Shots*/
 	memset(playerShotData,   0, sizeof(playerShotData));
@@ -1036,6 +1038,8 @@ start_level_first:
 
 	memset(explosions,       0, sizeof(explosions));
 	memset(rep_explosions,   0, sizeof(rep_explosions));
+	slot_pool_reset(&explosionPool, MAX_EXPLOSIONS);
+	slot_pool_reset(&repExplosionPool, MAX_REPEATING_EXPLOSIONS);
 
 	/* --- Clear Sound Queue --- */
 	memset(soundQueue,       0, sizeof(soundQueue));
@@ -1063,6 +1067,9 @@ start_level_first:
 
 	last_superpixel = 0;
 	memset(superpixels, 0, sizeof(superpixels));
+	slot_pool_reset(&superpixelPool, MAX_SUPERPIXELS);
+
+	frame_step_reset();
 
 	returnActive = false;
 
@@ -1351,6 +1358,7 @@ level_loop:
 
 	tempMapXOfs = mapXOfs;
 	tempBackMove = backMove;
+	enemy_live_rebuild();
 	JE_drawEnemy(50);
 	JE_drawEnemy(100);
 
@@ -1443,6 +1451,7 @@ level_loop:
 	}
 
 	/* Player Shot Images */
+	enemy_grid_build();
 	for (int z = 0; z < MAX_PWEAPON; z++)
 	{
 		if (shotAvail[z] != 0)
@@ -1459,7 +1468,22 @@ level_loop:
 				goto draw_player_shot_loop_end;
 			}
 
-			for (b = 0; b < 100; b++)
+			// enemy positions the tests below can accept for this shot
+			if (z == MAX_PWEAPON - 1)
+			{
+				const int reach = 25 - abs(zinglonDuration - 25);
+				enemy_grid_query(player[0].x + 7 - reach, INT_MIN, player[0].x + 7 + reach, INT_MAX);
+			}
+			else if (is_special)
+			{
+				enemy_grid_query(tempShotX - 24, tempShotY - 16, tempShotX + 2 * tempX2 + 24, tempShotY + 2 * tempY2 + 40);
+			}
+			else
+			{
+				enemy_grid_query(tempShotX - 24, tempShotY - 16, tempShotX + 24, tempShotY + 40);
+			}
+
+			for (b = enemy_grid_next(-1); b >= 0; b = enemy_grid_next(b))
 			{
 				if (enemyAvail[b] == 0)
 				{
@@ -1533,7 +1557,7 @@ level_loop:
 							if (enemy[b].enemyground)
 								enemy[b].filter = temp2;
 
-							for (unsigned int e = 0; e < COUNTOF(enemy); e++)
+							for (int e = enemy_live_next(0, COUNTOF(enemy)); e >= 0; e = enemy_live_next(e + 1, COUNTOF(enemy)))
 							{
 								if (enemy[e].linknum == temp &&
 								    enemyAvail[e] != 1 &&
@@ -1683,6 +1707,7 @@ level_loop:
 
 												enemy[b-1].ex = enemy[temp2].ex;
 												enemy[b-1].ey = enemy[temp2].ey;
+												enemy_grid_add(b-1);
 											}
 											b = temp_b;
 										}
@@ -1778,99 +1803,96 @@ draw_player_shot_loop_end:
 	{    /*MAIN DRAWING IS STOPPED STARTING HERE*/
 
 		/* Draw Enemy Shots */
-		for (int z = 0; z < ENEMY_SHOT_MAX; z++)
+		for (int z = slot_pool_next(&enemyShotPool, 0); z >= 0; z = slot_pool_next(&enemyShotPool, z + 1))
 		{
-			if (enemyShotAvail[z] == 0)
-			{
-				enemyShot[z].sxm += enemyShot[z].sxc;
-				enemyShot[z].sx += enemyShot[z].sxm;
+			enemyShot[z].sxm += enemyShot[z].sxc;
+			enemyShot[z].sx += enemyShot[z].sxm;
 
-				if (enemyShot[z].tx != 0)
+			if (enemyShot[z].tx != 0)
+			{
+				if (enemyShot[z].sx > player[0].x)
 				{
-					if (enemyShot[z].sx > player[0].x)
+					if (enemyShot[z].sxm > -enemyShot[z].tx)
 					{
-						if (enemyShot[z].sxm > -enemyShot[z].tx)
-						{
-							enemyShot[z].sxm--;
-						}
-					} else {
-						if (enemyShot[z].sxm < enemyShot[z].tx)
-						{
-							enemyShot[z].sxm++;
-						}
+						enemyShot[z].sxm--;
+					}
+				} else {
+					if (enemyShot[z].sxm < enemyShot[z].tx)
+					{
+						enemyShot[z].sxm++;
 					}
 				}
+			}
 
-				enemyShot[z].sym += enemyShot[z].syc;
-				enemyShot[z].sy += enemyShot[z].sym;
+			enemyShot[z].sym += enemyShot[z].syc;
+			enemyShot[z].sy += enemyShot[z].sym;
 
-				if (enemyShot[z].ty != 0)
+			if (enemyShot[z].ty != 0)
+			{
+				if (enemyShot[z].sy > player[0].y)
 				{
-					if (enemyShot[z].sy > player[0].y)
+					if (enemyShot[z].sym > -enemyShot[z].ty)
 					{
-						if (enemyShot[z].sym > -enemyShot[z].ty)
-						{
-							enemyShot[z].sym--;
-						}
-					} else {
-						if (enemyShot[z].sym < enemyShot[z].ty)
-						{
-							enemyShot[z].sym++;
-						}
+						enemyShot[z].sym--;
+					}
+				} else {
+					if (enemyShot[z].sym < enemyShot[z].ty)
+					{
+						enemyShot[z].sym++;
 					}
 				}
+			}
 
-				if (enemyShot[z].duration-- == 0 || enemyShot[z].sy > 190 || enemyShot[z].sy <= -14 || enemyShot[z].sx > 275 || enemyShot[z].sx <= 0)
-				{
-					enemyShotAvail[z] = true;
-				}
-				else  // check if shot collided with player
+			if (enemyShot[z].duration-- == 0 || enemyShot[z].sy > 190 || enemyShot[z].sy <= -14 || enemyShot[z].sx > 275 || enemyShot[z].sx <= 0)
+			{
+				slot_pool_free(&enemyShotPool, z);
+			}
+			else  // check if shot collided with player
+			{
+				for (uint i = 0; i < (twoPlayerMode ? 2 : 1); ++i)
 				{
-					for (uint i = 0; i < (twoPlayerMode ? 2 : 1); ++i)
+					if (player[i].is_alive &&
+					    enemyShot[z].sx > player[i].x - (signed)player[i].shot_hit_area_x &&
+					    enemyShot[z].sx < player[i].x + (signed)player[i].shot_hit_area_x &&
+					    enemyShot[z].sy > player[i].y - (signed)player[i].shot_hit_area_y &&
+					    enemyShot[z].sy < player[i].y + (signed)player[i].shot_hit_area_y)
 					{
-						if (player[i].is_alive &&
-						    enemyShot[z].sx > player[i].x - (signed)player[i].shot_hit_area_x &&
-						    enemyShot[z].sx < player[i].x + (signed)player[i].shot_hit_area_x &&
-						    enemyShot[z].sy > player[i].y - (signed)player[i].shot_hit_area_y &&
-						    enemyShot[z].sy < player[i].y + (signed)player[i].shot_hit_area_y)
-						{
-							tempX = enemyShot[z].sx;
-							tempY = enemyShot[z].sy;
-							temp = enemyShot[z].sdmg;
+						tempX = enemyShot[z].sx;
+						tempY = enemyShot[z].sy;
+						temp = enemyShot[z].sdmg;
 
-							enemyShotAvail[z] = true;
+						slot_pool_free(&enemyShotPool, z);
 
-							JE_setupExplosion(tempX, tempY, 0, 0, false, false);
+						JE_setupExplosion(tempX, tempY, 0, 0, false, false);
 
-							if (player[i].invulnerable_ticks == 0)
+						if (player[i].invulnerable_ticks == 0)
+						{
+							if ((temp = JE_playerDamage(temp, &player[i])) > 0)
 							{
-								if ((temp = JE_playerDamage(temp, &player[i])) > 0)
-								{
-									player[i].x_velocity += (enemyShot[z].sxm * temp) / 2;
-									player[i].y_velocity += (enemyShot[z].sym * temp) / 2;
-								}
+								player[i].x_velocity += (enemyShot[z].sxm * temp) / 2;
+								player[i].y_velocity += (enemyShot[z].sym * temp) / 2;
 							}
-
-							break;
 						}
+
+						break;
 					}
+				}
 
-					if (enemyShotAvail[z] == false)
+				if (slot_pool_used(&enemyShotPool, z))
+				{
+					if (enemyShot[z].animax != 0)
 					{
-						if (enemyShot[z].animax != 0)
-						{
-							if (++enemyShot[z].animate >= enemyShot[z].animax)
-								enemyShot[z].animate = 0;
-						}
-
-						if (enemyShot[z].sgr >= 500)
-							blit_sprite2(VGAScreen, enemyShot[z].sx, enemyShot[z].sy, shapesW2, enemyShot[z].sgr + enemyShot[z].animate - 500);
-						else
-							blit_sprite2(VGAScreen, enemyShot[z].sx, enemyShot[z].sy, shapesC1, enemyShot[z].sgr + enemyShot[z].animate);
+						if (++enemyShot[z].animate >= enemyShot[z].animax)
+							enemyShot[z].animate = 0;
 					}
-				}
 
+					if (enemyShot[z].sgr >= 500)
+						blit_sprite2(VGAScreen, enemyShot[z].sx, enemyShot[z].sy, shapesW2, enemyShot[z].sgr + enemyShot[z].animate - 500);
+					else
+						blit_sprite2(VGAScreen, enemyShot[z].sx, enemyShot[z].sy, shapesC1, enemyShot[z].sgr + enemyShot[z].animate);
+				}
 			}
+
 		}
 	}
 
@@ -1903,77 +1925,74 @@ draw_player_shot_loop_end:
 
 	/*-------------------------- Sequenced Explosions -------------------------*/
 	enemyStillExploding = false;
-	for (int i = 0; i < MAX_REPEATING_EXPLOSIONS; i++)
+	for (int i = slot_pool_next(&repExplosionPool, 0); i >= 0; i = slot_pool_next(&repExplosionPool, i + 1))
 	{
-		if (rep_explosions[i].ttl != 0)
-		{
-			enemyStillExploding = true;
+		enemyStillExploding = true;
 
-			if (rep_explosions[i].delay > 0)
-			{
-				rep_explosions[i].delay--;
-				continue;
-			}
-
-			rep_explosions[i].y += backMove2 + 1;
-			tempX = rep_explosions[i].x + (mt_rand() % 24) - 12;
-			tempY = rep_explosions[i].y + (mt_rand() % 27) - 24;
+		if (rep_explosions[i].delay > 0)
+		{
+			rep_explosions[i].delay--;
+			continue;
+		}
 
-			if (rep_explosions[i].big)
-			{
-				JE_setupExplosionLarge(false, 2, tempX, tempY);
+		rep_explosions[i].y += backMove2 + 1;
+		tempX = rep_explosions[i].x + (mt_rand() % 24) - 12;
+		tempY = rep_explosions[i].y + (mt_rand() % 27) - 24;
 
-				if (rep_explosions[i].ttl == 1 || mt_rand() % 5 == 1)
-					soundQueue[7] = S_EXPLOSION_11;
-				else
-					soundQueue[6] = S_EXPLOSION_9;
+		if (rep_explosions[i].big)
+		{
+			JE_setupExplosionLarge(false, 2, tempX, tempY);
 
-				rep_explosions[i].delay = 4 + (mt_rand() % 3);
-			}
+			if (rep_explosions[i].ttl == 1 || mt_rand() % 5 == 1)
+				soundQueue[7] = S_EXPLOSION_11;
 			else
-			{
-				JE_setupExplosion(tempX, tempY, 0, 1, false, false);
+				soundQueue[6] = S_EXPLOSION_9;
 
-				soundQueue[5] = S_EXPLOSION_4;
+			rep_explosions[i].delay = 4 + (mt_rand() % 3);
+		}
+		else
+		{
+			JE_setupExplosion(tempX, tempY, 0, 1, false, false);
 
-				rep_explosions[i].delay = 3;
-			}
+			soundQueue[5] = S_EXPLOSION_4;
 
-			rep_explosions[i].ttl--;
+			rep_explosions[i].delay = 3;
 		}
+
+		if (--rep_explosions[i].ttl == 0)
+			slot_pool_free(&repExplosionPool, i);
 	}
 
 	/*---------------------------- Draw Explosions ----------------------------*/
-	for (int j = 0; j < MAX_EXPLOSIONS; j++)
+	for (int j = slot_pool_next(&explosionPool, 0); j >= 0; j = slot_pool_next(&explosionPool, j + 1))
 	{
-		if (explosions[j].ttl != 0)
+		if (explosions[j].fixed_position != true)
 		{
-			if (explosions[j].fixed_position != true)
-			{
-				explosions[j].sprite++;
-				explosions[j].y += explodeMove;
-			}
-			else if (explosions[j].follow_player == true)
-			{
-				explosions[j].x += explosionFollowAmountX;
-				explosions[j].y += explosionFollowAmountY;
-			}
-			explosions[j].y += explosions[j].delta_y;
-			explosions[j].x += explosions[j].delta_x;
+			explosions[j].sprite++;
+			explosions[j].y += explodeMove;
+		}
+		else if (explosions[j].follow_player == true)
+		{
+			explosions[j].x += explosionFollowAmountX;
+			explosions[j].y += explosionFollowAmountY;
+		}
+		explosions[j].y += explosions[j].delta_y;
+		explosions[j].x += explosions[j].delta_x;
 
-			if (explosions[j].y > 200 - 14)
-			{
-				explosions[j].ttl = 0;
-			}
+		if (explosions[j].y > 200 - 14)
+		{
+			explosions[j].ttl = 0;
+			slot_pool_free(&explosionPool, j);
+		}
+		else
+		{
+			if (explosionTransparent)
+				blit_sprite2_blend(VGAScreen, explosions[j].x, explosions[j].y, shapes6, explosions[j].sprite + 1);
 			else
-			{
-				if (explosionTransparent)
-					blit_sprite2_blend(VGAScreen, explosions[j].x, explosions[j].y, shapes6, explosions[j].sprite + 1);
-				else
-					blit_sprite2(VGAScreen, explosions[j].x, explosions[j].y, shapes6, explosions[j].sprite + 1);
+				blit_sprite2(VGAScreen, explosions[j].x, explosions[j].y, shapes6, explosions[j].sprite + 1);
 
-				explosions[j].ttl--;
-			}
+			if (--explosions[j].ttl == 0)
+				slot_pool_free(&explosionPool, j);
 		}
 	}
 
@@ -3079,6 +3098,9 @@ new_game:
 		}
 	}
 
+	// map entries that match no shape draw nothing instead of stray memory
+	memset(ref, 0, sizeof(ref));
+
 	/* Read Shapes.DAT */
 	sprintf(tempStr, "shapes%c.dat", tolower((unsigned char)char_shapeFile));
 	FILE *shpFile = dir_fopen_die(data_dir(), tempStr, "rb");
@@ -3098,6 +3120,7 @@ new_game:
 			if (mapSh[0][x] == z+1)
 			{
 				memcpy(megaData1.shapes[x].sh, shape, sizeof(JE_DanCShape));
+				init_tile_info(&megaData1.shapes[x].info, (const Uint8 *)megaData1.shapes[x].sh);
 
 				ref[0][x] = (JE_byte *)megaData1.shapes[x].sh;
 			}
@@ -3118,6 +3141,7 @@ new_game:
 							y = 0;
 
 					megaData2.shapes[x].fill = y;
+					init_tile_info(&megaData2.shapes[x].info, (const Uint8 *)megaData2.shapes[x].sh);
 					ref[1][x] = (JE_byte *)megaData2.shapes[x].sh;
 				}
 				else
@@ -3142,6 +3166,7 @@ new_game:
 							y = 0;
 
 					megaData3.shapes[x].fill = y;
+					init_tile_info(&megaData3.shapes[x].info, (const Uint8 *)megaData3.shapes[x].sh);
 					ref[2][x] = (JE_byte *)megaData3.shapes[x].sh;
 				}
 				else
@@ -3191,6 +3216,9 @@ new_game:
 	efclose(level_f);
 	free(pic_buffer);
 	//free(mapBuf);
+
+	// the shapes and maps were replaced, possibly at the same addresses
+	invalidate_background_cache();
 	/* Note: The map data is automatically calculated with the correct mapsh
 	value and then the pointer is calculated using the formula (MAPSH-1)*168.
 	Then, we'll automatically add S2Ofs to get the exact offset location into
@@ -3394,11 +3422,18 @@ printf("JE_showVGA");
 				goto trentWinsGame;
 			}
 
-			waitForDemo = 2000;
-			JE_textMenuWait(&waitForDemo, false);
-
-			if (waitForDemo == 1)
+			if (benchDemos)
+			{
 				play_demo = true;
+			}
+			else
+			{
+				waitForDemo = 2000;
+				JE_textMenuWait(&waitForDemo, false);
+
+				if (waitForDemo == 1)
+					play_demo = true;
+			}
 
 			if (newkey)
 			{
@@ -3745,6 +3780,7 @@ Sint16 JE_newEnemy( int enemyOffset, Uint16 eDatI, Sint16 uniqueShapeTableI )
 		if (enemyAvail[i] == 1)
 		{
 			enemyAvail[i] = JE_makeEnemy(&enemy[i], eDatI, uniqueShapeTableI);
+			enemy_live_add(i);
 			return i + 1;
 		}
 	}
@@ -4049,6 +4085,7 @@ void JE_createNewEventEnemy( JE_byte enemyTypeOfs, JE_word enemyOffset, Sint16 u
 	tempW = eventRec[eventLoc-1].eventdat + enemyTypeOfs;
 
 	enemyAvail[b-1] = JE_makeEnemy(&enemy[b-1], tempW, uniqueShapeTableI);
+	enemy_live_add(b-1);
 
 	if (eventRec[eventLoc-1].eventdat2 != -99)
 	{
@@ -4123,7 +4160,7 @@ bool JE_searchFor/*enemy*/( JE_byte PLType, JE_byte* out_index )
 {
 	int found_id = -1;
 
-	for (int i = 0; i < 100; i++)
+	for (int i = enemy_live_next(0, 100); i >= 0; i = enemy_live_next(i + 1, 100))
 	{
 		if (enemyAvail[i] == 0 && enemy[i].linknum == PLType)
 		{
@@ -5106,7 +5143,7 @@ void draw_boss_bar( void )
 
 		unsigned int armor = 256;  // higher than armor max
 
-		for (unsigned int e = 0; e < COUNTOF(enemy); e++)  // find most damaged
+		for (int e = enemy_live_next(0, COUNTOF(enemy)); e >= 0; e = enemy_live_next(e + 1, COUNTOF(enemy)))  // find most damaged
 		{
 			if (enemyAvail[e] != 1 && enemy[e].linknum == boss_bar[b].link_num)
 				if (enemy[e].armorleft < armor)
@@ -255,6 +255,7 @@ JE_boolean skipStarShowVGA;
 /*EnemyData*/
 EXT_RAM_BSS_ATTR JE_MultiEnemyType enemy;
 JE_EnemyAvailType enemyAvail;  /* values: 0: used, 1: free, 2: secret pick-up */
+Uint32 enemyLive[(COUNTOF(enemyAvail) + 31) / 32];
 JE_word enemyOffset;
 JE_word enemyOnScreen;
 JE_byte enemyShapeTables[6]; /* [1..6] */
@@ -262,7 +263,7 @@ JE_word superEnemy254Jump;
 
 /*EnemyShotData*/
 JE_boolean fireButtonHeld;
-JE_boolean enemyShotAvail[ENEMY_SHOT_MAX]; /* [1..Enemyshotmax] */
+slot_pool_type enemyShotPool = { .size = ENEMY_SHOT_MAX };
 EXT_RAM_BSS_ATTR EnemyShotType enemyShot[ENEMY_SHOT_MAX]; /* [1..Enemyshotmax]  */
 
 /* Player Shot Data */
@@ -295,14 +296,17 @@ JE_word neat;
 
 /*ExplosionData*/
 EXT_RAM_BSS_ATTR explosion_type explosions[MAX_EXPLOSIONS]; /* [1..ExplosionMax] */
+slot_pool_type explosionPool = { .size = MAX_EXPLOSIONS };
 JE_integer explosionFollowAmountX, explosionFollowAmountY;
 
 /*Repeating Explosions*/
 rep_explosion_type rep_explosions[MAX_REPEATING_EXPLOSIONS]; /* [1..20] */
+slot_pool_type repExplosionPool = { .size = MAX_REPEATING_EXPLOSIONS };
 
 /*SuperPixels*/
 superpixel_type superpixels[MAX_SUPERPIXELS]; /* [0..MaxSP] */
 unsigned int last_superpixel;
+slot_pool_type superpixelPool = { .size = MAX_SUPERPIXELS };
 
 /*Temporary Numbers*/
 JE_byte temp, temp2, temp3;
@@ -454,10 +458,7 @@ void JE_tyrianHalt( JE_byte code )
 
 	free_sprite2s(&shapes6);
 
-	for (int i = 0; i < SAMPLE_COUNT; i++)
-	{
-		free(digiFx[i]);
-	}
+	JE_freeSndFile();
 
 	if (code != 9)
 	{
@@ -517,20 +518,17 @@ void JE_specialComplete( JE_byte playerNum, JE_byte specialType )
 			break;
 		/*Repulsor*/
 		case 2:
-			for (temp = 0; temp < ENEMY_SHOT_MAX; temp++)
+			for (int z = slot_pool_next(&enemyShotPool, 0); z >= 0; z = slot_pool_next(&enemyShotPool, z + 1))
 			{
-				if (!enemyShotAvail[temp])
-				{
-					if (player[0].x > enemyShot[temp].sx)
-						enemyShot[temp].sxm--;
-					else if (player[0].x < enemyShot[temp].sx)
-						enemyShot[temp].sxm++;
-
-					if (player[0].y > enemyShot[temp].sy)
-						enemyShot[temp].sym--;
-					else if (player[0].y < enemyShot[temp].sy)
-						enemyShot[temp].sym++;
-				}
+				if (player[0].x > enemyShot[z].sx)
+					enemyShot[z].sxm--;
+				else if (player[0].x < enemyShot[z].sx)
+					enemyShot[z].sxm++;
+
+				if (player[0].y > enemyShot[z].sy)
+					enemyShot[z].sym--;
+				else if (player[0].y < enemyShot[z].sy)
+					enemyShot[z].sym++;
 			}
 			break;
 		/*Zinglon Blast*/
@@ -931,28 +929,25 @@ void JE_setupExplosion( signed int x, signed int y, signed int delta_y, unsigned
 
 	if (y > -16 && y < 190)
 	{
-		for (int i = 0; i < MAX_EXPLOSIONS; i++)
+		const int i = slot_pool_alloc(&explosionPool);
+		if (i >= 0)
 		{
-			if (explosions[i].ttl == 0)
+			explosions[i].x = x;
+			explosions[i].y = y;
+			if (type == 6)
 			{
-				explosions[i].x = x;
-				explosions[i].y = y;
-				if (type == 6)
-				{
-					explosions[i].y += 12;
-					explosions[i].x += 2;
-				} else if (type == 98)
-				{
-					type = 6;
-				}
-				explosions[i].sprite = explosion_data[type].sprite;
-				explosions[i].ttl = explosion_data[type].ttl;
-				explosions[i].follow_player = follow_player;
-				explosions[i].fixed_position = fixed_position;
-				explosions[i].delta_x = 0;
-				explosions[i].delta_y = delta_y;
-				break;
+				explosions[i].y += 12;
+				explosions[i].x += 2;
+			} else if (type == 98)
+			{
+				type = 6;
 			}
+			explosions[i].sprite = explosion_data[type].sprite;
+			explosions[i].ttl = explosion_data[type].ttl;
+			explosions[i].follow_player = follow_player;
+			explosions[i].fixed_position = fixed_position;
+			explosions[i].delta_x = 0;
+			explosions[i].delta_y = delta_y;
 		}
 	}
 }
@@ -988,17 +983,14 @@ void JE_setupExplosionLarge( JE_boolean enemyGround, JE_byte exploNum, JE_intege
 
 		if (exploNum)
 		{
-			for (int i = 0; i < MAX_REPEATING_EXPLOSIONS; i++)
+			const int i = slot_pool_alloc(&repExplosionPool);
+			if (i >= 0)
 			{
-				if (rep_explosions[i].ttl == 0)
-				{
-					rep_explosions[i].ttl = exploNum;
-					rep_explosions[i].delay = 2;
-					rep_explosions[i].x = x;
-					rep_explosions[i].y = y;
-					rep_explosions[i].big = big;
-					break;
-				}
+				rep_explosions[i].ttl = exploNum;
+				rep_explosions[i].delay = 2;
+				rep_explosions[i].x = x;
+				rep_explosions[i].y = y;
+				rep_explosions[i].big = big;
 			}
 		}
 	}
@@ -1148,37 +1140,44 @@ void JE_doSP( JE_word x, JE_word y, JE_word num, JE_byte explowidth, JE_byte col
 		superpixels[last_superpixel].delta_y = tempy + 1;
 		superpixels[last_superpixel].color = color;
 		superpixels[last_superpixel].z = 15;
+		slot_pool_take(&superpixelPool, last_superpixel);
 	}
 }
 
 void JE_drawSP( void )
 {
-	for (int i = MAX_SUPERPIXELS; i--; )
+	for (int i = slot_pool_prev(&superpixelPool, MAX_SUPERPIXELS - 1); i >= 0; i = slot_pool_prev(&superpixelPool, i - 1))
 	{
-		if (superpixels[i].z)
-		{
-			superpixels[i].x += superpixels[i].delta_x;
-			superpixels[i].y += superpixels[i].delta_y;
-
-			if (superpixels[i].x < (unsigned)VGAScreen->w && superpixels[i].y < (unsigned)VGAScreen->h)
-			{
-				Uint8 *s = (Uint8 *)VGAScreen->pixels; /* screen pointer, 8-bit specific */
-				s += superpixels[i].y * VGAScreen->pitch;
-				s += superpixels[i].x;
-
-				*s = (((*s & 0x0f) + superpixels[i].z) >> 1) + superpixels[i].color;
-				if (superpixels[i].x > 0)
-					*(s - 1) = (((*(s - 1) & 0x0f) + (superpixels[i].z >> 1)) >> 1) + superpixels[i].color;
-				if (superpixels[i].x < VGAScreen->w - 1u)
-					*(s + 1) = (((*(s + 1) & 0x0f) + (superpixels[i].z >> 1)) >> 1) + superpixels[i].color;
-				if (superpixels[i].y > 0)
-					*(s - VGAScreen->pitch) = (((*(s - VGAScreen->pitch) & 0x0f) + (superpixels[i].z >> 1)) >> 1) + superpixels[i].color;
-				if (superpixels[i].y < VGAScreen->h - 1u)
-					*(s + VGAScreen->pitch) = (((*(s + VGAScreen->pitch) & 0x0f) + (superpixels[i].z >> 1)) >> 1) + superpixels[i].color;
-			}
+		superpixels[i].x += superpixels[i].delta_x;
+		superpixels[i].y += superpixels[i].delta_y;
 
-			superpixels[i].z--;
+		if (superpixels[i].x < (unsigned)VGAScreen->w && superpixels[i].y < (unsigned)VGAScreen->h)
+		{
+			Uint8 *s = (Uint8 *)VGAScreen->pixels; /* screen pointer, 8-bit specific */
+			s += superpixels[i].y * VGAScreen->pitch;
+			s += superpixels[i].x;
+
+			*s = (((*s & 0x0f) + superpixels[i].z) >> 1) + superpixels[i].color;
+			if (superpixels[i].x > 0)
+				*(s - 1) = (((*(s - 1) & 0x0f) + (superpixels[i].z >> 1)) >> 1) + superpixels[i].color;
+			if (superpixels[i].x < VGAScreen->w - 1u)
+				*(s + 1) = (((*(s + 1) & 0x0f) + (superpixels[i].z >> 1)) >> 1) + superpixels[i].color;
+			if (superpixels[i].y > 0)
+				*(s - VGAScreen->pitch) = (((*(s - VGAScreen->pitch) & 0x0f) + (superpixels[i].z >> 1)) >> 1) + superpixels[i].color;
+			if (superpixels[i].y < VGAScreen->h - 1u)
+				*(s + VGAScreen->pitch) = (((*(s + VGAScreen->pitch) & 0x0f) + (superpixels[i].z >> 1)) >> 1) + superpixels[i].color;
 		}
+
+		if (--superpixels[i].z == 0)
+			slot_pool_free(&superpixelPool, i);
 	}
 }
 
+void enemy_live_rebuild( void )
+{
+	memset(enemyLive, 0, sizeof(enemyLive));
+	for (unsigned int i = 0; i < COUNTOF(enemyAvail); i++)
+		if (enemyAvail[i] != 1)
+			enemy_live_add(i);
+}
+
@@ -22,6 +22,7 @@
 #include "episodes.h"
 #include "opentyr.h"
 #include "player.h"
+#include "slot_pool.h"
 #include "sprite.h"
 
 #include <stdbool.h>
@@ -50,58 +51,61 @@ enum
 #define MAX_REPEATING_EXPLOSIONS 20
 #define MAX_SUPERPIXELS          101
 
+/* Fields read by the per-frame scans over every slot (collision, drawing,
+ * targeting) come first so that a scan touches one or two cache lines of
+ * each enemy in PSRAM; the order is not otherwise significant. */
 struct JE_SingleEnemyType
 {
-	JE_byte     fillbyte;
 	JE_integer  ex, ey;     /* POSITION */
+	JE_word     mapoffset;
 	JE_shortint exc, eyc;   /* CURRENT SPEED */
-	JE_shortint exca, eyca; /* RANDOM ACCELERATION */
-	JE_shortint excc, eycc; /* FIXED ACCELERATION WAITTIME */
-	JE_shortint exccw, eyccw;
 	JE_byte     armorleft;
-	JE_byte     eshotwait[3], eshotmultipos[3]; /* [1..3] */
+	JE_byte     linknum;
 	JE_byte     enemycycle;
-	JE_byte     ani;
-	JE_word     egr[20]; /* [1..20] */
 	JE_byte     size;
-	JE_byte     linknum;
+	JE_byte     filter;
+	JE_byte     iced; /*Duration*/
+	JE_boolean  enemyground;
+	JE_boolean  scoreitem;
+	JE_integer  evalue;
+	JE_word     enemytype;
+	JE_word     edgr;
+	JE_byte     ani;
 	JE_byte     aniactive;
+	JE_byte     animin;
 	JE_byte     animax;
 	JE_byte     aniwhenfire;
+	JE_byte     xaccel;
+	JE_byte     yaccel;
 	Sprite2_array *sprite2s;
+
+	JE_byte     fillbyte;
+	JE_shortint exca, eyca; /* RANDOM ACCELERATION */
+	JE_shortint excc, eycc; /* FIXED ACCELERATION WAITTIME */
+	JE_shortint exccw, eyccw;
+	JE_byte     eshotwait[3], eshotmultipos[3]; /* [1..3] */
+	JE_word     egr[20]; /* [1..20] */
 	JE_shortint exrev, eyrev;
 	JE_integer  exccadd, eyccadd;
 	JE_byte     exccwmax, eyccwmax;
 	void       *enemydatofs;
 	JE_boolean  edamaged;
-	JE_word     enemytype;
-	JE_byte     animin;
-	JE_word     edgr;
 	JE_shortint edlevel;
 	JE_shortint edani;
 	JE_byte     fill1;
-	JE_byte     filter;
-	JE_integer  evalue;
 	JE_integer  fixedmovey;
 	JE_byte     freq[3]; /* [1..3] */
 	JE_byte     launchwait;
 	JE_word     launchtype;
 	JE_byte     launchfreq;
-	JE_byte     xaccel;
-	JE_byte     yaccel;
 	JE_byte     tur[3]; /* [1..3] */
 	JE_word     enemydie; /* Enemy created when this one dies */
-	JE_boolean  enemyground;
 	JE_byte     explonum;
-	JE_word     mapoffset;
-	JE_boolean  scoreitem;
 
 	JE_boolean  special;
 	JE_byte     flagnum;
 	JE_boolean  setto;
 
-	JE_byte     iced; /*Duration*/
-
 	JE_byte     launchspecial;
 
 	JE_integer  xminbounce;
@@ -115,6 +119,25 @@ typedef struct JE_SingleEnemyType JE_MultiEnemyType[100]; /* [1..100] */
 
 typedef JE_word JE_DanCShape[(24 * 28) / 2]; /* [1..(24*28) div 2] */
 
+// Transparency of a map shape, worked out once by JE_loadMap.  Always stored
+// directly in front of the shape's pixels so the background blitters can
+// find it from the pixel pointer alone.
+enum
+{
+	TILE_MIXED,
+	TILE_EMPTY,   // every pixel transparent
+	TILE_OPAQUE,  // no pixel transparent
+};
+
+typedef struct
+{
+	Uint32 row_mask[28];  // bit x set where pixel x of the row is opaque
+	JE_byte kind;
+	JE_byte padding[3];
+} JE_TileInfo;
+
+#define TILE_ROW_OPAQUE ((1u << 24) - 1)
+
 typedef JE_char JE_CharString[256]; /* [1..256] */
 
 //typedef JE_byte JE_Map1Buffer[24 * 28 * 13 * 4]; /* [1..24*28*13*4] */
@@ -150,6 +173,7 @@ struct JE_MegaDataType1
 	JE_MapType mainmap;  //[300][14];
 	struct
 	{
+		JE_TileInfo info;
 		JE_DanCShape sh;
 	} shapes[72]; /* [0..71] */
 	JE_byte tempdat1;
@@ -163,6 +187,7 @@ struct JE_MegaDataType2
 	{
 		JE_byte nothing[3]; /* [1..3] */
 		JE_byte fill;
+		JE_TileInfo info;
 		JE_DanCShape sh;
 	} shapes[71]; /* [0..70] */
 	JE_byte tempdat2;
@@ -175,6 +200,7 @@ struct JE_MegaDataType3
 	{
 		JE_byte nothing[3]; /* [1..3] */
 		JE_byte fill;
+		JE_TileInfo info;
 		JE_DanCShape sh;
 	} shapes[70]; /* [0..69] */
 	JE_byte tempdat3;
@@ -293,14 +319,16 @@ extern JE_boolean moveTyrianLogoUp;
 extern JE_boolean skipStarShowVGA;
 EXT_RAM_BSS_ATTR extern JE_MultiEnemyType enemy;
 extern JE_EnemyAvailType enemyAvail;
+extern Uint32 enemyLive[(COUNTOF(enemyAvail) + 31) / 32];
 extern JE_word enemyOffset;
 extern JE_word enemyOnScreen;
 extern JE_byte enemyShapeTables[6];
 extern JE_word superEnemy254Jump;
 EXT_RAM_BSS_ATTR extern explosion_type explosions[MAX_EXPLOSIONS];
+extern slot_pool_type explosionPool;
 extern JE_integer explosionFollowAmountX, explosionFollowAmountY;
 extern JE_boolean fireButtonHeld;
-extern JE_boolean enemyShotAvail[ENEMY_SHOT_MAX];
+extern slot_pool_type enemyShotPool;
 EXT_RAM_BSS_ATTR extern EnemyShotType enemyShot[ENEMY_SHOT_MAX];
 extern JE_byte zinglonDuration;
 extern JE_byte astralDuration;
@@ -320,8 +348,10 @@ extern JE_boolean optionAttachmentLinked, optionAttachmentReturn;
 extern JE_byte chargeWait, chargeLevel, chargeMax, chargeGr, chargeGrWait;
 extern JE_word neat;
 extern rep_explosion_type rep_explosions[MAX_REPEATING_EXPLOSIONS];
+extern slot_pool_type repExplosionPool;
 extern superpixel_type superpixels[MAX_SUPERPIXELS];
 extern unsigned int last_superpixel;
+extern slot_pool_type superpixelPool;
 extern JE_byte temp, temp2, temp3;
 extern JE_word tempX, tempY;
 extern JE_word tempW;
@@ -367,6 +397,37 @@ void JE_drawSP( void );
 
 void JE_drawOptionLevel( void );
 
+/* enemyLive holds one bit per enemy slot that may be in use.  Every enemy
+ * that is made sets its bit, and enemy_live_rebuild() clears the bits of
+ * freed slots once a frame, so the bits are always a superset of the slots
+ * with enemyAvail != 1.  Scans over all enemies walk it to skip free slots
+ * without reading enemy[], which lives in PSRAM. */
+void enemy_live_rebuild( void );
+
+static inline void enemy_live_add( unsigned int i )
+{
+	enemyLive[i / 32] |= 1u << (i % 32);
+}
+
+/* Returns the first possibly live slot in [i, end), or -1.  Reads the bits
+ * afresh each call, so enemies made during a scan are still visited if
+ * their slot is ahead of it. */
+static inline int enemy_live_next( int i, int end )
+{
+	while (i < end)
+	{
+		const Uint32 word = enemyLive[i / 32] >> (i % 32);
+		if (word == 0)
+		{
+			i = (i / 32 + 1) * 32;
+			continue;
+		}
+		i += __builtin_ctz(word);
+		return (i < end) ? i : -1;
+	}
+	return -1;
+}
+
 
 #endif /* VARZ_H */
 
@@ -19,21 +19,27 @@
 #include "keyboard.h"
 #include "opentyr.h"
 #include "palette.h"
+#include "scaler_jobs.h"
 #include "video.h"
+#include "video_expand.h"
 #include "video_scale.h"
 
 #include <assert.h>
+#include <limits.h>
+#include <stdatomic.h>
 #include <stdbool.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
 #include "freertos/task.h"
 
-#include <time.h>  // Include for time functions
-
-// Define variables for FPS calculation
-static uint32_t frame_count = 0;
-static uint32_t start_time = 0;
+// app_main pins the game thread to core 0, so on dual-core chips the display
+// gets the other core to itself; on single-core chips they share core 0
+#define PRESENT_TASK_CORE (portNUM_PROCESSORS - 1)
+#define PRESENT_TASK_STACK 8192
+#define PRESENT_TASK_PRIORITY 5
 
 bool fullscreen_enabled = false;
 
@@ -42,15 +48,67 @@ SDL_Surface *VGAScreen2;
 SDL_Surface *game_screen;
 
 SDL_Window *window = NULL;
-SDL_Renderer *renderer= NULL;
 
-static ScalerFunction scaler_function;
+// RGB565 at the current scaler's output size; refilled in place every frame
+// and recreated only when the scaler changes
+static SDL_Surface *vga_frame = NULL;
+static unsigned int vga_frame_scaler = 0;
+static unsigned int failed_scaler = UINT_MAX;  // don't retry an allocation that failed
+
+// copy of the last frame handed to the display, used to find changed rows
+EXT_RAM_BSS_ATTR static Uint8 presented_pixels[vga_height][vga_width];
+static Uint16 presented_palette[256];
+static bool present_all = true;
+
+// Runs of changed scanlines closer together than this are pushed as one
+// span, since every push to the panel has its own setup cost
+#define DIRTY_SPAN_GAP 4
+#define MAX_DIRTY_SPANS 8
+
+typedef struct
+{
+	int first_row, last_row;
+}
+DirtySpan;
+
+// A finished frame together with the colors it was drawn with.
+typedef struct
+{
+	Uint8 pixels[vga_height][vga_width];
+	Uint16 palette[256];
+	unsigned int scaler;
+}
+PresentFrame;
+
+// Triple buffer between the game thread and the present task.  The game
+// thread owns present_back, the present task owns present_front, and the
+// third slot is handed over through present_pending with atomic exchanges,
+// so neither side ever waits for the other.
+#define PENDING_FRESH 0x4u  // set while the pending slot has not been presented
+
+EXT_RAM_BSS_ATTR static PresentFrame present_frames[3];
+static unsigned int present_back = 0, present_front = 1;
+static atomic_uint present_pending = 2;
+
+static TaskHandle_t present_task = NULL;
+static SemaphoreHandle_t present_task_done = NULL;
+static atomic_bool present_task_quit = false;
+
+static atomic_uint frames_presented = 0, frames_dropped = 0, frames_unchanged = 0;
+static atomic_uint bytes_pushed = 0, bytes_whole = 0;  // wrap; only differences are reported
+
+static bool create_vga_frame( unsigned int new_scaler );
+static void present_frame( const PresentFrame *frame );
+static void present_task_main( void *arg );
 
 // int scale_factor = 1;
 
-void clear_screen(SDL_Renderer *renderer) {
-    SDL_SetRenderDrawColor(renderer, 88, 66, 255, 255);
-    SDL_RenderClear(renderer);
+void clear_screen(SDL_Window *window) {
+    SDL_Surface *surface = SDL_GetWindowSurface(window);
+    if (surface != NULL) {
+        SDL_FillSurfaceRect(surface, NULL, 0);
+        SDL_UpdateWindowSurface(window);
+    }
 }
 
 void init_video( void )
@@ -67,15 +125,26 @@ void init_video( void )
 		return;
 	}
 
-	renderer = SDL_CreateRenderer(window, NULL);
-	if (!renderer) {
-		printf("Failed to create renderer: %s\n", SDL_GetError());
+	if (!create_vga_frame(0)) {
 		SDL_DestroyWindow(window);
+		window = NULL;
 		return;
 	}
 
-	clear_screen(renderer);
-	SDL_RenderPresent(renderer);
+	clear_screen(window);
+
+	// from here on only the present task touches the window surface
+	present_task_done = xSemaphoreCreateBinary();
+	if (present_task_done == NULL ||
+	    xTaskCreatePinnedToCore(present_task_main, "present", PRESENT_TASK_STACK, NULL, PRESENT_TASK_PRIORITY, &present_task, PRESENT_TASK_CORE) != pdPASS)
+	{
+		printf("Failed to create present task, presenting synchronously\n");
+		present_task = NULL;
+	}
+
+	// scalers are split across the present core and any core the game
+	// thread, which is calling this, does not run on
+	init_scaler_jobs(present_task != NULL ? PRESENT_TASK_CORE : xPortGetCoreID(), xPortGetCoreID());
 
 
 	// SDL_WM_SetCaption("OpenTyrian", NULL);
@@ -114,89 +183,24 @@ int can_init_scaler( unsigned int new_scaler, bool fullscreen )
 	if (new_scaler >= scalers_count)
 		return false;
 
-	int w = scalers[new_scaler].width,
-	    h = scalers[new_scaler].height;
-	// int flags = SDL_SWSURFACE | SDL_HWPALETTE | (fullscreen ? SDL_FULLSCREEN : 0);
-
-	int flags = 0;
-	// test each bitdepth
-	for (uint bpp = 32; bpp > 0; bpp -= 8)
-	{
-		// uint temp_bpp = SDL_VideoModeOK(w, h, bpp, flags);
-		uint temp_bpp = 8;
-
-    if ((temp_bpp == 32 && scalers[new_scaler].scaler32) ||
-		    (temp_bpp == 16 && scalers[new_scaler].scaler16) ||
-		    (temp_bpp == 8  && scalers[new_scaler].scaler8 ))
-		{
-			return temp_bpp;
-		}
-		else if (temp_bpp == 24 && scalers[new_scaler].scaler32)
-		{
-			// scalers don't support 24 bpp because it's a pain
-			// so let SDL handle the conversion
-			return 32;
-		}
-	}
-
-	return 0;
+	// frames are expanded straight from INDEX8 into an RGB565 frame, so
+	// only scalers with a fused expand kernel can be used
+	return scalers[new_scaler].expand16 != NULL ? 16 : 0;
 }
 
 
 bool init_scaler( unsigned int new_scaler, bool fullscreen )
 {
-	int w = scalers[new_scaler].width,
-	    h = scalers[new_scaler].height;
-	// int bpp = can_init_scaler(new_scaler, fullscreen);
-	int bpp = 8;
-	// int flags = SDL_SWSURFACE | SDL_HWPALETTE | (fullscreen ? SDL_FULLSCREEN : 0);
-	int flags = 0;
+	int bpp = can_init_scaler(new_scaler, fullscreen);
 	
 	if (bpp == 0)
 		return false;
 	
-	// SDL_Surface *const surface = SDL_SetVideoMode(w, h, bpp, flags);
-
-
-	
-	// if (surface == NULL)
-	// {
-	// 	fprintf(stderr, "error: failed to initialize %s video mode %dx%dx%d: %s\n", fullscreen ? "fullscreen" : "windowed", w, h, bpp, SDL_GetError());
-	// 	return false;
-	// }
-	
-	// w = surface->w;
-	// h = surface->h;
-	// // bpp = surface->BitsPerPixel;
-	// bpp = 8;
-	
-	// printf("initialized video: %dx%dx%d %s\n", w, h, bpp, fullscreen ? "fullscreen" : "windowed");
-	
+	// the present path resizes its frame when it sees a frame drawn for
+	// a different scaler, so nothing here touches the window
 	scaler = new_scaler;
 	fullscreen_enabled = fullscreen;
 	
-	switch (bpp)
-	{
-	case 32:
-		scaler_function = scalers[scaler].scaler32;
-		break;
-	case 16:
-		scaler_function = scalers[scaler].scaler16;
-		break;
-	case 8:
-		scaler_function = scalers[scaler].scaler8;
-		break;
-	default:
-		scaler_function = NULL;
-		break;
-	}
-	
-	if (scaler_function == NULL)
-	{
-		assert(false);
-		return false;
-	}
-	
 	input_grab(input_grab_enabled);
 	
 	JE_showVGA();
@@ -225,6 +229,22 @@ bool init_any_scaler( bool fullscreen )
 
 void deinit_video( void )
 {
+	if (present_task != NULL)
+	{
+		atomic_store(&present_task_quit, true);
+		xTaskNotifyGive(present_task);
+		xSemaphoreTake(present_task_done, portMAX_DELAY);
+		present_task = NULL;
+	}
+
+	deinit_scaler_jobs();
+
+	if (vga_frame != NULL)
+	{
+		SDL_DestroySurface(vga_frame);
+		vga_frame = NULL;
+	}
+
 	SDL_DestroySurface(VGAScreenSeg);
 	SDL_DestroySurface(VGAScreen2);
 	SDL_DestroySurface(game_screen);
@@ -238,56 +258,263 @@ void JE_clr256( SDL_Surface * screen)
 }
 void JE_showVGA( void ) { scale_and_flip(VGAScreen); }
 
-void scale_and_flip(SDL_Surface *src_surface)
+// Finds the runs of scanlines that differ from the last presented frame.
+// Comparing against what was actually presented catches every writer, not
+// just the sprite blitters.  Sets *whole and returns a single span covering
+// the frame when everything has to be redrawn; returns 0 if nothing changed.
+static int find_dirty_spans( const PresentFrame *frame, DirtySpan spans[MAX_DIRTY_SPANS], bool *whole )
 {
-    if (renderer == NULL) {
-        printf("Renderer is NULL, unable to draw\n");
-        return;
+    // every pixel on screen may map to a different color now
+    if (memcmp(frame->palette, presented_palette, sizeof(presented_palette)) != 0)
+    {
+        memcpy(presented_palette, frame->palette, sizeof(presented_palette));
+        present_all = true;
     }
 
-    // Convert the SDL_Surface to an SDL_Texture
-    SDL_Texture *texture = SDL_CreateTextureFromSurface(renderer, src_surface);
-    if (!texture) {
-        SDL_Log("Failed to create texture: %s", SDL_GetError());
-        return;
+    *whole = present_all;
+    if (present_all)
+    {
+        present_all = false;
+        spans[0] = (DirtySpan){ 0, vga_height - 1 };
+        return 1;
+    }
+
+    int count = 0;
+    for (int y = 0; y < vga_height; ++y)
+    {
+        if (memcmp(frame->pixels[y], presented_pixels[y], vga_width) == 0)
+            continue;
+
+        // Scale2x/Scale3x/hqNx output depends on the rows on either side too
+        const int first_row = MAX(y - 1, 0),
+                  last_row = MIN(y + 1, vga_height - 1);
+
+        if (count > 0 && (first_row - spans[count - 1].last_row - 1 <= DIRTY_SPAN_GAP || count == MAX_DIRTY_SPANS))
+            spans[count - 1].last_row = last_row;
+        else
+            spans[count++] = (DirtySpan){ first_row, last_row };
+    }
+    return count;
+}
+
+static int gcd( int a, int b )
+{
+    while (b != 0)
+    {
+        const int t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+// Whether vga_frame is shown 1:1 in the middle of the window, since the
+// expand kernel has already scaled it, rather than stretched over it.
+static bool frame_fits_window( const SDL_Surface *window_surface )
+{
+    return vga_frame_scaler != 0 && vga_frame->w <= window_surface->w && vga_frame->h <= window_surface->h;
+}
+
+// Copies output rows y..y+h-1 of vga_frame to the window surface and returns
+// the window rect they landed in.
+static SDL_Rect blit_frame_rows( SDL_Surface *window_surface, int y, int h )
+{
+    const int frame_w = vga_frame->w, frame_h = vga_frame->h,
+              window_w = window_surface->w, window_h = window_surface->h;
+
+    if (frame_fits_window(window_surface))
+    {
+        const SDL_Rect src_rect = { 0, y, frame_w, h };
+        const SDL_Rect dst_rect = { (window_w - frame_w) / 2, (window_h - frame_h) / 2 + y, frame_w, h };
+        SDL_BlitSurface(vga_frame, &src_rect, window_surface, &dst_rect);
+        return dst_rect;
     }
 
-    // Clear the renderer
-    SDL_RenderClear(renderer);
+    // Widen the rows to whole periods of the frame-to-window ratio, so the
+    // stretched band lines up exactly with the same rows of a whole-frame
+    // stretch and no seam shows where a partial update meets older rows.
+    // Nearest-neighbour for the same reason: a filtered stretch would blend
+    // across the band edges differently from a whole-frame one.
+    const int period = frame_h / gcd(frame_h, window_h);
+    const int y0 = y / period * period,
+              y1 = (y + h + period - 1) / period * period;
+
+    const SDL_Rect src_rect = { 0, y0, frame_w, y1 - y0 };
+    const SDL_Rect dst_rect = { 0, y0 * window_h / frame_h, window_w, (y1 - y0) * window_h / frame_h };
+    SDL_BlitSurfaceScaled(vga_frame, &src_rect, window_surface, &dst_rect, SDL_SCALEMODE_NEAREST);
+    return dst_rect;
+}
 
-    // Get the window dimensions
-    int window_width, window_height;
-    SDL_GetWindowSize(window, &window_width, &window_height);
+// Expands the changed scanlines of frame into vga_frame, copies them to the
+// window surface and hands only those rows to the display.  On SPI panels
+// the push is what costs, so a menu that changes one line of text pushes a
+// few rows instead of the whole screen.  Returns false if nothing changed.
+static bool push_dirty_spans( const PresentFrame *frame )
+{
+    DirtySpan spans[MAX_DIRTY_SPANS];
+    bool whole;
+    const int span_count = find_dirty_spans(frame, spans, &whole);
+    if (span_count == 0)
+        return false;
+
+    SDL_Surface *window_surface = SDL_GetWindowSurface(window);
+    if (window_surface == NULL) {
+        SDL_Log("Failed to get window surface: %s", SDL_GetError());
+        present_all = true;
+        return false;
+    }
 
-    // Define the destination rectangle for scaling
-    SDL_FRect dst_rect = { 0, 0, window_width, window_height };
+    const struct Scalers *s = &scalers[vga_frame_scaler];
+    const int scale_y = s->height / vga_height;
 
-    // Copy the texture to the renderer, scaling it to fit the window
-    SDL_RenderTexture(renderer, texture, NULL, &dst_rect);
+    if (whole && frame_fits_window(window_surface))
+        SDL_FillSurfaceRect(window_surface, NULL, 0);  // the border around the frame
 
-    // Present the renderer (equivalent to SDL_Flip in SDL2)
-    SDL_RenderPresent(renderer);
+    SDL_Rect rects[MAX_DIRTY_SPANS];
+    for (int i = 0; i < span_count; ++i)
+    {
+        const int first_row = spans[i].first_row,
+                  last_row = spans[i].last_row,
+                  rows = last_row - first_row + 1;
 
-    // Cleanup: destroy the texture after rendering
-    SDL_DestroyTexture(texture);
+        // presented_palette holds the same colors as frame->palette, but in internal RAM
+        Uint8 *dst = (Uint8 *)vga_frame->pixels + first_row * scale_y * vga_frame->pitch;
+        run_scaler_bands(s->expand16, dst, vga_frame->pitch, scale_y, &frame->pixels[0][0], vga_width, presented_palette, first_row, last_row);
 
-    // --- FPS Calculation ---
-    frame_count++;  // Increment the frame count
-    uint32_t current_time = SDL_GetTicks();  // Get current time in milliseconds
+        memcpy(presented_pixels[first_row], frame->pixels[first_row], rows * vga_width);
 
-    if (start_time == 0) {
-        // Initialize the start time for the first frame
-        start_time = current_time;
+        rects[i] = blit_frame_rows(window_surface, first_row * scale_y, rows * scale_y);
     }
 
-    uint32_t elapsed_time = current_time - start_time;  // Calculate elapsed time in milliseconds
+    const int bytes_per_pixel = SDL_BYTESPERPIXEL(window_surface->format);
+    const unsigned int window_bytes = window_surface->w * window_surface->h * bytes_per_pixel;
 
-    if (elapsed_time >= 5000) {  // If 5 seconds have passed
-        float fps = (frame_count / (elapsed_time / 1000.0f));  // Calculate FPS
-        printf("FPS: %.2f\n", fps);  // Print FPS to console
+    unsigned int bytes = 0;
+    if (whole)
+    {
+        SDL_UpdateWindowSurface(window);
+        bytes = window_bytes;
+    }
+    else
+    {
+        SDL_UpdateWindowSurfaceRects(window, rects, span_count);
+        for (int i = 0; i < span_count; ++i)
+            bytes += rects[i].w * rects[i].h * bytes_per_pixel;
+    }
 
-        // Reset for next interval
-        frame_count = 0;
-        start_time = current_time;
+    atomic_fetch_add(&bytes_pushed, bytes);
+    atomic_fetch_add(&bytes_whole, window_bytes);
+    return true;
+}
+
+// (Re)creates vga_frame at the output size of new_scaler.  Only runs
+// wherever frames are presented from.
+static bool create_vga_frame( unsigned int new_scaler )
+{
+    if (vga_frame != NULL)
+        SDL_DestroySurface(vga_frame);
+
+    const int w = scalers[new_scaler].width,
+              h = scalers[new_scaler].height;
+
+    vga_frame = SDL_CreateSurface(w, h, SDL_PIXELFORMAT_RGB565);
+    if (vga_frame == NULL) {
+        printf("Failed to create %dx%d frame: %s\n", w, h, SDL_GetError());
+        return false;
     }
-}
\ No newline at end of file
+
+    vga_frame_scaler = new_scaler;
+    present_all = true;
+    return true;
+}
+
+static void present_frame( const PresentFrame *frame )
+{
+    unsigned int frame_scaler = frame->scaler;
+    if (frame_scaler >= scalers_count || scalers[frame_scaler].expand16 == NULL || frame_scaler == failed_scaler)
+        frame_scaler = 0;
+
+    if (frame_scaler != vga_frame_scaler || vga_frame == NULL)
+    {
+        if (!create_vga_frame(frame_scaler))
+        {
+            // keep going unscaled rather than retrying every frame
+            failed_scaler = frame_scaler;
+            if (frame_scaler == 0 || !create_vga_frame(0))
+                return;
+        }
+    }
+
+    // Nothing changed on screen, so skip the transfer to the display entirely
+    if (push_dirty_spans(frame))
+        atomic_fetch_add(&frames_presented, 1);
+    else
+        atomic_fetch_add(&frames_unchanged, 1);
+}
+
+static void present_task_main( void *arg )
+{
+    (void)arg;
+
+    while (!atomic_load(&present_task_quit))
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        if (atomic_load(&present_pending) & PENDING_FRESH)
+        {
+            present_front = atomic_exchange(&present_pending, present_front) & ~PENDING_FRESH;
+            present_frame(&present_frames[present_front]);
+        }
+    }
+
+    xSemaphoreGive(present_task_done);
+    vTaskDelete(NULL);
+}
+
+void get_present_stats( Uint32 *presented, Uint32 *dropped, Uint32 *unchanged )
+{
+    *presented = atomic_load(&frames_presented);
+    *dropped = atomic_load(&frames_dropped);
+    *unchanged = atomic_load(&frames_unchanged);
+}
+
+void get_present_bytes( Uint32 *pushed, Uint32 *whole )
+{
+    *pushed = atomic_load(&bytes_pushed);
+    *whole = atomic_load(&bytes_whole);
+}
+
+// Hands a finished frame to the present task and returns immediately.  If the
+// display has not caught up with the previously published frame, that frame
+// is replaced and counted as dropped.
+void scale_and_flip(SDL_Surface *src_surface)
+{
+    if (window == NULL) {
+        printf("Window is NULL, unable to draw\n");
+        return;
+    }
+
+    assert(src_surface->w == vga_width && src_surface->h == vga_height);
+
+    PresentFrame *frame = &present_frames[present_back];
+
+    const Uint8 *src = (const Uint8 *)src_surface->pixels;
+    for (int y = 0; y < vga_height; y++) {
+        memcpy(frame->pixels[y], src, vga_width);
+        src += src_surface->pitch;
+    }
+    memcpy(frame->palette, rgb565_palette, sizeof(frame->palette));
+    frame->scaler = scaler;
+
+    if (present_task == NULL) {
+        present_frame(frame);
+        return;
+    }
+
+    const unsigned int previous = atomic_exchange(&present_pending, present_back | PENDING_FRESH);
+    if (previous & PENDING_FRESH)
+        atomic_fetch_add(&frames_dropped, 1);
+    present_back = previous & ~PENDING_FRESH;
+
+    xTaskNotifyGive(present_task);
+}
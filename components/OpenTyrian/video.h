@@ -44,6 +44,11 @@ void deinit_video( void );
 void JE_clr256( SDL_Surface * );
 void JE_showVGA( void );
 void scale_and_flip( SDL_Surface * );
+void get_present_stats( Uint32 *presented, Uint32 *dropped, Uint32 *unchanged );
+
+// Bytes handed to the display, and what handing over the whole window for
+// every presented frame would have been; both wrap around.
+void get_present_bytes( Uint32 *pushed, Uint32 *whole );
 
 #endif /* VIDEO_H */
 
@@ -0,0 +1,85 @@
+/*
+ * OpenTyrian: A modern cross-platform port of Tyrian
+ * Copyright (C) 2007-2009  The OpenTyrian Development Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+#include "video_expand.h"
+
+#include <stdint.h>
+#include <string.h>
+
+/*
+ * Neither the ESP32-S3 PIE nor the ESP32-P4 SIMD extension has a gather
+ * load, so a palette lookup cannot be vectorized directly: every pixel is a
+ * scalar load from the table whatever the target.  What does pay off on
+ * these in-order cores is cutting the loop and memory overhead around the
+ * lookups -- fetching the indices a word at a time, storing two pixels per
+ * 32-bit write, and unrolling so the loads can be scheduled ahead of their
+ * uses.  That kernel relies on the byte order of the packed words, so it
+ * is only selected on little-endian targets (all ESP32 parts are).
+ */
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+#define EXPAND_WORDWISE 1
+#else
+#define EXPAND_WORDWISE 0
+#endif
+
+void IRAM_ATTR expand_index8_rgb565_c( Uint16 *dst, const Uint8 *src, const Uint16 *palette, unsigned int count )
+{
+	for (unsigned int i = 0; i < count; ++i)
+		dst[i] = palette[src[i]];
+}
+
+#if EXPAND_WORDWISE
+static void IRAM_ATTR expand_index8_rgb565_wordwise( Uint16 *dst, const Uint8 *src, const Uint16 *palette, unsigned int count )
+{
+	// a single leading pixel brings the stores onto a word boundary
+	if (((uintptr_t)dst & 3) != 0 && count > 0)
+	{
+		*dst++ = palette[*src++];
+		--count;
+	}
+
+	for (; count >= 8; count -= 8)
+	{
+		Uint32 lo, hi;
+		memcpy(&lo, src, sizeof(lo));  // the source rows need not be aligned
+		memcpy(&hi, src + 4, sizeof(hi));
+		src += 8;
+
+		const Uint32 p0 = palette[lo & 0xff], p1 = palette[(lo >> 8) & 0xff];
+		const Uint32 p2 = palette[(lo >> 16) & 0xff], p3 = palette[lo >> 24];
+		const Uint32 p4 = palette[hi & 0xff], p5 = palette[(hi >> 8) & 0xff];
+		const Uint32 p6 = palette[(hi >> 16) & 0xff], p7 = palette[hi >> 24];
+
+		const Uint32 out[4] = { p0 | (p1 << 16), p2 | (p3 << 16), p4 | (p5 << 16), p6 | (p7 << 16) };
+		memcpy(dst, out, sizeof(out));  // aligned, so these become plain word stores
+		dst += 8;
+	}
+
+	while (count-- > 0)
+		*dst++ = palette[*src++];
+}
+#endif
+
+void IRAM_ATTR expand_index8_rgb565( Uint16 *dst, const Uint8 *src, const Uint16 *palette, unsigned int count )
+{
+#if EXPAND_WORDWISE
+	expand_index8_rgb565_wordwise(dst, src, palette, count);
+#else
+	expand_index8_rgb565_c(dst, src, palette, count);
+#endif
+}
@@ -0,0 +1,35 @@
+/*
+ * OpenTyrian: A modern cross-platform port of Tyrian
+ * Copyright (C) 2007-2009  The OpenTyrian Development Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+#ifndef VIDEO_EXPAND_H
+#define VIDEO_EXPAND_H
+
+#include "opentyr.h"
+
+#include "SDL3/SDL.h"
+
+// Converts count palette indices into RGB565 pixels.  dst only needs to be
+// 2-byte aligned; palette should live in internal RAM since every source
+// pixel is a lookup into it.
+void expand_index8_rgb565( Uint16 *dst, const Uint8 *src, const Uint16 *palette, unsigned int count );
+
+// The straightforward per-pixel loop, kept as the reference the selected
+// kernel has to match bit-for-bit.
+void expand_index8_rgb565_c( Uint16 *dst, const Uint8 *src, const Uint16 *palette, unsigned int count );
+
+#endif /* VIDEO_EXPAND_H */
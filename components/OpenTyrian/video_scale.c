@@ -24,6 +24,7 @@
 
 #include "palette.h"
 #include "video.h"
+#include "video_expand.h"
 
 #include <assert.h>
 
@@ -36,26 +37,33 @@ static void scale2x_16( SDL_Surface *src_surface, SDL_Surface *dst_surface );
 static void scale3x_32( SDL_Surface *src_surface, SDL_Surface *dst_surface );
 static void scale3x_16( SDL_Surface *src_surface, SDL_Surface *dst_surface );
 
-void hq2x_32( SDL_Surface *src_surface, SDL_Surface *dst_surface );
-void hq3x_32( SDL_Surface *src_surface, SDL_Surface *dst_surface );
-void hq4x_32( SDL_Surface *src_surface, SDL_Surface *dst_surface );
+void hq2x_16( Uint8 *dst, int dst_pitch, const Uint8 *src, int src_pitch, const Uint16 *palette, int first_row, int last_row );
+void hq3x_16( Uint8 *dst, int dst_pitch, const Uint8 *src, int src_pitch, const Uint16 *palette, int first_row, int last_row );
+void hq4x_16( Uint8 *dst, int dst_pitch, const Uint8 *src, int src_pitch, const Uint16 *palette, int first_row, int last_row );
+
+static void expand_1x_16( Uint8 *dst, int dst_pitch, const Uint8 *src, int src_pitch, const Uint16 *palette, int first_row, int last_row );
+static void expand_nn2_16( Uint8 *dst, int dst_pitch, const Uint8 *src, int src_pitch, const Uint16 *palette, int first_row, int last_row );
+static void expand_nn3_16( Uint8 *dst, int dst_pitch, const Uint8 *src, int src_pitch, const Uint16 *palette, int first_row, int last_row );
+static void expand_nn4_16( Uint8 *dst, int dst_pitch, const Uint8 *src, int src_pitch, const Uint16 *palette, int first_row, int last_row );
+static void expand_scale2x_16( Uint8 *dst, int dst_pitch, const Uint8 *src, int src_pitch, const Uint16 *palette, int first_row, int last_row );
+static void expand_scale3x_16( Uint8 *dst, int dst_pitch, const Uint8 *src, int src_pitch, const Uint16 *palette, int first_row, int last_row );
 
 uint scaler;
 
 const struct Scalers scalers[] =
 {
 #if defined(TARGET_GP2X) || defined(TARGET_DINGUX)
-	{ 320,           240,            no_scale, nn_16,      nn_32,      "None" },
+	{ 320,           240,            no_scale, nn_16,      nn_32,      NULL,              "None" },
 #else
-	{ 1 * vga_width, 1 * vga_height, no_scale, nn_16,      nn_32,      "None" },
-	{ 2 * vga_width, 2 * vga_height, NULL,     nn_16,      nn_32,      "2x" },
-	{ 2 * vga_width, 2 * vga_height, NULL,     scale2x_16, scale2x_32, "Scale2x" },
-	{ 2 * vga_width, 2 * vga_height, NULL,     NULL,       hq2x_32,    "hq2x" },
-	{ 3 * vga_width, 3 * vga_height, NULL,     nn_16,      nn_32,      "3x" },
-	{ 3 * vga_width, 3 * vga_height, NULL,     scale3x_16, scale3x_32, "Scale3x" },
-	{ 3 * vga_width, 3 * vga_height, NULL,     NULL,       hq3x_32,    "hq3x" },
-	{ 4 * vga_width, 4 * vga_height, NULL,     nn_16,      nn_32,      "4x" },
-	{ 4 * vga_width, 4 * vga_height, NULL,     NULL,       hq4x_32,    "hq4x" },
+	{ 1 * vga_width, 1 * vga_height, no_scale, nn_16,      nn_32,      expand_1x_16,      "None" },
+	{ 2 * vga_width, 2 * vga_height, NULL,     nn_16,      nn_32,      expand_nn2_16,     "2x" },
+	{ 2 * vga_width, 2 * vga_height, NULL,     scale2x_16, scale2x_32, expand_scale2x_16, "Scale2x" },
+	{ 2 * vga_width, 2 * vga_height, NULL,     NULL,       NULL,       hq2x_16,           "hq2x" },
+	{ 3 * vga_width, 3 * vga_height, NULL,     nn_16,      nn_32,      expand_nn3_16,     "3x" },
+	{ 3 * vga_width, 3 * vga_height, NULL,     scale3x_16, scale3x_32, expand_scale3x_16, "Scale3x" },
+	{ 3 * vga_width, 3 * vga_height, NULL,     NULL,       NULL,       hq3x_16,           "hq3x" },
+	{ 4 * vga_width, 4 * vga_height, NULL,     nn_16,      nn_32,      expand_nn4_16,     "4x" },
+	{ 4 * vga_width, 4 * vga_height, NULL,     NULL,       NULL,       hq4x_16,           "hq4x" },
 #endif
 };
 const uint scalers_count = COUNTOF(scalers);
@@ -436,3 +444,185 @@ void scale3x_16( SDL_Surface *src_surface, SDL_Surface *dst_surface )
 	}
 }
 
+
+/*
+ * The expand_* scalers below read the INDEX8 frame directly and write RGB565
+ * into the streaming texture, so each frame is touched once instead of being
+ * expanded to a full-size 16-bit copy and then scaled from that.
+ */
+
+void IRAM_ATTR expand_1x_16( Uint8 *dst, int dst_pitch, const Uint8 *src, int src_pitch, const Uint16 *palette, int first_row, int last_row )
+{
+	src += first_row * src_pitch;
+	
+	for (int y = first_row; y <= last_row; y++)
+	{
+		expand_index8_rgb565((Uint16 *)dst, src, palette, vga_width);
+		
+		src += src_pitch;
+		dst += dst_pitch;
+	}
+}
+
+static inline void expand_nn_16( Uint8 *dst, int dst_pitch, const Uint8 *src, int src_pitch, const Uint16 *palette, int first_row, int last_row, const int scale )
+{
+	const int width = vga_width;   // src_surface->w
+	
+	src += first_row * src_pitch;
+	
+	for (int y = first_row; y <= last_row; y++)
+	{
+		Uint16 *dst_row = (Uint16 *)dst;
+		
+		for (int x = 0; x < width; x++)
+		{
+			const Uint16 color = palette[src[x]];
+			for (int z = 0; z < scale; z++)
+				*dst_row++ = color;
+		}
+		
+		// the remaining output rows of this source row are identical
+		for (int z = 1; z < scale; z++)
+			memcpy(dst + z * dst_pitch, dst, scale * width * sizeof(Uint16));
+		
+		src += src_pitch;
+		dst += scale * dst_pitch;
+	}
+}
+
+void IRAM_ATTR expand_nn2_16( Uint8 *dst, int dst_pitch, const Uint8 *src, int src_pitch, const Uint16 *palette, int first_row, int last_row )
+{
+	expand_nn_16(dst, dst_pitch, src, src_pitch, palette, first_row, last_row, 2);
+}
+
+void IRAM_ATTR expand_nn3_16( Uint8 *dst, int dst_pitch, const Uint8 *src, int src_pitch, const Uint16 *palette, int first_row, int last_row )
+{
+	expand_nn_16(dst, dst_pitch, src, src_pitch, palette, first_row, last_row, 3);
+}
+
+void IRAM_ATTR expand_nn4_16( Uint8 *dst, int dst_pitch, const Uint8 *src, int src_pitch, const Uint16 *palette, int first_row, int last_row )
+{
+	expand_nn_16(dst, dst_pitch, src, src_pitch, palette, first_row, last_row, 4);
+}
+
+void IRAM_ATTR expand_scale2x_16( Uint8 *dst, int dst_pitch, const Uint8 *src, int src_pitch, const Uint16 *palette, int first_row, int last_row )
+{
+	const int dst_Bpp = 2;
+	
+	const int height = vga_height, // src_surface->h
+	          width = vga_width;   // src_surface->w
+	
+	int prevline, nextline;
+	
+	src += first_row * src_pitch;
+	
+	const Uint8 *src_temp;
+	Uint8 *dst_temp;
+	
+	Uint16 E0, E1, E2, E3, B, D, E, F, H;
+	for (int y = first_row; y <= last_row; y++)
+	{
+		src_temp = src;
+		dst_temp = dst;
+		
+		prevline = (y > 0) ? -src_pitch : 0;
+		nextline = (y < height - 1) ? src_pitch : 0;
+		
+		for (int x = 0; x < width; x++)
+		{
+			B = palette[*(src + prevline)];
+			D = palette[*(x > 0 ? src - 1 : src)];
+			E = palette[*src];
+			F = palette[*(x < width - 1 ? src + 1 : src)];
+			H = palette[*(src + nextline)];
+			
+			if (B != H && D != F) {
+				E0 = D == B ? D : E;
+				E1 = B == F ? F : E;
+				E2 = D == H ? D : E;
+				E3 = H == F ? F : E;
+			} else {
+				E0 = E1 = E2 = E3 = E;
+			}
+			
+			*(Uint16 *)dst = E0;
+			*(Uint16 *)(dst + dst_Bpp) = E1;
+			*(Uint16 *)(dst + dst_pitch) = E2;
+			*(Uint16 *)(dst + dst_pitch + dst_Bpp) = E3;
+			
+			src++;
+			dst += 2 * dst_Bpp;
+		}
+		
+		src = src_temp + src_pitch;
+		dst = dst_temp + 2 * dst_pitch;
+	}
+}
+
+void IRAM_ATTR expand_scale3x_16( Uint8 *dst, int dst_pitch, const Uint8 *src, int src_pitch, const Uint16 *palette, int first_row, int last_row )
+{
+	const int dst_Bpp = 2;
+	
+	const int height = vga_height, // src_surface->h
+	          width = vga_width;   // src_surface->w
+	
+	int prevline, nextline;
+	
+	src += first_row * src_pitch;
+	
+	const Uint8 *src_temp;
+	Uint8 *dst_temp;
+	
+	Uint16 E0, E1, E2, E3, E4, E5, E6, E7, E8, A, B, C, D, E, F, G, H, I;
+	for (int y = first_row; y <= last_row; y++)
+	{
+		src_temp = src;
+		dst_temp = dst;
+		
+		prevline = (y > 0) ? -src_pitch : 0;
+		nextline = (y < height - 1) ? src_pitch : 0;
+		
+		for (int x = 0; x < width; x++)
+		{
+			A = palette[*(src + prevline - (x > 0 ? 1 : 0))];
+			B = palette[*(src + prevline)];
+			C = palette[*(src + prevline + (x < width - 1 ? 1 : 0))];
+			D = palette[*(src - (x > 0 ? 1 : 0))];
+			E = palette[*src];
+			F = palette[*(src + (x < width - 1 ? 1 : 0))];
+			G = palette[*(src + nextline - (x > 0 ? 1 : 0))];
+			H = palette[*(src + nextline)];
+			I = palette[*(src + nextline + (x < width - 1 ? 1 : 0))];
+			
+			if (B != H && D != F) {
+				E0 = D == B ? D : E;
+				E1 = (D == B && E != C) || (B == F && E != A) ? B : E;
+				E2 = B == F ? F : E;
+				E3 = (D == B && E != G) || (D == H && E != A) ? D : E;
+				E4 = E;
+				E5 = (B == F && E != I) || (H == F && E != C) ? F : E;
+				E6 = D == H ? D : E;
+				E7 = (D == H && E != I) || (H == F && E != G) ? H : E;
+				E8 = H == F ? F : E;
+			} else {
+				E0 = E1 = E2 = E3 = E4 = E5 = E6 = E7 = E8 = E;
+			}
+			
+			*(Uint16 *)dst = E0;
+			*(Uint16 *)(dst + dst_Bpp) = E1;
+			*(Uint16 *)(dst + 2 * dst_Bpp) = E2;
+			*(Uint16 *)(dst + dst_pitch) = E3;
+			*(Uint16 *)(dst + dst_pitch + dst_Bpp) = E4;
+			*(Uint16 *)(dst + dst_pitch + 2 * dst_Bpp) = E5;
+			*(Uint16 *)(dst + 2 * dst_pitch) = E6;
+			*(Uint16 *)(dst + 2 * dst_pitch + dst_Bpp) = E7;
+			*(Uint16 *)(dst + 2 * dst_pitch + 2 * dst_Bpp) = E8;
+			
+			src++;
+			dst += 3 * dst_Bpp;
+		}
+		
+		src = src_temp + src_pitch;
+		dst = dst_temp + 3 * dst_pitch;
+	}
+}
@@ -25,10 +25,17 @@
 
 typedef void (*ScalerFunction)( SDL_Surface *dst, SDL_Surface *src );
 
+// Expands and scales source rows first_row..last_row of an INDEX8 frame in a
+// single pass, writing RGB565 through palette.  src points at the top of the
+// whole frame so edge-detecting scalers can read the rows around the band;
+// dst points at the output of first_row.
+typedef void (*ExpandScalerFunction)( Uint8 *dst, int dst_pitch, const Uint8 *src, int src_pitch, const Uint16 *palette, int first_row, int last_row );
+
 struct Scalers
 {
 	int width, height;
 	ScalerFunction scaler8, scaler16, scaler32;
+	ExpandScalerFunction expand16;
 	const char *name;
 };
 
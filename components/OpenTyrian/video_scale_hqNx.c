@@ -33,11 +33,10 @@ void interp7(Uint32 *pc, Uint32 c1, Uint32 c2, Uint32 c3);
 void interp8(Uint32 *pc, Uint32 c1, Uint32 c2);
 void interp9(Uint32 *pc, Uint32 c1, Uint32 c2, Uint32 c3);
 void interp10(Uint32 *pc, Uint32 c1, Uint32 c2, Uint32 c3);
-bool diff(unsigned int w1, unsigned int w2);
 
-void hq2x_32( SDL_Surface *src_surface, SDL_Surface *dst_surface );
-void hq3x_32( SDL_Surface *src_surface, SDL_Surface *dst_surface );
-void hq4x_32( SDL_Surface *src_surface, SDL_Surface *dst_surface );
+void hq2x_16( Uint8 *out, int out_pitch, const Uint8 *src, int src_pitch, const Uint16 *palette, int first_row, int last_row );
+void hq3x_16( Uint8 *out, int out_pitch, const Uint8 *src, int src_pitch, const Uint16 *palette, int first_row, int last_row );
+void hq4x_16( Uint8 *out, int out_pitch, const Uint8 *src, int src_pitch, const Uint16 *palette, int first_row, int last_row );
 
 //static int   YUV1, YUV2;
 const  int   Ymask = 0x00FF0000;
@@ -47,6 +46,40 @@ const  int   trY   = 0x00300000;
 const  int   trU   = 0x00000700;
 const  int   trV   = 0x00000006;
 
+// Works out the colours the kernels blend, which are the RGB565 palette
+// widened to XRGB8888 and cut to six bits per component, and their YUV for
+// the neighbour comparisons.  Each call builds its own, so bands scaled at
+// the same time never share tables that a palette change is rewriting.
+static void hq_palette_tables( const Uint16 *palette, Uint32 *colors, Uint32 *yuv )
+{
+	for (int i = 0; i < 256; i++)
+	{
+		const int r = (palette[i] >> 11) & 0x1f,
+		          g = (palette[i] >> 5) & 0x3f,
+		          b = palette[i] & 0x1f;
+		const int r8 = (r << 3) | (r >> 2),
+		          g8 = (g << 2) | (g >> 4),
+		          b8 = (b << 3) | (b >> 2);
+		
+		colors[i] = ((r8 << 16) | (g8 << 8) | b8) & 0xfcfcfcfc;
+		yuv[i] = rgb_to_yuv(r8, g8, b8);
+	}
+}
+
+// Packs an n x n block of XRGB8888 output pixels down to RGB565.
+static inline void pack_block_rgb565( Uint8 *out, int out_pitch, const Uint32 *block, int n )
+{
+	for (int y = 0; y < n; y++)
+	{
+		Uint16 *out_row = (Uint16 *)(out + y * out_pitch);
+		for (int x = 0; x < n; x++)
+		{
+			const Uint32 c = *block++;
+			out_row[x] = ((c >> 8) & 0xf800) | ((c >> 5) & 0x07e0) | ((c >> 3) & 0x001f);
+		}
+	}
+}
+
 inline void interp1(Uint32 *pc, Uint32 c1, Uint32 c2)
 {
 	*pc = (c1*3+c2) >> 2;
@@ -118,15 +151,19 @@ inline void interp10(Uint32 *pc, Uint32 c1, Uint32 c2, Uint32 c3)
 	       (((c1 & 0xFF00FF)*14 + (c2 & 0xFF00FF) + (c3 & 0xFF00FF) ) & 0x0FF00FF0)) >> 4;
 }
 
-inline bool diff(unsigned int w1, unsigned int w2)
+static inline bool hq_diff( const Uint32 *yuv, unsigned int w1, unsigned int w2 )
 {
-	Uint32 YUV1 = yuv_palette[w1];
-	Uint32 YUV2 = yuv_palette[w2];
+	if (w1 == w2)
+		return false;
+	
+	const Uint32 YUV1 = yuv[w1], YUV2 = yuv[w2];
 	return ( ( abs((YUV1 & Ymask) - (YUV2 & Ymask)) > trY ) ||
 	         ( abs((YUV1 & Umask) - (YUV2 & Umask)) > trU ) ||
 	         ( abs((YUV1 & Vmask) - (YUV2 & Vmask)) > trV ) );
 }
 
+#define diff(w1, w2) hq_diff(yuv, (w1), (w2))
+
 
 #define PIXEL00_0     *(Uint32 *)dst = c[5];
 #define PIXEL00_10    interp1((Uint32 *)dst, c[5], c[1]);
@@ -177,14 +214,17 @@ inline bool diff(unsigned int w1, unsigned int w2)
 #define PIXEL11_90    interp9((Uint32 *)(dst + dst_pitch + dst_Bpp), c[5], c[6], c[8]);
 #define PIXEL11_100   interp10((Uint32 *)(dst + dst_pitch + dst_Bpp), c[5], c[6], c[8]);
 
-void hq2x_32( SDL_Surface *src_surface, SDL_Surface *dst_surface )
+void hq2x_16( Uint8 *out, int out_pitch, const Uint8 *src, int src_pitch, const Uint16 *palette, int first_row, int last_row )
 {
-	/*
-	Uint8 *src = (Uint8 *)src_surface->pixels, *src_temp,
-	      *dst = (Uint8 *)dst_surface->pixels, *dst_temp;
-	int src_pitch = src_surface->pitch,
-	    dst_pitch = dst_surface->pitch;
-	const int dst_Bpp = 4;         // dst_surface->format->BytesPerPixel
+	const Uint8 *src_temp;
+	Uint8 *out_temp;
+	
+	// each source pixel is worked out in XRGB8888 in this block, which the
+	// PIXEL macros address through dst, and then packed down to RGB565
+	Uint32 block[2][2];
+	Uint8 *const dst = (Uint8 *)block;
+	const int dst_Bpp = 4,
+	          dst_pitch = 2 * dst_Bpp;
 	
 	const int height = vga_height, // src_surface->h
 	          width = vga_width;   // src_surface->w
@@ -205,13 +245,18 @@ void hq2x_32( SDL_Surface *src_surface, SDL_Surface *dst_surface )
 	//   | w7 | w8 | w9 |
 	//   +----+----+----+
 	
-	for (int j = 0; j < height; j++)
+	Uint32 colors[256], yuv[256];
+	hq_palette_tables(palette, colors, yuv);
+	
+	src += first_row * src_pitch;
+	
+	for (int j = first_row; j <= last_row; j++)
 	{
 		src_temp = src;
-		dst_temp = dst;
+		out_temp = out;
 		
-		prevline = (j > 0) ? -width : 0;
-		nextline = (j < height - 1) ? width : 0;
+		prevline = (j > 0) ? -src_pitch : 0;
+		nextline = (j < height - 1) ? src_pitch : 0;
 		
 		for (int i = 0; i < width; i++)
 		{
@@ -244,25 +289,17 @@ void hq2x_32( SDL_Surface *src_surface, SDL_Surface *dst_surface )
 			int pattern = 0;
 			int flag = 1;
 			
-			YUV1 = yuv_palette[w[5]];
-			
 			for (int k=1; k<=9; k++)
 			{
 				if (k==5) continue;
 				
-				if ( w[k] != w[5] )
-				{
-					YUV2 = yuv_palette[w[k]];
-					if ( ( abs((YUV1 & Ymask) - (YUV2 & Ymask)) > trY ) ||
-					     ( abs((YUV1 & Umask) - (YUV2 & Umask)) > trU ) ||
-					     ( abs((YUV1 & Vmask) - (YUV2 & Vmask)) > trV ) )
+				if (diff(w[5], w[k]))
 					pattern |= flag;
-				}
 				flag <<= 1;
 			}
 			
 			for (int k=1; k<=9; k++)
-				c[k] = rgb_palette[w[k]] & 0xfcfcfcfc; // hq2x has a nasty inability to accept more than 6 bits for each component
+				c[k] = colors[w[k]]; // hq2x has a nasty inability to accept more than 6 bits for each component
 			
 			switch (pattern)
 			{
@@ -2907,14 +2944,15 @@ void hq2x_32( SDL_Surface *src_surface, SDL_Surface *dst_surface )
 				}
 			}
 			
+			pack_block_rgb565(out, out_pitch, &block[0][0], 2);
+			
 			src++;
-			dst += 2 * dst_Bpp;
+			out += 2 * sizeof(Uint16);
 		}
 		
 		src = src_temp + src_pitch;
-		dst = dst_temp + 2 * dst_pitch;
+		out = out_temp + 2 * out_pitch;
 	}
-	*/
 }
 
 
@@ -2972,14 +3010,17 @@ void hq2x_32( SDL_Surface *src_surface, SDL_Surface *dst_surface )
 #define PIXEL22_5   interp5((Uint32 *)(dst + 2 * dst_pitch + 2 * dst_Bpp), c[6], c[8]);
 #define PIXEL22_C   *(Uint32 *)(dst + 2 * dst_pitch + 2 * dst_Bpp) = c[5];
 
-void hq3x_32( SDL_Surface *src_surface, SDL_Surface *dst_surface )
+void hq3x_16( Uint8 *out, int out_pitch, const Uint8 *src, int src_pitch, const Uint16 *palette, int first_row, int last_row )
 {
-	/*
-	Uint8 *src = src_surface->pixels, *src_temp,
-	      *dst = dst_surface->pixels, *dst_temp;
-	int src_pitch = src_surface->pitch,
-	    dst_pitch = dst_surface->pitch;
-	const int dst_Bpp = 4;         // dst_surface->format->BytesPerPixel
+	const Uint8 *src_temp;
+	Uint8 *out_temp;
+	
+	// each source pixel is worked out in XRGB8888 in this block, which the
+	// PIXEL macros address through dst, and then packed down to RGB565
+	Uint32 block[3][3];
+	Uint8 *const dst = (Uint8 *)block;
+	const int dst_Bpp = 4,
+	          dst_pitch = 3 * dst_Bpp;
 	
 	const int height = vga_height, // src_surface->h
 	          width = vga_width;   // src_surface->w
@@ -3000,13 +3041,18 @@ void hq3x_32( SDL_Surface *src_surface, SDL_Surface *dst_surface )
 	//   | w7 | w8 | w9 |
 	//   +----+----+----+
 	
-	for (int j = 0; j < height; j++)
+	Uint32 colors[256], yuv[256];
+	hq_palette_tables(palette, colors, yuv);
+	
+	src += first_row * src_pitch;
+	
+	for (int j = first_row; j <= last_row; j++)
 	{
 		src_temp = src;
-		dst_temp = dst;
+		out_temp = out;
 		
-		prevline = (j > 0) ? -width : 0;
-		nextline = (j < height - 1) ? width : 0;
+		prevline = (j > 0) ? -src_pitch : 0;
+		nextline = (j < height - 1) ? src_pitch : 0;
 		
 		for (int i = 0; i < width; i++)
 		{
@@ -3039,25 +3085,17 @@ void hq3x_32( SDL_Surface *src_surface, SDL_Surface *dst_surface )
 			int pattern = 0;
 			int flag = 1;
 			
-			YUV1 = yuv_palette[w[5]];
-			
 			for (int k=1; k<=9; k++)
 			{
 				if (k==5) continue;
 				
-				if ( w[k] != w[5] )
-				{
-					YUV2 = yuv_palette[w[k]];
-					if ( ( abs((YUV1 & Ymask) - (YUV2 & Ymask)) > trY ) ||
-					     ( abs((YUV1 & Umask) - (YUV2 & Umask)) > trU ) ||
-					     ( abs((YUV1 & Vmask) - (YUV2 & Vmask)) > trV ) )
+				if (diff(w[5], w[k]))
 					pattern |= flag;
-				}
 				flag <<= 1;
 			}
 			
 			for (int k=1; k<=9; k++)
-				c[k] = rgb_palette[w[k]] & 0xfcfcfcfc; // hq3x has a nasty inability to accept more than 6 bits for each component
+				c[k] = colors[w[k]]; // hq3x has a nasty inability to accept more than 6 bits for each component
 			
 			switch (pattern)
 			{
@@ -6675,14 +6713,15 @@ void hq3x_32( SDL_Surface *src_surface, SDL_Surface *dst_surface )
 				}
 			}
 			
+			pack_block_rgb565(out, out_pitch, &block[0][0], 3);
+			
 			src++;
-			dst += 3 * dst_Bpp;
+			out += 3 * sizeof(Uint16);
 		}
 		
 		src = src_temp + src_pitch;
-		dst = dst_temp + 3 * dst_pitch;
+		out = out_temp + 3 * out_pitch;
 	}
-	*/
 }
 
 
@@ -6827,14 +6866,17 @@ void hq3x_32( SDL_Surface *src_surface, SDL_Surface *dst_surface )
 #define PIXEL4_33_81    interp8((Uint32 *)(dst + 3 * dst_pitch + 3 * dst_Bpp), c[5], c[6]);
 #define PIXEL4_33_82    interp8((Uint32 *)(dst + 3 * dst_pitch + 3 * dst_Bpp), c[5], c[8]);
 
-void hq4x_32( SDL_Surface *src_surface, SDL_Surface *dst_surface )
+void hq4x_16( Uint8 *out, int out_pitch, const Uint8 *src, int src_pitch, const Uint16 *palette, int first_row, int last_row )
 {
-	/*
-	Uint8 *src = src_surface->pixels, *src_temp,
-	      *dst = dst_surface->pixels, *dst_temp;
-	int src_pitch = src_surface->pitch,
-	    dst_pitch = dst_surface->pitch;
-	const int dst_Bpp = 4;         // dst_surface->format->BytesPerPixel
+	const Uint8 *src_temp;
+	Uint8 *out_temp;
+	
+	// each source pixel is worked out in XRGB8888 in this block, which the
+	// PIXEL macros address through dst, and then packed down to RGB565
+	Uint32 block[4][4];
+	Uint8 *const dst = (Uint8 *)block;
+	const int dst_Bpp = 4,
+	          dst_pitch = 4 * dst_Bpp;
 	
 	const int height = vga_height, // src_surface->h
 	          width = vga_width;   // src_surface->w
@@ -6855,13 +6897,18 @@ void hq4x_32( SDL_Surface *src_surface, SDL_Surface *dst_surface )
 	//   | w7 | w8 | w9 |
 	//   +----+----+----+
 	
-	for (int j = 0; j < height; j++)
+	Uint32 colors[256], yuv[256];
+	hq_palette_tables(palette, colors, yuv);
+	
+	src += first_row * src_pitch;
+	
+	for (int j = first_row; j <= last_row; j++)
 	{
 		src_temp = src;
-		dst_temp = dst;
+		out_temp = out;
 		
-		prevline = (j > 0) ? -width : 0;
-		nextline = (j < height - 1) ? width : 0;
+		prevline = (j > 0) ? -src_pitch : 0;
+		nextline = (j < height - 1) ? src_pitch : 0;
 		
 		for (int i = 0; i < width; i++)
 		{
@@ -6894,25 +6941,17 @@ void hq4x_32( SDL_Surface *src_surface, SDL_Surface *dst_surface )
 			int pattern = 0;
 			int flag = 1;
 			
-			YUV1 = yuv_palette[w[5]];
-			
 			for (int k=1; k<=9; k++)
 			{
 				if (k==5) continue;
 				
-				if ( w[k] != w[5] )
-				{
-					YUV2 = yuv_palette[w[k]];
-					if ( ( abs((YUV1 & Ymask) - (YUV2 & Ymask)) > trY ) ||
-					     ( abs((YUV1 & Umask) - (YUV2 & Umask)) > trU ) ||
-					     ( abs((YUV1 & Vmask) - (YUV2 & Vmask)) > trV ) )
+				if (diff(w[5], w[k]))
 					pattern |= flag;
-				}
 				flag <<= 1;
 			}
 			
 			for (int k=1; k<=9; k++)
-				c[k] = rgb_palette[w[k]] & 0xfcfcfcfc; // hq4x has a nasty inability to accept more than 6 bits for each component
+				c[k] = colors[w[k]]; // hq4x has a nasty inability to accept more than 6 bits for each component
 			
 			switch (pattern)
 			{
@@ -11889,14 +11928,15 @@ void hq4x_32( SDL_Surface *src_surface, SDL_Surface *dst_surface )
 				}
 			}
 			
+			pack_block_rgb565(out, out_pitch, &block[0][0], 4);
+			
 			src++;
-			dst += 4 * dst_Bpp;
+			out += 4 * sizeof(Uint16);
 		}
 		
 		src = src_temp + src_pitch;
-		dst = dst_temp + 4 * dst_pitch;
+		out = out_temp + 4 * out_pitch;
 	}
-	*/
 }
 
 // kate: tab-width 4; vim: set noet:
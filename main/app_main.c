@@ -9,7 +9,14 @@
 #include <unistd.h>
 
 #include "freertos/FreeRTOS.h"
+#include "esp_pthread.h"
+#include "enemy_grid.h"
 #include "keyboard.h"
+#include "loudness.h"
+#include "nortsong.h"
+#include "scaler_jobs.h"
+#include "varz.h"
+#include "video.h"
 #include "SDL3/SDL_esp-idf.h"
 
 // Function to check and print memory usage
@@ -20,11 +27,88 @@ void check_memory_main() {
     printf("Available PSRAM: %zu, DRAM: %zu\n", free_psram, free_dram);
 }
 
-// Thread to periodically check memory usage
+// Function to print how many frames reached the display
+void check_frames_main() {
+    static Uint32 last_presented = 0, last_dropped = 0, last_unchanged = 0;
+    Uint32 presented, dropped, unchanged;
+    get_present_stats(&presented, &dropped, &unchanged);
+
+    printf("Frames presented: %lu, dropped: %lu, unchanged: %lu\n",
+           (unsigned long)(presented - last_presented), (unsigned long)(dropped - last_dropped),
+           (unsigned long)(unchanged - last_unchanged));
+
+    // only the changed rows go to the panel; compare with pushing them whole
+    static Uint32 last_pushed = 0, last_whole = 0;
+    Uint32 pushed, whole;
+    get_present_bytes(&pushed, &whole);
+
+    const Uint32 frames = presented - last_presented;
+    printf("Bytes pushed per frame: %lu, whole frames: %lu\n",
+           (unsigned long)(frames ? (pushed - last_pushed) / frames : 0),
+           (unsigned long)(frames ? (whole - last_whole) / frames : 0));
+
+    last_presented = presented;
+    last_dropped = dropped;
+    last_unchanged = unchanged;
+    last_pushed = pushed;
+    last_whole = whole;
+
+    // game ticks simulated against frames drawn; frame_step skips drawing
+    // when the game falls behind, so fewer frames than ticks means it is
+    static Uint32 last_sim_ticks = 0, last_render_frames = 0, last_sim_ms = 0;
+    Uint32 sim_ticks, render_frames, sim_ms;
+    get_frame_stats(&sim_ticks, &render_frames, &sim_ms);
+
+    printf("Game ticks: %lu, frames drawn: %lu, in %lu ms\n",
+           (unsigned long)(sim_ticks - last_sim_ticks), (unsigned long)(render_frames - last_render_frames),
+           (unsigned long)(sim_ms - last_sim_ms));
+    last_sim_ticks = sim_ticks;
+    last_render_frames = render_frames;
+    last_sim_ms = sim_ms;
+
+    // time each scaler band took this interval; uneven totals mean the
+    // bands are badly balanced between the cores
+    static Uint32 last_band_us[SCALER_BANDS];
+    Uint32 band_us[SCALER_BANDS];
+    get_scaler_band_stats(band_us);
+
+    for (unsigned int i = 0; i < SCALER_BANDS; i++) {
+        printf("Scaler band %u: %lu us\n", i, (unsigned long)(band_us[i] - last_band_us[i]));
+        last_band_us[i] = band_us[i];
+    }
+
+    // music the audio callback had to replace with silence
+    static Uint32 last_underruns = 0;
+    Uint32 underruns;
+    get_music_stats(&underruns);
+
+    printf("Music underruns: %lu\n", (unsigned long)(underruns - last_underruns));
+    last_underruns = underruns;
+
+    // shot/enemy pairs the collision grid let through, against a scan of
+    // every live enemy for every shot
+    static Uint32 last_pair_tests = 0, last_full_scan_tests = 0;
+    Uint32 pair_tests, full_scan_tests;
+    get_collision_stats(&pair_tests, &full_scan_tests);
+
+    printf("Collision pairs tested: %lu, full scan: %lu\n",
+           (unsigned long)(pair_tests - last_pair_tests), (unsigned long)(full_scan_tests - last_full_scan_tests));
+    last_pair_tests = pair_tests;
+    last_full_scan_tests = full_scan_tests;
+
+    // most slots each effect pool has held at once; one that reaches its
+    // size is dropping effects
+    printf("Pool high water: enemy shots %u/%u, explosions %u/%u, repeating explosions %u/%u, superpixels %u/%u\n",
+           enemyShotPool.high_water, enemyShotPool.size, explosionPool.high_water, explosionPool.size,
+           repExplosionPool.high_water, repExplosionPool.size, superpixelPool.high_water, superpixelPool.size);
+}
+
+// Thread to periodically check memory usage and frame counters
 void* memory_check_thread(void *args)
 {
     while (1) {
         check_memory_main();
+        check_frames_main();
         usleep(10000 * 1000);
     }
     return NULL;
@@ -86,6 +170,13 @@ void app_main(void) {
 
     pthread_t sdl_pthread, memory_check_pthread;
 
+    // Pin the game thread to core 0; the present task in video.c and the
+    // music task in loudness.c take the last core, and the scaler workers
+    // stay off this one
+    esp_pthread_cfg_t sdl_cfg = esp_pthread_get_default_config();
+    sdl_cfg.pin_to_core = 0;
+    esp_pthread_set_cfg(&sdl_cfg);
+
     // Initialize SDL thread
     pthread_attr_t sdl_attr;
     pthread_attr_init(&sdl_attr);
@@ -98,6 +189,10 @@ void app_main(void) {
     }
     pthread_detach(sdl_pthread);
 
+    // the remaining threads may run on any core
+    esp_pthread_cfg_t default_cfg = esp_pthread_get_default_config();
+    esp_pthread_set_cfg(&default_cfg);
+
     // Initialize memory check thread
     pthread_attr_t memory_attr;
     pthread_attr_init(&memory_attr);
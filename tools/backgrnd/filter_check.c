@@ -0,0 +1,353 @@
+/*
+ * OpenTyrian: A modern cross-platform port of Tyrian
+ * Copyright (C) 2007-2009  The OpenTyrian Development Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/*
+ * Golden-image check and timing for the smoothie filters in backgrnd.c,
+ * against the original one-pixel-at-a-time versions kept below:
+ *
+ *   cc -O2 -Itools/host -Icomponents/OpenTyrian -o filter_check \
+ *      tools/backgrnd/filter_check.c components/OpenTyrian/backgrnd.c \
+ *      components/OpenTyrian/palette_lut.c components/OpenTyrian/mtrand.c \
+ *      components/OpenTyrian/sprite.c components/OpenTyrian/file.c \
+ *      tools/host/sdl_headless.c
+ *
+ *   ./filter_check [-n trials]
+ *
+ * Every filter is run on random surfaces at several pitches, both into a
+ * separate surface and in place, and then in the chains JE_main builds when
+ * several smoothies are on (iced blur, lava, water and blur all writing
+ * game_screen, each after the first reading it too).  Any byte that differs
+ * from the reference fails the run.
+ */
+
+#include "backgrnd.h"
+#include "config.h"
+#include "mtrand.h"
+#include "video.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// the globals backgrnd.c and sprite.c (for get_blit_clip) link against,
+// which the game defines elsewhere
+SDL_Surface *VGAScreen;
+JE_boolean background2, explosionTransparent, filtrationAvail, filterFade, filterFadeStart;
+JE_shortint levelFilter, levelFilterNew, levelBrightness, levelBrightnessChg;
+JE_byte processorType;
+JE_boolean smoothies[9];
+
+void JE_tyrianHalt( JE_byte code )
+{
+	exit(code);
+}
+
+#define ROWS 200
+
+/* The filters as they were before they worked on four pixels at a time. */
+
+static void ref_lava_filter( SDL_Surface *dst, SDL_Surface *src )
+{
+	// assert(src->BitsPerPixel == 8 && dst->BitsPerPixel == 8);
+	
+	/* we don't need to check for over-reading the pixel surfaces since we only
+	 * read from the top 185+1 scanlines, and there should be 320 */
+	
+	const int dst_pitch = dst->pitch;
+	Uint8 *dst_pixel = (Uint8 *)dst->pixels + (185 * dst_pitch);
+	const Uint8 * const dst_pixel_ll = (Uint8 *)dst->pixels;  // lower limit
+	
+	const int src_pitch = src->pitch;
+	const Uint8 *src_pixel = (Uint8 *)src->pixels + (185 * src->pitch);
+	const Uint8 * const src_pixel_ll = (Uint8 *)src->pixels;  // lower limit
+	
+	int w = 320 * 185 - 1;
+	
+	for (int y = 185 - 1; y >= 0; --y)
+	{
+		dst_pixel -= (dst_pitch - 320);  // in case pitch is not 320
+		src_pixel -= (src_pitch - 320);  // in case pitch is not 320
+		
+		for (int x = 320 - 1; x >= 0; x -= 8)
+		{
+			int waver = abs(((w >> 9) & 0x0f) - 8) - 1;
+			w -= 8;
+			
+			for (int xi = 8 - 1; xi >= 0; --xi)
+			{
+				--dst_pixel;
+				--src_pixel;
+				
+				// value is average value of source pixel (2x), destination pixel above, and destination pixel below (all with waver)
+				// hue is red
+				Uint8 value = 0;
+				
+				if (src_pixel + waver >= src_pixel_ll)
+					value += (*(src_pixel + waver) & 0x0f) * 2;
+				value += *(dst_pixel + waver + dst_pitch) & 0x0f;
+				if (dst_pixel + waver - dst_pitch >= dst_pixel_ll)
+					value += *(dst_pixel + waver - dst_pitch) & 0x0f;
+				
+				*dst_pixel = (value / 4) | 0x70;
+			}
+		}
+	}
+}
+
+static void ref_water_filter( SDL_Surface *dst, SDL_Surface *src )
+{
+	// assert(src->BitsPerPixel == 8 && dst->BitsPerPixel == 8);
+	
+	Uint8 hue = smoothie_data[1] << 4;
+	
+	/* we don't need to check for over-reading the pixel surfaces since we only
+	 * read from the top 185+1 scanlines, and there should be 320 */
+	
+	const int dst_pitch = dst->pitch;
+	Uint8 *dst_pixel = (Uint8 *)dst->pixels + (185 * dst_pitch);
+	
+	const Uint8 *src_pixel = (Uint8 *)src->pixels + (185 * src->pitch);
+	
+	int w = 320 * 185 - 1;
+	
+	for (int y = 185 - 1; y >= 0; --y)
+	{
+		dst_pixel -= (dst_pitch - 320);  // in case pitch is not 320
+		src_pixel -= (src->pitch - 320);  // in case pitch is not 320
+		
+		for (int x = 320 - 1; x >= 0; x -= 8)
+		{
+			int waver = abs(((w >> 10) & 0x07) - 4) - 1;
+			w -= 8;
+			
+			for (int xi = 8 - 1; xi >= 0; --xi)
+			{
+				--dst_pixel;
+				--src_pixel;
+				
+				// pixel is copied from source if not blue
+				// otherwise, value is average of value of source pixel and destination pixel below (with waver)
+				if ((*src_pixel & 0x30) == 0)
+				{
+					*dst_pixel = *src_pixel;
+				}
+				else
+				{
+					Uint8 value = *src_pixel & 0x0f;
+					value += *(dst_pixel + waver + dst_pitch) & 0x0f;
+					*dst_pixel = (value / 2) | hue;
+				}
+			}
+		}
+	}
+}
+
+static void ref_iced_blur_filter( SDL_Surface *dst, SDL_Surface *src )
+{
+	// assert(src->BitsPerPixel == 8 && dst->BitsPerPixel == 8);
+	
+	Uint8 *dst_pixel = (Uint8 *)dst->pixels;
+	const Uint8 *src_pixel = (const Uint8 *)src->pixels;
+	
+	for (int y = 0; y < 184; ++y)
+	{
+		for (int x = 0; x < 320; ++x)
+		{
+			// value is average value of source pixel and destination pixel
+			// hue is icy blue
+			
+			const Uint8 value = (*src_pixel & 0x0f) + (*dst_pixel & 0x0f);
+			*dst_pixel = (value / 2) | 0x80;
+			
+			++dst_pixel;
+			++src_pixel;
+		}
+		
+		dst_pixel += (dst->pitch - 320);  // in case pitch is not 320
+		src_pixel += (src->pitch - 320);  // in case pitch is not 320
+	}
+}
+
+static void ref_blur_filter( SDL_Surface *dst, SDL_Surface *src )
+{
+	// assert(src->BitsPerPixel == 8 && dst->BitsPerPixel == 8);
+	
+	Uint8 *dst_pixel = (Uint8 *)dst->pixels;
+	const Uint8 *src_pixel = (const Uint8 *)src->pixels;
+	
+	for (int y = 0; y < 184; ++y)
+	{
+		for (int x = 0; x < 320; ++x)
+		{
+			// value is average value of source pixel and destination pixel
+			// hue is source pixel hue
+			
+			const Uint8 value = (*src_pixel & 0x0f) + (*dst_pixel & 0x0f);
+			*dst_pixel = (value / 2) | (*src_pixel & 0xf0);
+			
+			++dst_pixel;
+			++src_pixel;
+		}
+		
+		dst_pixel += (dst->pitch - 320);  // in case pitch is not 320
+		src_pixel += (src->pitch - 320);  // in case pitch is not 320
+	}
+}
+
+typedef void (*filter_fn)( SDL_Surface *dst, SDL_Surface *src );
+
+static const struct
+{
+	const char *name;
+	filter_fn test, ref;
+}
+filters[] =
+{
+	{ "lava",      lava_filter,      ref_lava_filter },
+	{ "water",     water_filter,     ref_water_filter },
+	{ "iced blur", iced_blur_filter, ref_iced_blur_filter },
+	{ "blur",      blur_filter,      ref_blur_filter },
+};
+
+#define FILTERS (sizeof(filters) / sizeof(*filters))
+
+static double now_seconds( void )
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static SDL_Surface make_surface( Uint8 *pixels, int pitch )
+{
+	return (SDL_Surface){ .format = SDL_PIXELFORMAT_INDEX8, .w = 320, .h = ROWS, .pitch = pitch, .pixels = pixels };
+}
+
+static void fill_random( Uint8 *pixels, size_t size )
+{
+	for (size_t i = 0; i < size; ++i)
+		pixels[i] = mt_rand();
+}
+
+static unsigned int count_mismatches( const Uint8 *a, const Uint8 *b, size_t size )
+{
+	unsigned int mismatches = 0;
+	for (size_t i = 0; i < size; ++i)
+		mismatches += a[i] != b[i];
+	return mismatches;
+}
+
+// Runs filter k (or, with chain set, every filter from k on, the way JE_main
+// chains them) both ways and reports any difference.
+static bool check( unsigned int k, bool in_place, bool chain, int pitch )
+{
+	static Uint8 src[ROWS * 352], test_dst[ROWS * 352], ref_dst[ROWS * 352];
+	const size_t size = ROWS * pitch;
+
+	fill_random(src, size);
+	fill_random(test_dst, size);
+	memcpy(ref_dst, in_place ? src : test_dst, size);
+	if (in_place)
+		memcpy(test_dst, src, size);
+	smoothie_data[1] = mt_rand() % 16;
+
+	SDL_Surface test_src_s = make_surface(in_place ? test_dst : src, pitch),
+	            ref_src_s = make_surface(in_place ? ref_dst : src, pitch),
+	            test_dst_s = make_surface(test_dst, pitch),
+	            ref_dst_s = make_surface(ref_dst, pitch);
+
+	for (unsigned int i = k; i < (chain ? FILTERS : k + 1); ++i)
+	{
+		filters[i].test(&test_dst_s, &test_src_s);
+		filters[i].ref(&ref_dst_s, &ref_src_s);
+
+		// the rest of the chain reads what the first filter wrote
+		test_src_s = test_dst_s;
+		ref_src_s = ref_dst_s;
+	}
+
+	const unsigned int mismatches = count_mismatches(test_dst, ref_dst, size);
+	if (mismatches != 0)
+		printf("FAIL %s%s, %s, pitch %d: %u pixels differ\n",
+		       filters[k].name, chain ? " chain" : "", in_place ? "in place" : "separate", pitch, mismatches);
+	return mismatches == 0;
+}
+
+static void time_filter( unsigned int k, bool in_place, unsigned int frames )
+{
+	static Uint8 src[ROWS * 320], dst[ROWS * 320];
+	fill_random(src, sizeof(src));
+	fill_random(dst, sizeof(dst));
+	SDL_Surface src_s = make_surface(in_place ? dst : src, 320),
+	            dst_s = make_surface(dst, 320);
+
+	double seconds[2];
+	for (int which = 0; which < 2; ++which)
+	{
+		const filter_fn fn = which == 0 ? filters[k].test : filters[k].ref;
+		const double start = now_seconds();
+		for (unsigned int i = 0; i < frames; ++i)
+			fn(&dst_s, &src_s);
+		seconds[which] = now_seconds() - start;
+	}
+
+	printf("%-9s %-8s %8.2f us/frame (reference %8.2f, %.2fx)\n", filters[k].name, in_place ? "in place" : "separate",
+	       seconds[0] * 1e6 / frames, seconds[1] * 1e6 / frames, seconds[1] / seconds[0]);
+}
+
+int main( int argc, char *argv[] )
+{
+	unsigned int trials = 200;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+			trials = (unsigned int)atoi(argv[++i]);
+		else
+		{
+			fprintf(stderr, "usage: %s [-n trials]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	mt_srand(1);
+
+	static const int pitches[] = { 320, 324, 336, 352 };
+	unsigned int failed = 0, checked = 0;
+	for (unsigned int k = 0; k < FILTERS; ++k)
+		for (unsigned int p = 0; p < sizeof(pitches) / sizeof(*pitches); ++p)
+			for (unsigned int t = 0; t < trials; ++t)
+				for (int mode = 0; mode < 3; ++mode)
+				{
+					// separate, in place, and the chain starting here
+					failed += !check(k, mode != 0, mode == 2, pitches[p]);
+					checked++;
+				}
+
+	printf("%u of %u filter runs match the reference\n", checked - failed, checked);
+
+	for (unsigned int k = 0; k < FILTERS; ++k)
+	{
+		time_filter(k, false, 2000);
+		time_filter(k, true, 2000);
+	}
+
+	return failed != 0;
+}
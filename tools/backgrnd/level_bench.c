@@ -0,0 +1,635 @@
+/*
+ * OpenTyrian: A modern cross-platform port of Tyrian
+ * Copyright (C) 2007-2009  The OpenTyrian Development Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/*
+ * Background drawing throughput for every level in data/tyrian, with the
+ * per-tile transparency masks (and strip cache, unless built with
+ * -DBACKGROUND_CACHE=0) against the original per-pixel blitters kept below:
+ *
+ *   cc -O2 -Itools/host -Icomponents/OpenTyrian -o level_bench \
+ *      tools/backgrnd/level_bench.c components/OpenTyrian/backgrnd.c \
+ *      components/OpenTyrian/palette_lut.c components/OpenTyrian/mtrand.c \
+ *      components/OpenTyrian/sprite.c components/OpenTyrian/file.c \
+ *      tools/host/sdl_headless.c
+ *
+ *   ./level_bench [-d data_dir] [-f frames]
+ *
+ * Each level's three maps are loaded the way JE_loadMap does it and scrolled
+ * from the bottom at the usual 1/2/3 pixels per frame, while the parallax
+ * offsets sweep as if the player flew from one side of the screen to the
+ * other.  A frame draws background 1, 2 (or 2 blended) and 3, and is
+ * compared byte for byte against the same frame from the reference; any
+ * difference fails the run.  Pixels/s counts the 288x200 area each of the
+ * three layers covers.
+ */
+
+#include "backgrnd.h"
+#include "config.h"
+#include "video.h"
+
+#include <ctype.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// the globals backgrnd.c and sprite.c (for get_blit_clip) link against,
+// which the game defines elsewhere
+SDL_Surface *VGAScreen;
+JE_boolean background2, explosionTransparent, filtrationAvail, filterFade, filterFadeStart;
+JE_shortint levelFilter, levelFilterNew, levelBrightness, levelBrightnessChg;
+JE_byte processorType;
+JE_boolean smoothies[9];
+
+void JE_tyrianHalt( JE_byte code )
+{
+	exit(code);
+}
+
+struct JE_MegaDataType1 megaData1;
+struct JE_MegaDataType2 megaData2;
+struct JE_MegaDataType3 megaData3;
+
+#define LAYER_PIXELS (12 * 24 * 200)
+
+/* The blitters as they were before the tile masks. */
+
+static void ref_blit_background_row( SDL_Surface *surface, int x, int y, Uint8 **map )
+{
+	Uint8 *pixels = (Uint8 *)surface->pixels + (y * surface->pitch) + x,
+	      *pixels_ll = (Uint8 *)surface->pixels,  // lower limit
+	      *pixels_ul = (Uint8 *)surface->pixels + (surface->h * surface->pitch);  // upper limit
+
+	for (int y = 0; y < 28; y++)
+	{
+		// not drawing on screen yet; skip y
+		if ((pixels + (12 * 24)) < pixels_ll)
+		{
+			pixels += surface->pitch;
+			continue;
+		}
+
+		for (int tile = 0; tile < 12; tile++)
+		{
+			Uint8 *data = *(map + tile);
+
+			// no tile; skip tile
+			if (data == NULL)
+			{
+				pixels += 24;
+				continue;
+			}
+
+			data += y * 24;
+
+			for (int x = 24; x; x--)
+			{
+				if (pixels >= pixels_ul)
+					return;
+				if (pixels >= pixels_ll && *data != 0)
+					*pixels = *data;
+
+				pixels++;
+				data++;
+			}
+		}
+
+		pixels += surface->pitch - 12 * 24;
+	}
+}
+
+static void ref_blit_background_row_blend( SDL_Surface *surface, int x, int y, Uint8 **map )
+{
+	Uint8 *pixels = (Uint8 *)surface->pixels + (y * surface->pitch) + x,
+	      *pixels_ll = (Uint8 *)surface->pixels,  // lower limit
+	      *pixels_ul = (Uint8 *)surface->pixels + (surface->h * surface->pitch);  // upper limit
+
+	for (int y = 0; y < 28; y++)
+	{
+		// not drawing on screen yet; skip y
+		if ((pixels + (12 * 24)) < pixels_ll)
+		{
+			pixels += surface->pitch;
+			continue;
+		}
+
+		for (int tile = 0; tile < 12; tile++)
+		{
+			Uint8 *data = *(map + tile);
+
+			// no tile; skip tile
+			if (data == NULL)
+			{
+				pixels += 24;
+				continue;
+			}
+
+			data += y * 24;
+
+			for (int x = 24; x; x--)
+			{
+				if (pixels >= pixels_ul)
+					return;
+				if (pixels >= pixels_ll && *data != 0)
+					*pixels = (*data & 0xf0) | (((*pixels & 0x0f) + (*data & 0x0f)) / 2);
+
+				pixels++;
+				data++;
+			}
+		}
+
+		pixels += surface->pitch - 12 * 24;
+	}
+}
+
+static void ref_draw_background_1( SDL_Surface *surface )
+{
+	SDL_FillSurfaceRect(surface, NULL, 0);
+
+	Uint8 **map = (Uint8 **)mapYPos + mapXbpPos - 12;
+
+	for (int i = -1; i < 7; i++)
+	{
+		ref_blit_background_row(surface, mapXPos, (i * 28) + backPos, map);
+
+		map += 14;
+	}
+}
+
+static void ref_draw_background_2( SDL_Surface *surface )
+{
+	if (map2YDelayMax > 1 && backMove2 < 2)
+		backMove2 = (map2YDelay == 1) ? 1 : 0;
+
+	if (background2 != 0)
+	{
+		// water effect combines background 1 and 2 by syncronizing the x coordinate
+		int x = smoothies[1] ? mapXPos : mapX2Pos;
+
+		Uint8 **map = (Uint8 **)mapY2Pos + (smoothies[1] ? mapXbpPos : mapX2bpPos) - 12;
+
+		for (int i = -1; i < 7; i++)
+		{
+			ref_blit_background_row(surface, x, (i * 28) + backPos2, map);
+
+			map += 14;
+		}
+	}
+
+	/*Set Movement of background*/
+	if (--map2YDelay == 0)
+	{
+		map2YDelay = map2YDelayMax;
+
+		backPos2 += backMove2;
+
+		if (backPos2 >  27)
+		{
+			backPos2 -= 28;
+			mapY2--;
+			mapY2Pos -= 14;  /*Map Width*/
+		}
+	}
+}
+
+static void ref_draw_background_2_blend( SDL_Surface *surface )
+{
+	if (map2YDelayMax > 1 && backMove2 < 2)
+		backMove2 = (map2YDelay == 1) ? 1 : 0;
+
+	Uint8 **map = (Uint8 **)mapY2Pos + mapX2bpPos - 12;
+
+	for (int i = -1; i < 7; i++)
+	{
+		ref_blit_background_row_blend(surface, mapX2Pos, (i * 28) + backPos2, map);
+
+		map += 14;
+	}
+
+	/*Set Movement of background*/
+	if (--map2YDelay == 0)
+	{
+		map2YDelay = map2YDelayMax;
+
+		backPos2 += backMove2;
+
+		if (backPos2 >  27)
+		{
+			backPos2 -= 28;
+			mapY2--;
+			mapY2Pos -= 14;  /*Map Width*/
+		}
+	}
+}
+
+static void ref_draw_background_3( SDL_Surface *surface )
+{
+	/* Movement of background */
+	backPos3 += backMove3;
+
+	if (backPos3 > 27)
+	{
+		backPos3 -= 28;
+		mapY3--;
+		mapY3Pos -= 15;   /*Map Width*/
+	}
+
+	Uint8 **map = (Uint8 **)mapY3Pos + mapX3bpPos - 12;
+
+	for (int i = -1; i < 7; i++)
+	{
+		ref_blit_background_row(surface, mapX3Pos, (i * 28) + backPos3, map);
+
+		map += 15;
+	}
+}
+
+/* Level loading, following the map part of JE_loadMap. */
+
+static Uint16 read_le16( FILE *f )
+{
+	Uint8 b[2] = { 0, 0 };
+	if (fread(b, 1, 2, f) != 2)
+		return 0;
+	return b[0] | (b[1] << 8);
+}
+
+static Uint32 read_le32( FILE *f )
+{
+	Uint8 b[4] = { 0, 0, 0, 0 };
+	if (fread(b, 1, 4, f) != 4)
+		return 0;
+	return b[0] | (b[1] << 8) | (b[2] << 16) | ((Uint32)b[3] << 24);
+}
+
+static FILE *open_data( const char *dir, const char *name )
+{
+	char path[512];
+	snprintf(path, sizeof(path), "%s/%s", dir, name);
+	return fopen(path, "rb");
+}
+
+static bool load_level( const char *dir, FILE *level_f, long pos )
+{
+	fseek(level_f, pos, SEEK_SET);
+
+	fgetc(level_f); // char_mapFile
+	const int char_shapeFile = fgetc(level_f);
+	fseek(level_f, 3 * 2, SEEK_CUR);  // mapX, mapX2, mapX3
+
+	const Uint16 enemies = read_le16(level_f);
+	fseek(level_f, enemies * 2, SEEK_CUR);
+
+	const Uint16 events = read_le16(level_f);
+	fseek(level_f, events * 11, SEEK_CUR);
+
+	// the shape lookup table is big-endian, unlike the rest of the file
+	Uint16 mapSh[3][128];
+	Uint8 raw[sizeof(mapSh)];
+	if (fread(raw, 1, sizeof(raw), level_f) != sizeof(raw))
+		return false;
+	for (int i = 0; i < 3 * 128; ++i)
+		(&mapSh[0][0])[i] = (raw[i * 2] << 8) | raw[i * 2 + 1];
+
+	Uint8 *ref[3][128];
+	memset(ref, 0, sizeof(ref));
+
+	char name[32];
+	snprintf(name, sizeof(name), "shapes%c.dat", tolower(char_shapeFile));
+	FILE *shpFile = open_data(dir, name);
+	if (shpFile == NULL)
+	{
+		fprintf(stderr, "error: could not open %s\n", name);
+		return false;
+	}
+
+	JE_DanCShape shape;
+	for (int z = 0; z < 600; z++)
+	{
+		const int shapeBlank = fgetc(shpFile);
+
+		if (shapeBlank)
+			memset(shape, 0, sizeof(shape));
+		else if (fread(shape, 1, sizeof(shape), shpFile) != sizeof(shape))
+			break;
+
+		for (int x = 0; x <= 71; ++x)
+		{
+			if (mapSh[0][x] == z+1)
+			{
+				memcpy(megaData1.shapes[x].sh, shape, sizeof(JE_DanCShape));
+				init_tile_info(&megaData1.shapes[x].info, (const Uint8 *)megaData1.shapes[x].sh);
+				ref[0][x] = (Uint8 *)megaData1.shapes[x].sh;
+			}
+			if (mapSh[1][x] == z+1)
+			{
+				if (x != 71 && !shapeBlank)
+				{
+					memcpy(megaData2.shapes[x].sh, shape, sizeof(JE_DanCShape));
+					init_tile_info(&megaData2.shapes[x].info, (const Uint8 *)megaData2.shapes[x].sh);
+					ref[1][x] = (Uint8 *)megaData2.shapes[x].sh;
+				}
+				else
+				{
+					ref[1][x] = NULL;
+				}
+			}
+			if (mapSh[2][x] == z+1)
+			{
+				if (x < 70 && !shapeBlank)
+				{
+					memcpy(megaData3.shapes[x].sh, shape, sizeof(JE_DanCShape));
+					init_tile_info(&megaData3.shapes[x].info, (const Uint8 *)megaData3.shapes[x].sh);
+					ref[2][x] = (Uint8 *)megaData3.shapes[x].sh;
+				}
+				else
+				{
+					ref[2][x] = NULL;
+				}
+			}
+		}
+	}
+	fclose(shpFile);
+
+	static Uint8 mapBuf[15 * 600];
+
+	if (fread(mapBuf, 1, 14 * 300, level_f) != 14 * 300)
+		return false;
+	for (int i = 0; i < 14 * 300; i++)
+		(&megaData1.mainmap[0][0])[i] = ref[0][mapBuf[i]];
+
+	if (fread(mapBuf, 1, 14 * 600, level_f) != 14 * 600)
+		return false;
+	for (int i = 0; i < 14 * 600; i++)
+		(&megaData2.mainmap[0][0])[i] = ref[1][mapBuf[i]];
+
+	if (fread(mapBuf, 1, 15 * 600, level_f) != 15 * 600)
+		return false;
+	for (int i = 0; i < 15 * 600; i++)
+		(&megaData3.mainmap[0][0])[i] = ref[2][mapBuf[i]];
+
+	invalidate_background_cache();
+	return true;
+}
+
+/* Scrolling, as JE_main and JE_mainGamePlayerFunctions drive it. */
+
+typedef struct
+{
+	JE_word backPos, backPos2, backPos3, backMove2;
+	JE_word mapY, mapY2, mapY3;
+	JE_byte **mapYPos, **mapY2Pos, **mapY3Pos;
+	JE_byte map1YDelay, map2YDelay;
+}
+ScrollState;
+
+static void save_scroll( ScrollState *s )
+{
+	*s = (ScrollState){ backPos, backPos2, backPos3, backMove2, mapY, mapY2, mapY3,
+	                    mapYPos, mapY2Pos, mapY3Pos, map1YDelay, map2YDelay };
+}
+
+static void restore_scroll( const ScrollState *s )
+{
+	backPos = s->backPos;  backPos2 = s->backPos2;  backPos3 = s->backPos3;
+	backMove2 = s->backMove2;
+	mapY = s->mapY;  mapY2 = s->mapY2;  mapY3 = s->mapY3;
+	mapYPos = s->mapYPos;  mapY2Pos = s->mapY2Pos;  mapY3Pos = s->mapY3Pos;
+	map1YDelay = s->map1YDelay;  map2YDelay = s->map2YDelay;
+}
+
+static void start_scroll( void )
+{
+	mapY = 300 - 8;
+	mapY2 = 600 - 8;
+	mapY3 = 600 - 8;
+	mapYPos = &megaData1.mainmap[mapY][0] - 1;
+	mapY2Pos = &megaData2.mainmap[mapY2][0] - 1;
+	mapY3Pos = &megaData3.mainmap[mapY3][0] - 1;
+
+	map1YDelay = map1YDelayMax = 1;
+	map2YDelay = map2YDelayMax = 1;
+	backPos = backPos2 = backPos3 = 0;
+	backMove = 1;
+	backMove2 = 2;
+	backMove3 = 3;
+}
+
+static void set_parallax( unsigned int frame )
+{
+	// fly across the screen and back every 448 frames
+	const int sweep = frame % 448;
+	const float tempX = 36 + (sweep < 224 ? sweep : 448 - sweep);
+
+	const int tempW = floorf((260.0f - (tempX - 36.0f)) / (260.0f - 36.0f) * (24.0f * 3.0f) - 1.0f);
+	mapX3Ofs   = tempW;
+	mapX3Pos   = mapX3Ofs % 24;
+	mapX3bpPos = 1 - (mapX3Ofs / 24);
+
+	mapX2Ofs   = (tempW * 2) / 3;
+	mapX2Pos   = mapX2Ofs % 24;
+	mapX2bpPos = 1 - (mapX2Ofs / 24);
+
+	mapXOfs    = mapX2Ofs / 2;
+	mapXPos    = mapXOfs % 24;
+	mapXbpPos  = 1 - (mapXOfs / 24);
+}
+
+static void advance_background_1( void )
+{
+	if (--map1YDelay == 0)
+	{
+		map1YDelay = map1YDelayMax;
+
+		backPos += backMove;
+
+		if (backPos > 27)
+		{
+			backPos -= 28;
+			mapY--;
+			mapYPos -= 14;  /*Map Width*/
+		}
+	}
+}
+
+static void draw_frame( SDL_Surface *surface, unsigned int frame, bool reference, bool blend )
+{
+	set_parallax(frame);
+
+	if (reference)
+	{
+		ref_draw_background_1(surface);
+		if (blend)
+			ref_draw_background_2_blend(surface);
+		else
+			ref_draw_background_2(surface);
+		ref_draw_background_3(surface);
+	}
+	else
+	{
+		draw_background_1(surface);
+		if (blend)
+			draw_background_2_blend(surface);
+		else
+			draw_background_2(surface);
+		draw_background_3(surface);
+	}
+
+	advance_background_1();
+}
+
+static double now( void )
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Scrolls the whole level once per blitter and returns the seconds taken.
+static double time_level( SDL_Surface *surface, unsigned int frames, bool reference, bool blend )
+{
+	start_scroll();
+
+	const double start = now();
+	for (unsigned int frame = 0; frame < frames; ++frame)
+		draw_frame(surface, frame, reference, blend);
+	return now() - start;
+}
+
+// Draws every frame with both blitters and returns the number that differ.
+static unsigned int check_level( SDL_Surface *surface, SDL_Surface *ref_surface, unsigned int frames, bool blend )
+{
+	unsigned int mismatches = 0;
+
+	start_scroll();
+
+	for (unsigned int frame = 0; frame < frames; ++frame)
+	{
+		ScrollState before, after;
+		save_scroll(&before);
+
+		draw_frame(surface, frame, false, blend);
+		save_scroll(&after);
+
+		restore_scroll(&before);
+		draw_frame(ref_surface, frame, true, blend);
+
+		if (memcmp(surface->pixels, ref_surface->pixels, surface->pitch * surface->h) != 0)
+			mismatches++;
+
+		restore_scroll(&after);
+	}
+
+	return mismatches;
+}
+
+int main( int argc, char *argv[] )
+{
+	const char *dir = "data/tyrian/data";
+	unsigned int max_frames = 0;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		if (strcmp(argv[i], "-d") == 0 && i + 1 < argc)
+			dir = argv[++i];
+		else if (strcmp(argv[i], "-f") == 0 && i + 1 < argc)
+			max_frames = (unsigned int)atoi(argv[++i]);
+		else
+		{
+			fprintf(stderr, "usage: %s [-d data_dir] [-f frames]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	SDL_Surface *surface = SDL_CreateSurface(320, 200, SDL_PIXELFORMAT_INDEX8),
+	            *ref_surface = SDL_CreateSurface(320, 200, SDL_PIXELFORMAT_INDEX8);
+	VGAScreen = surface;
+	background2 = true;
+
+	// background 3 moves fastest and runs out of map first; stop a row short
+	unsigned int frames = (600 - 8 - 1) * 28 / 3;
+	if (max_frames != 0 && max_frames < frames)
+		frames = max_frames;
+
+	unsigned int levels = 0, failed = 0;
+	double total[2][2] = { { 0, 0 }, { 0, 0 } };  // [blend][reference]
+
+	printf("%-13s %8s %12s %12s %12s %12s\n", "level", "frames",
+	       "ref Mpx/s", "Mpx/s", "ref blend", "blend");
+
+	for (int episode = 1; episode <= 4; ++episode)
+	{
+		char name[32];
+		snprintf(name, sizeof(name), "tyrian%d.lvl", episode);
+		FILE *level_f = open_data(dir, name);
+		if (level_f == NULL)
+		{
+			fprintf(stderr, "error: could not open %s/%s\n", dir, name);
+			return 1;
+		}
+
+		const Uint16 lvlNum = read_le16(level_f);
+		long lvlPos[lvlNum];
+		for (int i = 0; i < lvlNum; ++i)
+			lvlPos[i] = read_le32(level_f);
+
+		// each level is followed by its script section; the maps are in the first
+		for (int lvl = 0; lvl < lvlNum / 2; ++lvl)
+		{
+			if (!load_level(dir, level_f, lvlPos[lvl * 2]))
+			{
+				fprintf(stderr, "error: could not load level %d of %s\n", lvl + 1, name);
+				failed++;
+				continue;
+			}
+
+			double seconds[2][2];
+			unsigned int mismatches = 0;
+			for (int blend = 0; blend < 2; ++blend)
+			{
+				mismatches += check_level(surface, ref_surface, frames, blend);
+				for (int reference = 0; reference < 2; ++reference)
+				{
+					seconds[blend][reference] = time_level(surface, frames, reference, blend);
+					total[blend][reference] += seconds[blend][reference];
+				}
+			}
+
+			const double pixels = (double)frames * 3 * LAYER_PIXELS / 1e6;
+			printf("%s:%-6d %8u %12.1f %12.1f %12.1f %12.1f%s\n", name, lvl + 1, frames,
+			       pixels / seconds[0][1], pixels / seconds[0][0],
+			       pixels / seconds[1][1], pixels / seconds[1][0],
+			       mismatches ? "  MISMATCH" : "");
+
+			levels++;
+			failed += mismatches != 0;
+		}
+
+		fclose(level_f);
+	}
+
+	const double pixels = (double)levels * frames * 3 * LAYER_PIXELS / 1e6;
+	printf("%-13s %8u %12.1f %12.1f %12.1f %12.1f\n", "all", levels * frames,
+	       pixels / total[0][1], pixels / total[0][0],
+	       pixels / total[1][1], pixels / total[1][0]);
+	printf("%u of %u levels match the reference\n", levels - failed, levels);
+
+	return failed != 0 || levels == 0;
+}
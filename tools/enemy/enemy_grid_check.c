@@ -0,0 +1,345 @@
+/*
+ * OpenTyrian: A modern cross-platform port of Tyrian
+ * Copyright (C) 2007-2009  The OpenTyrian Development Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/*
+ * A check that the enemy_grid.c queries made by the player shot loop in
+ * tyrian2.c return every enemy its exact tests accept, and the cost of the
+ * loop with and without the grid:
+ *
+ *   cc -O2 -Itools/host -Icomponents/OpenTyrian -o enemy_grid_check \
+ *      tools/enemy/enemy_grid_check.c components/OpenTyrian/enemy_grid.c
+ *
+ *   ./enemy_grid_check [-n frames] [-f frames] [-r rounds]
+ *
+ * Each of -n random frames places live enemies anywhere on and around the
+ * playfield, builds the grid and fires normal, special and zinglon shots,
+ * most of them close to an enemy so that the tests' edges are reached.
+ * Partway through some shots a free slot ahead of the scan is made live and
+ * added, as a kill that spawns an enemy does.  Every enemy the exact tests
+ * accept in a scan of every slot must come out of the query, in slot order;
+ * a miss fails the run.
+ *
+ * The timing runs -f frames of shots through the grid and through a scan of
+ * every live slot, interleaved, and reports us per frame, the best of -r
+ * rounds, with the pairs each way tested per frame.
+ */
+
+#include "enemy_grid.h"
+#include "varz.h"
+
+#include <limits.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// the parts of varz.c that enemy_grid.c uses
+JE_MultiEnemyType enemy;
+JE_EnemyAvailType enemyAvail;
+
+#define SHOTS_PER_FRAME 40
+
+typedef enum { HIT_NORMAL, HIT_SPECIAL, HIT_ZINGLON } hit_kind;
+
+typedef struct
+{
+	hit_kind kind;
+	int x, y;                    // tempShotX, tempShotY; the player's x for the zinglon
+	JE_word x2, y2;              // tempX2, tempY2 of a special shot
+	int zinglon_duration;
+} shot_type;
+
+static shot_type shots[SHOTS_PER_FRAME];
+
+static uint32_t lcg_state = 0x2545f491;
+
+static uint32_t lcg( void )
+{
+	lcg_state = lcg_state * 1103515245 + 12345;
+	return lcg_state >> 8;
+}
+
+static int lcg_range( int lo, int hi )
+{
+	return lo + (int)(lcg() % (uint32_t)(hi - lo + 1));
+}
+
+static double now_seconds( void )
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void place_enemy( unsigned int b )
+{
+	enemyAvail[b] = 0;
+	enemy[b].mapoffset = (JE_word)lcg_range(0, 60);
+	enemy[b].ex = (JE_integer)(lcg_range(-120, 420) - enemy[b].mapoffset);
+	enemy[b].ey = (JE_integer)lcg_range(-120, 320);
+	enemy[b].enemycycle = (lcg() % 2 == 0) ? 0 : (JE_byte)lcg_range(1, 4);
+}
+
+static void random_enemies( void )
+{
+	const unsigned int live_percent = lcg_range(5, 90);
+
+	for (unsigned int b = 0; b < COUNTOF(enemy); ++b)
+	{
+		if (lcg() % 100 < live_percent)
+			place_enemy(b);
+		else
+			enemyAvail[b] = (lcg() % 4 == 0) ? 2 : 1;  // 2 is a slot the game holds but does not hit
+	}
+}
+
+static void random_shots( void )
+{
+	for (unsigned int i = 0; i < SHOTS_PER_FRAME; ++i)
+	{
+		shot_type *shot = &shots[i];
+		const unsigned int kind = lcg() % 8;
+		shot->kind = (kind == 0) ? HIT_ZINGLON : (kind < 3) ? HIT_SPECIAL : HIT_NORMAL;
+		shot->x2 = (shot->kind == HIT_SPECIAL) ? (JE_word)lcg_range(0, 40) : 0;
+		shot->y2 = (shot->kind == HIT_SPECIAL) ? (JE_word)lcg_range(0, 40) : 0;
+		shot->zinglon_duration = lcg_range(0, 50);
+
+		// mostly next to a live enemy, so hits and near misses both happen
+		const unsigned int b = lcg() % COUNTOF(enemy);
+		if (enemyAvail[b] == 0 && lcg() % 4 != 0)
+		{
+			shot->x = enemy[b].ex + enemy[b].mapoffset + lcg_range(-50 - 2 * shot->x2, 50);
+			shot->y = enemy[b].ey + lcg_range(-50 - 2 * shot->y2, 50);
+		}
+		else
+		{
+			shot->x = lcg_range(-60, 380);
+			shot->y = lcg_range(-60, 260);
+		}
+	}
+}
+
+// the grid query tyrian2.c makes for a shot
+static void query_shot( const shot_type *shot )
+{
+	if (shot->kind == HIT_ZINGLON)
+	{
+		const int reach = 25 - abs(shot->zinglon_duration - 25);
+		enemy_grid_query(shot->x + 7 - reach, INT_MIN, shot->x + 7 + reach, INT_MAX);
+	}
+	else if (shot->kind == HIT_SPECIAL)
+	{
+		enemy_grid_query(shot->x - 24, shot->y - 16, shot->x + 2 * shot->x2 + 24, shot->y + 2 * shot->y2 + 40);
+	}
+	else
+	{
+		enemy_grid_query(shot->x - 24, shot->y - 16, shot->x + 24, shot->y + 40);
+	}
+}
+
+// the exact tests of tyrian2.c's player shot loop
+static bool collides( const shot_type *shot, unsigned int b )
+{
+	const int tempShotX = shot->x, tempShotY = shot->y;
+	const JE_word tempX2 = shot->x2, tempY2 = shot->y2;
+
+	if (shot->kind == HIT_ZINGLON)
+	{
+		const int temp = 25 - abs(shot->zinglon_duration - 25);
+		return abs(enemy[b].ex + enemy[b].mapoffset - (shot->x + 7)) < temp;
+	}
+	else if (shot->kind == HIT_SPECIAL)
+	{
+		return ((enemy[b].enemycycle == 0) &&
+		        (abs(enemy[b].ex + enemy[b].mapoffset - tempShotX - tempX2) < (25 + tempX2)) &&
+		        (abs(enemy[b].ey - tempShotY - 12 - tempY2)                 < (29 + tempY2))) ||
+		       ((enemy[b].enemycycle > 0) &&
+		        (abs(enemy[b].ex + enemy[b].mapoffset - tempShotX - tempX2) < (13 + tempX2)) &&
+		        (abs(enemy[b].ey - tempShotY - 6 - tempY2)                  < (15 + tempY2)));
+	}
+	else
+	{
+		return ((enemy[b].enemycycle == 0) &&
+		        (abs(enemy[b].ex + enemy[b].mapoffset - tempShotX) < 25) && (abs(enemy[b].ey - tempShotY - 12) < 29)) ||
+		       ((enemy[b].enemycycle > 0) &&
+		        (abs(enemy[b].ex + enemy[b].mapoffset - tempShotX) < 13) && (abs(enemy[b].ey - tempShotY - 6) < 15));
+	}
+}
+
+// a free slot after b, or -1
+static int free_slot_after( int b )
+{
+	for (unsigned int i = b + 1; i < COUNTOF(enemy); ++i)
+		if (enemyAvail[i] == 1)
+			return i;
+	return -1;
+}
+
+static bool check( unsigned int frames )
+{
+	unsigned int misses = 0, hits = 0, spawns = 0;
+
+	for (unsigned int frame = 0; frame < frames; ++frame)
+	{
+		random_enemies();
+		random_shots();
+		enemy_grid_build();
+
+		for (unsigned int i = 0; i < SHOTS_PER_FRAME; ++i)
+		{
+			const shot_type *shot = &shots[i];
+			bool returned[COUNTOF(enemy)] = { false };
+			int spawned = -1;
+
+			query_shot(shot);
+
+			int last = -1;
+			for (int b = enemy_grid_next(-1); b >= 0; b = enemy_grid_next(b))
+			{
+				if (b <= last || enemyAvail[b] != 0)
+				{
+					if (misses++ < 10)
+						fprintf(stderr, "frame %u shot %u: slot %d out of order or not live\n", frame, i, b);
+				}
+				returned[b] = true;
+				last = b;
+
+				// a kill spawning an enemy ahead of the scan
+				if (spawned < 0 && lcg() % 8 == 0 && (spawned = free_slot_after(b)) >= 0)
+				{
+					place_enemy(spawned);
+					enemy_grid_add(spawned);
+					spawns++;
+				}
+			}
+
+			if (spawned >= 0 && !returned[spawned])
+			{
+				if (misses++ < 10)
+					fprintf(stderr, "frame %u shot %u: spawned slot %d not visited\n", frame, i, spawned);
+			}
+
+			for (unsigned int b = 0; b < COUNTOF(enemy); ++b)
+			{
+				if (enemyAvail[b] == 0 && collides(shot, b))
+				{
+					hits++;
+					if (!returned[b] && misses++ < 10)
+						fprintf(stderr, "frame %u shot %u (kind %d at %d,%d): slot %u at %d,%d missed\n", frame, i,
+						        shot->kind, shot->x, shot->y, b, enemy[b].ex + enemy[b].mapoffset, enemy[b].ey);
+				}
+			}
+		}
+	}
+
+	printf("%u frames, %u shots, %u hits, %u spawns during a scan: %u misses\n",
+	       frames, frames * SHOTS_PER_FRAME, hits, spawns, misses);
+	return misses == 0;
+}
+
+static unsigned int grid_frame( void )
+{
+	unsigned int hits = 0;
+
+	enemy_grid_build();
+	for (unsigned int i = 0; i < SHOTS_PER_FRAME; ++i)
+	{
+		query_shot(&shots[i]);
+		for (int b = enemy_grid_next(-1); b >= 0; b = enemy_grid_next(b))
+			hits += collides(&shots[i], b);
+	}
+	return hits;
+}
+
+static unsigned int full_scan_frame( void )
+{
+	unsigned int hits = 0;
+
+	for (unsigned int i = 0; i < SHOTS_PER_FRAME; ++i)
+		for (unsigned int b = 0; b < COUNTOF(enemy); ++b)
+			if (enemyAvail[b] == 0)
+				hits += collides(&shots[i], b);
+	return hits;
+}
+
+int main( int argc, char *argv[] )
+{
+	unsigned int trials = 2000, frames = 2000, rounds = 10;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+			trials = (unsigned int)atoi(argv[++i]);
+		else if (strcmp(argv[i], "-f") == 0 && i + 1 < argc)
+			frames = (unsigned int)atoi(argv[++i]);
+		else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc)
+			rounds = (unsigned int)atoi(argv[++i]);
+		else
+		{
+			fprintf(stderr, "usage: %s [-n frames] [-f frames] [-r rounds]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	const bool matches = check(trials);
+
+	// one fixed frame for the timing, whatever -n drew
+	lcg_state = 0x2545f491;
+	random_enemies();
+	random_shots();
+
+	Uint32 pairs_before, scan_before, pairs_after, scan_after;
+	get_collision_stats(&pairs_before, &scan_before);
+	const unsigned int grid_hits = grid_frame();
+	get_collision_stats(&pairs_after, &scan_after);
+
+	double grid_best = 0, scan_best = 0;
+	volatile unsigned int sink = 0;
+	for (unsigned int round = 0; round < rounds; ++round)
+	{
+		double start = now_seconds();
+		for (unsigned int frame = 0; frame < frames; ++frame)
+			sink += grid_frame();
+		const double grid = (now_seconds() - start) / frames;
+
+		start = now_seconds();
+		for (unsigned int frame = 0; frame < frames; ++frame)
+			sink += full_scan_frame();
+		const double scan = (now_seconds() - start) / frames;
+
+		if (round == 0 || grid < grid_best)
+			grid_best = grid;
+		if (round == 0 || scan < scan_best)
+			scan_best = scan;
+	}
+
+	if (grid_hits != full_scan_frame())
+	{
+		fprintf(stderr, "mismatch: the timing frame hits differ\n");
+		return 1;
+	}
+
+	printf("\n%d shots at %u live enemies: %u hits\n", SHOTS_PER_FRAME, (unsigned)(scan_after - scan_before) / SHOTS_PER_FRAME, grid_hits);
+	printf("%-10s %10s %10s\n", "", "pairs/fr", "us/fr");
+	printf("%-10s %10u %10.2f\n", "grid", (unsigned)(pairs_after - pairs_before), grid_best * 1e6);
+	printf("%-10s %10u %10.2f\n", "full scan", (unsigned)(scan_after - scan_before), scan_best * 1e6);
+
+	return !matches;
+}
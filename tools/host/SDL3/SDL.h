@@ -0,0 +1,309 @@
+// host build shim for tools/: the subset of the SDL3 API the engine uses,
+// with SDL3's names, types and values.  tools/headless links it against
+// sdl_headless.c; the benchmark harnesses only need the types.
+#ifndef SDL_h_
+#define SDL_h_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SDLCALL
+#define SDL_INLINE inline
+#define SDL_FORCE_INLINE static inline __attribute__((always_inline))
+
+typedef int8_t   Sint8;
+typedef uint8_t  Uint8;
+typedef int16_t  Sint16;
+typedef uint16_t Uint16;
+typedef int32_t  Sint32;
+typedef uint32_t Uint32;
+typedef int64_t  Sint64;
+typedef uint64_t Uint64;
+
+/* SDL_endian.h */
+
+#define SDL_LIL_ENDIAN 1234
+#define SDL_BIG_ENDIAN 4321
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define SDL_BYTEORDER SDL_BIG_ENDIAN
+#else
+#define SDL_BYTEORDER SDL_LIL_ENDIAN
+#endif
+
+SDL_FORCE_INLINE Uint16 SDL_Swap16( Uint16 x ) { return __builtin_bswap16(x); }
+SDL_FORCE_INLINE Uint32 SDL_Swap32( Uint32 x ) { return __builtin_bswap32(x); }
+SDL_FORCE_INLINE Uint64 SDL_Swap64( Uint64 x ) { return __builtin_bswap64(x); }
+
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+#define SDL_Swap16LE(x) (x)
+#define SDL_Swap32LE(x) (x)
+#define SDL_Swap64LE(x) (x)
+#define SDL_Swap16BE(x) SDL_Swap16(x)
+#define SDL_Swap32BE(x) SDL_Swap32(x)
+#define SDL_Swap64BE(x) SDL_Swap64(x)
+#else
+#define SDL_Swap16LE(x) SDL_Swap16(x)
+#define SDL_Swap32LE(x) SDL_Swap32(x)
+#define SDL_Swap64LE(x) SDL_Swap64(x)
+#define SDL_Swap16BE(x) (x)
+#define SDL_Swap32BE(x) (x)
+#define SDL_Swap64BE(x) (x)
+#endif
+#define SDL_SwapLE64(x) SDL_Swap64LE(x)  // the ESP-IDF port keeps the SDL2 name
+
+/* SDL_init.h, SDL_error.h, SDL_log.h, SDL_timer.h, SDL_stdinc.h */
+
+typedef Uint32 SDL_InitFlags;
+#define SDL_INIT_AUDIO   0x00000010u
+#define SDL_INIT_VIDEO   0x00000020u
+#define SDL_INIT_EVENTS  0x00004000u
+
+bool SDL_Init( SDL_InitFlags flags );
+bool SDL_InitSubSystem( SDL_InitFlags flags );
+void SDL_QuitSubSystem( SDL_InitFlags flags );
+void SDL_Quit( void );
+
+const char *SDL_GetError( void );
+void SDL_Log( const char *fmt, ... ) __attribute__((format(printf, 1, 2)));
+
+Uint64 SDL_GetTicks( void );
+Uint64 SDL_GetTicksNS( void );
+void SDL_Delay( Uint32 ms );
+
+size_t SDL_strlcpy( char *dst, const char *src, size_t maxlen );
+
+/* SDL_rect.h, SDL_pixels.h, SDL_surface.h */
+
+typedef struct { int x, y, w, h; } SDL_Rect;
+typedef struct { float x, y, w, h; } SDL_FRect;
+
+typedef enum
+{
+	SDL_PIXELFORMAT_UNKNOWN = 0,
+	SDL_PIXELFORMAT_INDEX8 = 0x13000801u,
+	SDL_PIXELFORMAT_RGB565 = 0x15151002u,
+} SDL_PixelFormat;
+
+#define SDL_BYTESPERPIXEL(format) ((int)((format) & 0xff))
+
+typedef struct { Uint8 r, g, b, a; } SDL_Color;
+
+typedef struct SDL_Palette
+{
+	int ncolors;
+	SDL_Color *colors;
+	Uint32 version;
+	int refcount;
+} SDL_Palette;
+
+typedef Uint32 SDL_SurfaceFlags;
+
+typedef struct SDL_Surface
+{
+	SDL_SurfaceFlags flags;
+	SDL_PixelFormat format;
+	int w, h;
+	int pitch;
+	void *pixels;
+	int refcount;
+	void *reserved;
+} SDL_Surface;
+
+SDL_Palette *SDL_CreatePalette( int ncolors );
+bool SDL_SetPaletteColors( SDL_Palette *palette, const SDL_Color *colors, int firstcolor, int ncolors );
+void SDL_DestroyPalette( SDL_Palette *palette );
+
+SDL_Surface *SDL_CreateSurface( int width, int height, SDL_PixelFormat format );
+void SDL_DestroySurface( SDL_Surface *surface );
+bool SDL_SetSurfacePalette( SDL_Surface *surface, SDL_Palette *palette );
+bool SDL_SetSurfaceClipRect( SDL_Surface *surface, const SDL_Rect *rect );
+bool SDL_GetSurfaceClipRect( SDL_Surface *surface, SDL_Rect *rect );
+bool SDL_FillSurfaceRect( SDL_Surface *dst, const SDL_Rect *rect, Uint32 color );
+
+typedef enum
+{
+	SDL_SCALEMODE_NEAREST,
+	SDL_SCALEMODE_LINEAR,
+} SDL_ScaleMode;
+
+bool SDL_BlitSurface( SDL_Surface *src, const SDL_Rect *srcrect, SDL_Surface *dst, const SDL_Rect *dstrect );
+bool SDL_BlitSurfaceScaled( SDL_Surface *src, const SDL_Rect *srcrect, SDL_Surface *dst, const SDL_Rect *dstrect, SDL_ScaleMode scaleMode );
+
+/* SDL_video.h */
+
+typedef struct SDL_Window SDL_Window;
+typedef Uint64 SDL_WindowFlags;
+
+SDL_Window *SDL_CreateWindow( const char *title, int w, int h, SDL_WindowFlags flags );
+void SDL_DestroyWindow( SDL_Window *window );
+bool SDL_GetWindowSize( SDL_Window *window, int *w, int *h );
+
+SDL_Surface *SDL_GetWindowSurface( SDL_Window *window );
+bool SDL_UpdateWindowSurface( SDL_Window *window );
+bool SDL_UpdateWindowSurfaceRects( SDL_Window *window, const SDL_Rect *rects, int numrects );
+
+/* SDL_audio.h */
+
+typedef Uint32 SDL_AudioDeviceID;
+#define SDL_AUDIO_DEVICE_DEFAULT_PLAYBACK ((SDL_AudioDeviceID)0xFFFFFFFFu)
+
+typedef enum
+{
+	SDL_AUDIO_UNKNOWN = 0x0000u,
+	SDL_AUDIO_U8      = 0x0008u,
+	SDL_AUDIO_S8      = 0x8008u,
+	SDL_AUDIO_S16LE   = 0x8010u,
+	SDL_AUDIO_S16BE   = 0x9010u,
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+	SDL_AUDIO_S16 = SDL_AUDIO_S16LE,
+#else
+	SDL_AUDIO_S16 = SDL_AUDIO_S16BE,
+#endif
+} SDL_AudioFormat;
+
+typedef struct SDL_AudioSpec
+{
+	SDL_AudioFormat format;
+	int channels;
+	int freq;
+} SDL_AudioSpec;
+
+typedef struct SDL_AudioStream SDL_AudioStream;
+typedef void (SDLCALL *SDL_AudioStreamCallback)( void *userdata, SDL_AudioStream *stream, int additional_amount, int total_amount );
+
+SDL_AudioStream *SDL_OpenAudioDeviceStream( SDL_AudioDeviceID devid, const SDL_AudioSpec *spec, SDL_AudioStreamCallback callback, void *userdata );
+bool SDL_ResumeAudioStreamDevice( SDL_AudioStream *stream );
+bool SDL_PutAudioStreamData( SDL_AudioStream *stream, const void *buf, int len );
+void SDL_DestroyAudioStream( SDL_AudioStream *stream );
+
+/* SDL_scancode.h, SDL_keycode.h, SDL_keyboard.h, SDL_mouse.h, SDL_joystick.h */
+
+typedef enum
+{
+	SDL_SCANCODE_UNKNOWN = 0,
+
+	SDL_SCANCODE_A = 4, SDL_SCANCODE_B, SDL_SCANCODE_C, SDL_SCANCODE_D, SDL_SCANCODE_E,
+	SDL_SCANCODE_F, SDL_SCANCODE_G, SDL_SCANCODE_H, SDL_SCANCODE_I, SDL_SCANCODE_J,
+	SDL_SCANCODE_K, SDL_SCANCODE_L, SDL_SCANCODE_M, SDL_SCANCODE_N, SDL_SCANCODE_O,
+	SDL_SCANCODE_P, SDL_SCANCODE_Q, SDL_SCANCODE_R, SDL_SCANCODE_S, SDL_SCANCODE_T,
+	SDL_SCANCODE_U, SDL_SCANCODE_V, SDL_SCANCODE_W, SDL_SCANCODE_X, SDL_SCANCODE_Y,
+	SDL_SCANCODE_Z,
+
+	SDL_SCANCODE_1 = 30, SDL_SCANCODE_2, SDL_SCANCODE_3, SDL_SCANCODE_4, SDL_SCANCODE_5,
+	SDL_SCANCODE_6, SDL_SCANCODE_7, SDL_SCANCODE_8, SDL_SCANCODE_9, SDL_SCANCODE_0,
+
+	SDL_SCANCODE_RETURN = 40,
+	SDL_SCANCODE_ESCAPE = 41,
+	SDL_SCANCODE_BACKSPACE = 42,
+	SDL_SCANCODE_TAB = 43,
+	SDL_SCANCODE_SPACE = 44,
+	SDL_SCANCODE_MINUS = 45,
+	SDL_SCANCODE_EQUALS = 46,
+	SDL_SCANCODE_LEFTBRACKET = 47,
+	SDL_SCANCODE_RIGHTBRACKET = 48,
+	SDL_SCANCODE_BACKSLASH = 49,
+	SDL_SCANCODE_SEMICOLON = 51,
+	SDL_SCANCODE_APOSTROPHE = 52,
+	SDL_SCANCODE_GRAVE = 53,
+	SDL_SCANCODE_COMMA = 54,
+	SDL_SCANCODE_PERIOD = 55,
+	SDL_SCANCODE_SLASH = 56,
+	SDL_SCANCODE_CAPSLOCK = 57,
+
+	SDL_SCANCODE_F1 = 58, SDL_SCANCODE_F2, SDL_SCANCODE_F3, SDL_SCANCODE_F4,
+	SDL_SCANCODE_F5, SDL_SCANCODE_F6, SDL_SCANCODE_F7, SDL_SCANCODE_F8,
+	SDL_SCANCODE_F9, SDL_SCANCODE_F10, SDL_SCANCODE_F11, SDL_SCANCODE_F12,
+
+	SDL_SCANCODE_PRINTSCREEN = 70,
+	SDL_SCANCODE_SCROLLLOCK = 71,
+	SDL_SCANCODE_PAUSE = 72,
+	SDL_SCANCODE_INSERT = 73,
+	SDL_SCANCODE_HOME = 74,
+	SDL_SCANCODE_PAGEUP = 75,
+	SDL_SCANCODE_DELETE = 76,
+	SDL_SCANCODE_END = 77,
+	SDL_SCANCODE_PAGEDOWN = 78,
+	SDL_SCANCODE_RIGHT = 79,
+	SDL_SCANCODE_LEFT = 80,
+	SDL_SCANCODE_DOWN = 81,
+	SDL_SCANCODE_UP = 82,
+	SDL_SCANCODE_NUMLOCKCLEAR = 83,
+	SDL_SCANCODE_NUMLOCK = SDL_SCANCODE_NUMLOCKCLEAR,  // ESP-IDF port spelling
+
+	SDL_SCANCODE_KP_ENTER = 88,
+	SDL_SCANCODE_KP_1 = 89, SDL_SCANCODE_KP_2, SDL_SCANCODE_KP_3, SDL_SCANCODE_KP_4,
+	SDL_SCANCODE_KP_5, SDL_SCANCODE_KP_6, SDL_SCANCODE_KP_7, SDL_SCANCODE_KP_8,
+	SDL_SCANCODE_KP_9, SDL_SCANCODE_KP_0,
+
+	SDL_SCANCODE_LCTRL = 224,
+	SDL_SCANCODE_LSHIFT = 225,
+	SDL_SCANCODE_LALT = 226,
+	SDL_SCANCODE_LGUI = 227,
+	SDL_SCANCODE_RCTRL = 228,
+	SDL_SCANCODE_RSHIFT = 229,
+	SDL_SCANCODE_RALT = 230,
+	SDL_SCANCODE_RGUI = 231,
+
+	SDL_SCANCODE_COUNT = 512
+} SDL_Scancode;
+
+typedef Uint32 SDL_Keycode;
+typedef Uint16 SDL_Keymod;
+typedef Uint32 SDL_KeyboardID;
+
+#define SDLK_SCANCODE_MASK (1u << 30)
+
+#define SDL_KMOD_NONE   0x0000u
+#define SDL_KMOD_LSHIFT 0x0001u
+#define SDL_KMOD_RSHIFT 0x0002u
+#define SDL_KMOD_SHIFT  (SDL_KMOD_LSHIFT | SDL_KMOD_RSHIFT)
+
+SDL_Keymod SDL_GetModState( void );
+SDL_Keycode SDL_GetKeyFromScancode( SDL_Scancode scancode, SDL_Keymod modstate, bool key_event );
+const char *SDL_GetKeyName( SDL_Keycode key );
+
+#define SDL_BUTTON_LEFT   1
+#define SDL_BUTTON_MIDDLE 2
+#define SDL_BUTTON_RIGHT  3
+
+typedef struct SDL_Joystick SDL_Joystick;
+
+/* SDL_events.h */
+
+typedef enum
+{
+	SDL_EVENT_FIRST = 0,
+	SDL_EVENT_QUIT = 0x100,
+	SDL_EVENT_KEY_DOWN = 0x300,
+	SDL_EVENT_KEY_UP,
+} SDL_EventType;
+
+typedef struct SDL_KeyboardEvent
+{
+	SDL_EventType type;
+	Uint32 reserved;
+	Uint64 timestamp;
+	Uint32 windowID;
+	SDL_KeyboardID which;
+	SDL_Scancode scancode;
+	SDL_Keycode key;
+	SDL_Keymod mod;
+	Uint16 raw;
+	bool down;
+	bool repeat;
+} SDL_KeyboardEvent;
+
+typedef union SDL_Event
+{
+	Uint32 type;
+	SDL_KeyboardEvent key;
+	Uint8 padding[128];
+} SDL_Event;
+
+bool SDL_PollEvent( SDL_Event *event );
+
+#endif /* SDL_h_ */
@@ -0,0 +1,2 @@
+// host build shim for tools/: everything is declared in SDL.h
+#include "SDL3/SDL.h"
@@ -0,0 +1,9 @@
+// host build shim for tools/: the ESP-IDF placement attributes are no-ops
+#ifndef ESP_ATTR_H
+#define ESP_ATTR_H
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define EXT_RAM_BSS_ATTR
+
+#endif
@@ -0,0 +1,22 @@
+// host build shim for tools/
+#ifndef ESP_ERR_H
+#define ESP_ERR_H
+
+#include <stdio.h>
+#include <stdlib.h>
+
+typedef int esp_err_t;
+
+#define ESP_OK                   0
+#define ESP_FAIL                 -1
+#define ESP_ERR_NOT_SUPPORTED    0x106
+
+#define ESP_ERROR_CHECK(x) do { \
+		esp_err_t err_rc_ = (x); \
+		if (err_rc_ != ESP_OK) { \
+			fprintf(stderr, "%s:%d: %s failed (%d)\n", __FILE__, __LINE__, #x, err_rc_); \
+			abort(); \
+		} \
+	} while (0)
+
+#endif
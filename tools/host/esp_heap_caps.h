@@ -0,0 +1,32 @@
+// host build shim for tools/: every capability is plain malloc
+#ifndef ESP_HEAP_CAPS_H
+#define ESP_HEAP_CAPS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#define MALLOC_CAP_8BIT     (1 << 2)
+#define MALLOC_CAP_DMA      (1 << 3)
+#define MALLOC_CAP_SPIRAM   (1 << 10)
+#define MALLOC_CAP_INTERNAL (1 << 11)
+
+static inline void *heap_caps_malloc( size_t size, uint32_t caps )
+{
+	(void)caps;
+	return malloc(size);
+}
+
+static inline void *heap_caps_calloc( size_t n, size_t size, uint32_t caps )
+{
+	(void)caps;
+	return calloc(n, size);
+}
+
+static inline size_t heap_caps_get_free_size( uint32_t caps )
+{
+	(void)caps;
+	return 0;
+}
+
+#endif
@@ -0,0 +1,12 @@
+// host build shim for tools/: heap tracing is not available
+#ifndef ESP_HEAP_TRACE_H
+#define ESP_HEAP_TRACE_H
+
+#include "esp_heap_caps.h"
+
+typedef struct {
+	void *address;
+	unsigned int size;
+} heap_trace_record_t;
+
+#endif
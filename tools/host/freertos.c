@@ -0,0 +1,215 @@
+/*
+ * OpenTyrian: A modern cross-platform port of Tyrian
+ * Copyright (C) 2007-2009  The OpenTyrian Development Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+// The part of the FreeRTOS API the engine uses, on pthreads, so that the
+// present task, scaler workers and music task run as real threads on the host.
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <time.h>
+
+struct host_task
+{
+	pthread_t thread;
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	uint32_t notify_count;
+	TaskFunction_t fn;
+	void *arg;
+};
+
+struct host_semaphore
+{
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	bool given;
+};
+
+static __thread struct host_task *current_task;
+
+static struct host_task *task_new( void )
+{
+	struct host_task *task = calloc(1, sizeof(*task));
+	if (task == NULL)
+		return NULL;
+	pthread_mutex_init(&task->lock, NULL);
+	pthread_cond_init(&task->cond, NULL);
+	return task;
+}
+
+// Turns a tick count (1 ms each) into a deadline for wait(); portMAX_DELAY
+// means none.
+static struct timespec *deadline_after( TickType_t ticks, struct timespec *deadline )
+{
+	if (ticks == portMAX_DELAY)
+		return NULL;
+
+	clock_gettime(CLOCK_REALTIME, deadline);
+	deadline->tv_sec += ticks / 1000;
+	deadline->tv_nsec += (long)(ticks % 1000) * 1000000;
+	if (deadline->tv_nsec >= 1000000000)
+	{
+		deadline->tv_sec++;
+		deadline->tv_nsec -= 1000000000;
+	}
+	return deadline;
+}
+
+// One wait on cond with lock held; false once the deadline has passed.
+static bool wait( pthread_cond_t *cond, pthread_mutex_t *lock, const struct timespec *deadline )
+{
+	if (deadline == NULL)
+		return pthread_cond_wait(cond, lock) == 0;
+	return pthread_cond_timedwait(cond, lock, deadline) != ETIMEDOUT;
+}
+
+static void *task_entry( void *arg )
+{
+	current_task = arg;
+	current_task->fn(current_task->arg);
+	return NULL;
+}
+
+BaseType_t xTaskCreatePinnedToCore( TaskFunction_t fn, const char *name, uint32_t stack_depth, void *arg,
+                                    UBaseType_t priority, TaskHandle_t *handle, BaseType_t core )
+{
+	(void)name, (void)stack_depth, (void)priority, (void)core;
+
+	struct host_task *task = task_new();
+	if (task == NULL)
+		return pdFAIL;
+	task->fn = fn;
+	task->arg = arg;
+
+	// the handle is live before the task runs, as on the device
+	if (handle != NULL)
+		*handle = task;
+
+	if (pthread_create(&task->thread, NULL, task_entry, task) != 0)
+	{
+		free(task);
+		if (handle != NULL)
+			*handle = NULL;
+		return pdFAIL;
+	}
+	pthread_detach(task->thread);
+	return pdPASS;
+}
+
+void vTaskDelete( TaskHandle_t task )
+{
+	// only self-deletion is used; the handle may still be notified by a
+	// racing producer, so it is never freed
+	if (task == NULL || task == current_task)
+		pthread_exit(NULL);
+}
+
+void vTaskDelay( TickType_t ticks )
+{
+	const struct timespec delay = { ticks / 1000, (long)(ticks % 1000) * 1000000 };
+	nanosleep(&delay, NULL);
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle( void )
+{
+	// threads not started through xTaskCreatePinnedToCore (the game thread)
+	// get a handle on first use so they can be notified too
+	if (current_task == NULL)
+		current_task = task_new();
+	return current_task;
+}
+
+BaseType_t xPortGetCoreID( void )
+{
+	return 0;
+}
+
+BaseType_t xTaskNotifyGive( TaskHandle_t task )
+{
+	pthread_mutex_lock(&task->lock);
+	task->notify_count++;
+	pthread_cond_signal(&task->cond);
+	pthread_mutex_unlock(&task->lock);
+	return pdPASS;
+}
+
+uint32_t ulTaskNotifyTake( BaseType_t clear_on_exit, TickType_t ticks_to_wait )
+{
+	struct host_task *task = xTaskGetCurrentTaskHandle();
+	struct timespec deadline_buf;
+	const struct timespec *deadline = deadline_after(ticks_to_wait, &deadline_buf);
+
+	pthread_mutex_lock(&task->lock);
+	while (task->notify_count == 0 && ticks_to_wait != 0)
+		if (!wait(&task->cond, &task->lock, deadline))
+			break;
+	const uint32_t count = task->notify_count;
+	if (count != 0)
+		task->notify_count = clear_on_exit ? 0 : count - 1;
+	pthread_mutex_unlock(&task->lock);
+	return count;
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary( void )
+{
+	struct host_semaphore *sem = calloc(1, sizeof(*sem));
+	if (sem == NULL)
+		return NULL;
+	pthread_mutex_init(&sem->lock, NULL);
+	pthread_cond_init(&sem->cond, NULL);
+	return sem;
+}
+
+void vSemaphoreDelete( SemaphoreHandle_t sem )
+{
+	pthread_cond_destroy(&sem->cond);
+	pthread_mutex_destroy(&sem->lock);
+	free(sem);
+}
+
+BaseType_t xSemaphoreTake( SemaphoreHandle_t sem, TickType_t ticks_to_wait )
+{
+	struct timespec deadline_buf;
+	const struct timespec *deadline = deadline_after(ticks_to_wait, &deadline_buf);
+
+	pthread_mutex_lock(&sem->lock);
+	while (!sem->given && ticks_to_wait != 0)
+		if (!wait(&sem->cond, &sem->lock, deadline))
+			break;
+	const bool taken = sem->given;
+	sem->given = false;
+	pthread_mutex_unlock(&sem->lock);
+	return taken ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xSemaphoreGive( SemaphoreHandle_t sem )
+{
+	pthread_mutex_lock(&sem->lock);
+	const bool was_given = sem->given;
+	sem->given = true;
+	pthread_cond_signal(&sem->cond);
+	pthread_mutex_unlock(&sem->lock);
+	return was_given ? pdFALSE : pdTRUE;
+}
@@ -0,0 +1,27 @@
+// host build shim for tools/: FreeRTOS tasks and semaphores on top of
+// pthreads (see freertos.c); priorities and core affinity are ignored
+#ifndef FREERTOS_H
+#define FREERTOS_H
+
+#include <stdint.h>
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdFALSE 0
+#define pdTRUE  1
+#define pdFAIL  0
+#define pdPASS  1
+
+#define portMAX_DELAY       ((TickType_t)0xffffffff)
+#define portTICK_PERIOD_MS  1
+#define portNUM_PROCESSORS  2
+#define pdMS_TO_TICKS(ms)   ((TickType_t)(ms))
+
+#define configMAX_PRIORITIES 25
+#define tskNO_AFFINITY       0x7fffffff
+
+BaseType_t xPortGetCoreID( void );
+
+#endif
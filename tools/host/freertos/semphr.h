@@ -0,0 +1,14 @@
+// host build shim for tools/
+#ifndef SEMAPHORE_H
+#define SEMAPHORE_H
+
+#include "freertos/FreeRTOS.h"
+
+typedef struct host_semaphore *SemaphoreHandle_t;
+
+SemaphoreHandle_t xSemaphoreCreateBinary( void );
+void vSemaphoreDelete( SemaphoreHandle_t sem );
+BaseType_t xSemaphoreTake( SemaphoreHandle_t sem, TickType_t ticks_to_wait );
+BaseType_t xSemaphoreGive( SemaphoreHandle_t sem );
+
+#endif
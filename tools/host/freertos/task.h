@@ -0,0 +1,19 @@
+// host build shim for tools/
+#ifndef TASK_H
+#define TASK_H
+
+#include "freertos/FreeRTOS.h"
+
+typedef struct host_task *TaskHandle_t;
+typedef void (*TaskFunction_t)( void * );
+
+BaseType_t xTaskCreatePinnedToCore( TaskFunction_t fn, const char *name, uint32_t stack_depth, void *arg,
+                                    UBaseType_t priority, TaskHandle_t *handle, BaseType_t core );
+void vTaskDelete( TaskHandle_t task );
+void vTaskDelay( TickType_t ticks );
+TaskHandle_t xTaskGetCurrentTaskHandle( void );
+
+BaseType_t xTaskNotifyGive( TaskHandle_t task );
+uint32_t ulTaskNotifyTake( BaseType_t clear_on_exit, TickType_t ticks_to_wait );
+
+#endif
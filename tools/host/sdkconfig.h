@@ -0,0 +1,5 @@
+// host build shim for tools/: no target is selected
+#ifndef SDKCONFIG_H
+#define SDKCONFIG_H
+
+#endif
@@ -0,0 +1,496 @@
+/*
+ * OpenTyrian: A modern cross-platform port of Tyrian
+ * Copyright (C) 2007-2009  The OpenTyrian Development Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+// Headless SDL backend for tools/headless: surfaces and palettes are real,
+// the window has a real RGB565 surface that is never shown, the audio device
+// pulls from its stream every 10 ms and discards what it gets, and there is
+// never any input.
+//
+// SDL_Delay does not sleep; it moves the clock forward instead, so fades and
+// menu pauses cost no wall time while anything timed with SDL_GetTicks still
+// sees them take as long as they would on the device.
+//
+// The ESP-IDF port sizes the window to the board's panel, not to what the
+// game asks for; SDL_HEADLESS_WINDOW=<w>x<h> stands in for a panel here.
+
+#include "SDL3/SDL.h"
+
+#include <ctype.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <time.h>
+
+#define AUDIO_PERIOD_MS 10
+
+typedef struct
+{
+	SDL_Surface surface;  // first, so the two pointers convert
+	SDL_Rect clip;
+	SDL_Palette *palette;
+} HostSurface;
+
+struct SDL_Window
+{
+	int w, h;
+	SDL_Surface *surface;
+};
+
+struct SDL_AudioStream
+{
+	SDL_AudioSpec spec;
+	SDL_AudioStreamCallback callback;
+	void *userdata;
+	pthread_t thread;
+	atomic_bool running, paused;
+	atomic_ullong bytes_played;
+};
+
+static const char *last_error = "";
+static atomic_ullong skipped_ns;
+
+static bool set_error( const char *error )
+{
+	last_error = error;
+	return false;
+}
+
+static int bytes_per_pixel( SDL_PixelFormat format )
+{
+	return format == SDL_PIXELFORMAT_RGB565 ? 2 : 1;
+}
+
+/* init, errors, log, time */
+
+bool SDL_Init( SDL_InitFlags flags )
+{
+	(void)flags;
+	return true;
+}
+
+bool SDL_InitSubSystem( SDL_InitFlags flags )
+{
+	return SDL_Init(flags);
+}
+
+void SDL_QuitSubSystem( SDL_InitFlags flags )
+{
+	(void)flags;
+}
+
+void SDL_Quit( void )
+{
+}
+
+const char *SDL_GetError( void )
+{
+	return last_error;
+}
+
+void SDL_Log( const char *fmt, ... )
+{
+	va_list args;
+	va_start(args, fmt);
+	vfprintf(stderr, fmt, args);
+	va_end(args);
+	fputc('\n', stderr);
+}
+
+Uint64 SDL_GetTicksNS( void )
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (Uint64)now.tv_sec * 1000000000u + now.tv_nsec + atomic_load(&skipped_ns);
+}
+
+Uint64 SDL_GetTicks( void )
+{
+	return SDL_GetTicksNS() / 1000000u;
+}
+
+void SDL_Delay( Uint32 ms )
+{
+	atomic_fetch_add(&skipped_ns, (Uint64)ms * 1000000u);
+}
+
+size_t SDL_strlcpy( char *dst, const char *src, size_t maxlen )
+{
+	const size_t len = strlen(src);
+	if (maxlen > 0)
+	{
+		const size_t n = len < maxlen - 1 ? len : maxlen - 1;
+		memcpy(dst, src, n);
+		dst[n] = '\0';
+	}
+	return len;
+}
+
+/* palettes and surfaces */
+
+SDL_Palette *SDL_CreatePalette( int ncolors )
+{
+	SDL_Palette *palette = calloc(1, sizeof(*palette));
+	if (palette == NULL)
+		return NULL;
+	palette->colors = malloc(ncolors * sizeof(*palette->colors));
+	if (palette->colors == NULL)
+	{
+		free(palette);
+		return NULL;
+	}
+	memset(palette->colors, 0xff, ncolors * sizeof(*palette->colors));
+	palette->ncolors = ncolors;
+	palette->version = 1;
+	palette->refcount = 1;
+	return palette;
+}
+
+bool SDL_SetPaletteColors( SDL_Palette *palette, const SDL_Color *colors, int firstcolor, int ncolors )
+{
+	if (palette == NULL || firstcolor < 0 || firstcolor >= palette->ncolors)
+		return set_error("invalid palette range");
+	if (ncolors > palette->ncolors - firstcolor)
+		ncolors = palette->ncolors - firstcolor;
+	if (colors != palette->colors + firstcolor)
+		memmove(palette->colors + firstcolor, colors, ncolors * sizeof(*colors));
+	palette->version++;
+	return true;
+}
+
+void SDL_DestroyPalette( SDL_Palette *palette )
+{
+	if (palette != NULL && --palette->refcount == 0)
+	{
+		free(palette->colors);
+		free(palette);
+	}
+}
+
+SDL_Surface *SDL_CreateSurface( int width, int height, SDL_PixelFormat format )
+{
+	HostSurface *host = calloc(1, sizeof(*host));
+	if (host == NULL)
+		return NULL;
+
+	SDL_Surface *surface = &host->surface;
+	surface->format = format;
+	surface->w = width;
+	surface->h = height;
+	surface->pitch = (width * bytes_per_pixel(format) + 3) & ~3;
+	surface->pixels = calloc(height, surface->pitch);
+	surface->refcount = 1;
+	if (surface->pixels == NULL)
+	{
+		free(host);
+		return NULL;
+	}
+	host->clip = (SDL_Rect){ 0, 0, width, height };
+	return surface;
+}
+
+void SDL_DestroySurface( SDL_Surface *surface )
+{
+	if (surface == NULL)
+		return;
+	HostSurface *host = (HostSurface *)surface;
+	SDL_DestroyPalette(host->palette);
+	free(surface->pixels);
+	free(host);
+}
+
+bool SDL_SetSurfacePalette( SDL_Surface *surface, SDL_Palette *palette )
+{
+	HostSurface *host = (HostSurface *)surface;
+	if (palette != NULL)
+		palette->refcount++;
+	SDL_DestroyPalette(host->palette);
+	host->palette = palette;
+	return true;
+}
+
+static bool intersect( const SDL_Rect *a, const SDL_Rect *b, SDL_Rect *out )
+{
+	const int x0 = a->x > b->x ? a->x : b->x,
+	          y0 = a->y > b->y ? a->y : b->y,
+	          x1 = a->x + a->w < b->x + b->w ? a->x + a->w : b->x + b->w,
+	          y1 = a->y + a->h < b->y + b->h ? a->y + a->h : b->y + b->h;
+	*out = (SDL_Rect){ x0, y0, x1 > x0 ? x1 - x0 : 0, y1 > y0 ? y1 - y0 : 0 };
+	return out->w > 0 && out->h > 0;
+}
+
+bool SDL_SetSurfaceClipRect( SDL_Surface *surface, const SDL_Rect *rect )
+{
+	HostSurface *host = (HostSurface *)surface;
+	const SDL_Rect full = { 0, 0, surface->w, surface->h };
+	if (rect == NULL)
+	{
+		host->clip = full;
+		return true;
+	}
+	return intersect(rect, &full, &host->clip);
+}
+
+bool SDL_GetSurfaceClipRect( SDL_Surface *surface, SDL_Rect *rect )
+{
+	*rect = ((HostSurface *)surface)->clip;
+	return true;
+}
+
+bool SDL_FillSurfaceRect( SDL_Surface *dst, const SDL_Rect *rect, Uint32 color )
+{
+	const SDL_Rect *clip = &((HostSurface *)dst)->clip;
+	SDL_Rect area;
+	if (rect == NULL)
+		area = *clip;
+	else if (!intersect(rect, clip, &area))
+		return true;
+
+	for (int y = area.y; y < area.y + area.h; ++y)
+	{
+		Uint8 *row = (Uint8 *)dst->pixels + y * dst->pitch;
+		if (dst->format == SDL_PIXELFORMAT_RGB565)
+		{
+			for (int x = area.x; x < area.x + area.w; ++x)
+				((Uint16 *)row)[x] = color;
+		}
+		else
+		{
+			memset(row + area.x, color, area.w);
+		}
+	}
+	return true;
+}
+
+static bool clip_to( const SDL_Surface *surface, const SDL_Rect *rect, SDL_Rect *out )
+{
+	const SDL_Rect full = { 0, 0, surface->w, surface->h };
+	return intersect(rect != NULL ? rect : &full, &full, out);
+}
+
+// RGB565 to RGB565 or INDEX8 to INDEX8 only, which is all the engine blits
+bool SDL_BlitSurface( SDL_Surface *src, const SDL_Rect *srcrect, SDL_Surface *dst, const SDL_Rect *dstrect )
+{
+	if (src->format != dst->format)
+		return set_error("blits between formats are not supported");
+
+	SDL_Rect from, to;
+	if (!clip_to(src, srcrect, &from))
+		return true;
+	const SDL_Rect wanted = { dstrect ? dstrect->x : 0, dstrect ? dstrect->y : 0, from.w, from.h };
+	if (!intersect(&wanted, &((HostSurface *)dst)->clip, &to))
+		return true;
+
+	const int bpp = bytes_per_pixel(src->format);
+	for (int y = 0; y < to.h; ++y)
+		memcpy((Uint8 *)dst->pixels + (to.y + y) * dst->pitch + to.x * bpp,
+		       (Uint8 *)src->pixels + (from.y + to.y - wanted.y + y) * src->pitch + (from.x + to.x - wanted.x) * bpp,
+		       to.w * bpp);
+	return true;
+}
+
+// nearest-neighbour whatever the mode, sampling pixel centres as SDL does
+bool SDL_BlitSurfaceScaled( SDL_Surface *src, const SDL_Rect *srcrect, SDL_Surface *dst, const SDL_Rect *dstrect, SDL_ScaleMode scaleMode )
+{
+	(void)scaleMode;
+	if (src->format != dst->format)
+		return set_error("blits between formats are not supported");
+
+	SDL_Rect from, to;
+	if (!clip_to(src, srcrect, &from) || !clip_to(dst, dstrect, &to))
+		return true;
+
+	const int bpp = bytes_per_pixel(src->format);
+	for (int y = 0; y < to.h; ++y)
+	{
+		const int sy = from.y + (int)(((Sint64)y * 2 + 1) * from.h / (to.h * 2));
+		for (int x = 0; x < to.w; ++x)
+		{
+			const int sx = from.x + (int)(((Sint64)x * 2 + 1) * from.w / (to.w * 2));
+			memcpy((Uint8 *)dst->pixels + (to.y + y) * dst->pitch + (to.x + x) * bpp,
+			       (Uint8 *)src->pixels + sy * src->pitch + sx * bpp, bpp);
+		}
+	}
+	return true;
+}
+
+/* window */
+
+SDL_Window *SDL_CreateWindow( const char *title, int w, int h, SDL_WindowFlags flags )
+{
+	(void)title, (void)flags;
+	const char *panel = getenv("SDL_HEADLESS_WINDOW");
+	if (panel != NULL)
+		sscanf(panel, "%dx%d", &w, &h);
+
+	SDL_Window *window = malloc(sizeof(*window));
+	if (window != NULL)
+		*window = (SDL_Window){ w, h, NULL };
+	return window;
+}
+
+void SDL_DestroyWindow( SDL_Window *window )
+{
+	if (window != NULL)
+		SDL_DestroySurface(window->surface);
+	free(window);
+}
+
+bool SDL_GetWindowSize( SDL_Window *window, int *w, int *h )
+{
+	*w = window->w;
+	*h = window->h;
+	return true;
+}
+
+SDL_Surface *SDL_GetWindowSurface( SDL_Window *window )
+{
+	if (window->surface == NULL)
+		window->surface = SDL_CreateSurface(window->w, window->h, SDL_PIXELFORMAT_RGB565);
+	return window->surface;
+}
+
+bool SDL_UpdateWindowSurface( SDL_Window *window )
+{
+	(void)window;
+	return true;
+}
+
+bool SDL_UpdateWindowSurfaceRects( SDL_Window *window, const SDL_Rect *rects, int numrects )
+{
+	(void)window, (void)rects, (void)numrects;
+	return true;
+}
+
+/* audio */
+
+static void *audio_device_main( void *arg )
+{
+	SDL_AudioStream *stream = arg;
+	const int frame_bytes = stream->spec.channels * ((stream->spec.format & 0xff) / 8);
+	const int period_bytes = stream->spec.freq * AUDIO_PERIOD_MS / 1000 * frame_bytes;
+	const struct timespec period = { 0, AUDIO_PERIOD_MS * 1000000L };
+
+	while (atomic_load(&stream->running))
+	{
+		if (!atomic_load(&stream->paused))
+			stream->callback(stream->userdata, stream, period_bytes, period_bytes);
+		nanosleep(&period, NULL);
+	}
+	return NULL;
+}
+
+SDL_AudioStream *SDL_OpenAudioDeviceStream( SDL_AudioDeviceID devid, const SDL_AudioSpec *spec, SDL_AudioStreamCallback callback, void *userdata )
+{
+	(void)devid;
+	SDL_AudioStream *stream = calloc(1, sizeof(*stream));
+	if (stream == NULL)
+		return NULL;
+	stream->spec = *spec;
+	stream->callback = callback;
+	stream->userdata = userdata;
+	atomic_store(&stream->paused, true);  // devices open paused, as in SDL3
+
+	if (callback != NULL)
+	{
+		atomic_store(&stream->running, true);
+		if (pthread_create(&stream->thread, NULL, audio_device_main, stream) != 0)
+		{
+			free(stream);
+			set_error("failed to start audio thread");
+			return NULL;
+		}
+	}
+	return stream;
+}
+
+bool SDL_ResumeAudioStreamDevice( SDL_AudioStream *stream )
+{
+	atomic_store(&stream->paused, false);
+	return true;
+}
+
+bool SDL_PutAudioStreamData( SDL_AudioStream *stream, const void *buf, int len )
+{
+	(void)buf;
+	atomic_fetch_add(&stream->bytes_played, len);
+	return true;
+}
+
+void SDL_DestroyAudioStream( SDL_AudioStream *stream )
+{
+	if (stream == NULL)
+		return;
+	if (atomic_exchange(&stream->running, false))
+		pthread_join(stream->thread, NULL);
+	free(stream);
+}
+
+/* input: nothing is ever pressed */
+
+SDL_Keymod SDL_GetModState( void )
+{
+	return SDL_KMOD_NONE;
+}
+
+SDL_Keycode SDL_GetKeyFromScancode( SDL_Scancode scancode, SDL_Keymod modstate, bool key_event )
+{
+	(void)modstate, (void)key_event;
+	static const char punctuation[] = "\r\x1b\b\t -=[]\\#;'`,./";
+
+	if (scancode >= SDL_SCANCODE_A && scancode <= SDL_SCANCODE_Z)
+		return 'a' + (scancode - SDL_SCANCODE_A);
+	if (scancode >= SDL_SCANCODE_1 && scancode <= SDL_SCANCODE_9)
+		return '1' + (scancode - SDL_SCANCODE_1);
+	if (scancode == SDL_SCANCODE_0)
+		return '0';
+	if (scancode >= SDL_SCANCODE_RETURN && scancode <= SDL_SCANCODE_SLASH)
+		return (unsigned char)punctuation[scancode - SDL_SCANCODE_RETURN];
+	return scancode | SDLK_SCANCODE_MASK;
+}
+
+const char *SDL_GetKeyName( SDL_Keycode key )
+{
+	static const struct { SDL_Keycode key; const char *name; } names[] =
+	{
+		{ '\r', "Return" }, { '\x1b', "Escape" }, { '\b', "Backspace" }, { '\t', "Tab" }, { ' ', "Space" },
+		{ SDL_SCANCODE_UP | SDLK_SCANCODE_MASK, "Up" }, { SDL_SCANCODE_DOWN | SDLK_SCANCODE_MASK, "Down" },
+		{ SDL_SCANCODE_LEFT | SDLK_SCANCODE_MASK, "Left" }, { SDL_SCANCODE_RIGHT | SDLK_SCANCODE_MASK, "Right" },
+		{ SDL_SCANCODE_LCTRL | SDLK_SCANCODE_MASK, "Left Ctrl" }, { SDL_SCANCODE_RCTRL | SDLK_SCANCODE_MASK, "Right Ctrl" },
+		{ SDL_SCANCODE_LALT | SDLK_SCANCODE_MASK, "Left Alt" }, { SDL_SCANCODE_RALT | SDLK_SCANCODE_MASK, "Right Alt" },
+		{ SDL_SCANCODE_LSHIFT | SDLK_SCANCODE_MASK, "Left Shift" }, { SDL_SCANCODE_RSHIFT | SDLK_SCANCODE_MASK, "Right Shift" },
+	};
+	static __thread char single[2];
+
+	for (size_t i = 0; i < sizeof(names) / sizeof(*names); ++i)
+		if (names[i].key == key)
+			return names[i].name;
+
+	if (key > ' ' && key < 0x7f)
+	{
+		single[0] = toupper(key);
+		return single;
+	}
+	return "";
+}
+
+bool SDL_PollEvent( SDL_Event *event )
+{
+	(void)event;
+	return false;
+}
@@ -0,0 +1,245 @@
+/*
+ * OpenTyrian: A modern cross-platform port of Tyrian
+ * Copyright (C) 2007-2009  The OpenTyrian Development Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/*
+ * Host microbenchmark for the audio mix kernels, next to the per-sample
+ * float loops audio_cb() used before them:
+ *
+ *   cc -O2 -Itools/host -Icomponents/OpenTyrian -o mix_bench \
+ *      tools/mix/mix_bench.c components/OpenTyrian/mix.c
+ *   ./mix_bench [-n blocks] [-r rounds]
+ *
+ * The kernels are first checked against a straightforward reference, then
+ * timed on -n 512-sample blocks, the size audio_cb() mixes at once, taking
+ * turns with the float loops; each figure is the best of -r rounds.
+ *
+ * On the host this checks and times the C kernels only.  The ESP32-S3 PIE
+ * path in mix.c is not built here, and has not been run on a board.
+ */
+
+#include "mix.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BLOCK_SAMPLES 512
+#define CHANNELS 8
+
+static int16_t block[BLOCK_SAMPLES] __attribute__((aligned(16)));
+static int16_t sfx[CHANNELS][BLOCK_SAMPLES] __attribute__((aligned(16)));
+
+static uint32_t lcg_state = 0x2545f491;
+
+static int16_t lcg_sample( void )
+{
+	lcg_state = lcg_state * 1103515245 + 12345;
+	return (int16_t)(lcg_state >> 16);
+}
+
+static double now_seconds( void )
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void fill( int16_t *samples, unsigned int count )
+{
+	for (unsigned int i = 0; i < count; ++i)
+		samples[i] = lcg_sample();
+}
+
+static int16_t reference_saturate( int64_t x )
+{
+	return (x > 32767) ? 32767 : (x < -32768) ? -32768 : (int16_t)x;
+}
+
+// odd lengths and offsets cover the unaligned and leftover paths
+static bool check_kernels( void )
+{
+	static const int32_t gains[] = { 0, 1, 12345, MIX_GAIN_ONE - 1, MIX_GAIN_ONE, MIX_GAIN_ONE + 1, 49152, MIX_GAIN_MAX };
+	int16_t a[BLOCK_SAMPLES + 8], b[BLOCK_SAMPLES + 8], expect[BLOCK_SAMPLES + 8];
+
+	for (unsigned int offset = 0; offset < 8; ++offset)
+	{
+		const unsigned int count = BLOCK_SAMPLES - offset * 3;
+
+		for (unsigned int g = 0; g < sizeof(gains) / sizeof(*gains); ++g)
+		{
+			fill(a, BLOCK_SAMPLES + 8);
+			for (unsigned int i = 0; i < count; ++i)
+				expect[i] = reference_saturate(((int64_t)a[offset + i] * gains[g]) >> 15);
+
+			mix_scale_s16(a + offset, count, gains[g]);
+			if (memcmp(a + offset, expect, count * sizeof(*a)) != 0)
+			{
+				fprintf(stderr, "error: mix_scale_s16 mismatch at gain %ld, offset %u\n", (long)gains[g], offset);
+				return false;
+			}
+		}
+
+		fill(a, BLOCK_SAMPLES + 8);
+		fill(b, BLOCK_SAMPLES + 8);
+		for (unsigned int i = 0; i < count; ++i)
+			expect[i] = reference_saturate((int64_t)a[offset + i] + b[offset + i]);
+
+		mix_add_s16(a + offset, b + offset, count);
+		if (memcmp(a + offset, expect, count * sizeof(*a)) != 0)
+		{
+			fprintf(stderr, "error: mix_add_s16 mismatch at offset %u\n", offset);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// the loops audio_cb() ran before the kernels, for comparison
+static void float_music_volume( int16_t *samples, unsigned int count, float volume )
+{
+	for (unsigned int i = 0; i < count; ++i)
+		samples[i] *= volume;
+}
+
+static void float_sfx_add( int16_t *dst, const int16_t *src, unsigned int count, float volume )
+{
+	for (unsigned int i = 0; i < count; ++i)
+	{
+		int64_t clip = (int32_t)dst[i] + (int32_t)(src[i] * volume);
+		dst[i] = (clip > 0x7fff) ? 0x7fff : (clip <= -0x8000) ? -0x8000 : (int16_t)clip;
+	}
+}
+
+// volumes move the samples around enough that the loops can't be hoisted
+static volatile float music_volume = 0.9f, sample_volume = 0.1f;
+
+static void time_float_music( unsigned long blocks )
+{
+	for (unsigned long n = 0; n < blocks; ++n)
+		float_music_volume(block, BLOCK_SAMPLES, music_volume);
+}
+
+static void time_kernel_music( unsigned long blocks )
+{
+	for (unsigned long n = 0; n < blocks; ++n)
+		mix_scale_s16(block, BLOCK_SAMPLES, mix_gain_q15(music_volume));
+}
+
+static void time_float_sfx( unsigned long blocks )
+{
+	for (unsigned long n = 0; n < blocks; ++n)
+		float_sfx_add(block, sfx[n % CHANNELS], BLOCK_SAMPLES, sample_volume);
+}
+
+static void time_kernel_sfx( unsigned long blocks )
+{
+	for (unsigned long n = 0; n < blocks; ++n)
+		mix_add_s16(block, sfx[n % CHANNELS], BLOCK_SAMPLES);
+}
+
+static void time_float_mix( unsigned long blocks )
+{
+	for (unsigned long n = 0; n < blocks; ++n)
+	{
+		float_music_volume(block, BLOCK_SAMPLES, music_volume);
+		for (unsigned int ch = 0; ch < CHANNELS; ++ch)
+			float_sfx_add(block, sfx[ch], BLOCK_SAMPLES, sample_volume);
+	}
+}
+
+static void time_kernel_mix( unsigned long blocks )
+{
+	for (unsigned long n = 0; n < blocks; ++n)
+	{
+		mix_scale_s16(block, BLOCK_SAMPLES, mix_gain_q15(music_volume));
+		for (unsigned int ch = 0; ch < CHANNELS; ++ch)
+			mix_add_s16(block, sfx[ch], BLOCK_SAMPLES);
+	}
+}
+
+static const struct
+{
+	const char *name;
+	void (*float_loop)( unsigned long blocks );
+	void (*kernel_loop)( unsigned long blocks );
+} cases[] =
+{
+	{ "music volume",             time_float_music, time_kernel_music },
+	{ "sfx add, per channel",     time_float_sfx,   time_kernel_sfx },
+	{ "music + 8 channels",       time_float_mix,   time_kernel_mix },
+};
+
+int main( int argc, char *argv[] )
+{
+	unsigned long blocks = 20000;
+	unsigned int rounds = 10;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+			blocks = strtoul(argv[++i], NULL, 10);
+		else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc)
+			rounds = (unsigned int)atoi(argv[++i]);
+		else
+		{
+			fprintf(stderr, "usage: %s [-n blocks] [-r rounds]\n", argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (!check_kernels())
+		return EXIT_FAILURE;
+	printf("kernels match the reference\n");
+
+	fill(block, BLOCK_SAMPLES);
+	for (unsigned int ch = 0; ch < CHANNELS; ++ch)
+		fill(sfx[ch], BLOCK_SAMPLES);
+
+	// the float loop and the kernels take turns, so a busy host slows both
+	printf("\n%-22s %14s %14s\n", "", "float ns/smp", "kernels ns/smp");
+	for (unsigned int c = 0; c < sizeof(cases) / sizeof(*cases); ++c)
+	{
+		double float_best = 0, kernel_best = 0;
+
+		for (unsigned int round = 0; round < rounds; ++round)
+		{
+			double start = now_seconds();
+			cases[c].float_loop(blocks);
+			const double float_seconds = now_seconds() - start;
+
+			start = now_seconds();
+			cases[c].kernel_loop(blocks);
+			const double kernel_seconds = now_seconds() - start;
+
+			if (round == 0 || float_seconds < float_best)
+				float_best = float_seconds;
+			if (round == 0 || kernel_seconds < kernel_best)
+				kernel_best = kernel_seconds;
+		}
+
+		printf("%-22s %14.3f %14.3f\n", cases[c].name,
+		       float_best * 1e9 / (blocks * BLOCK_SAMPLES), kernel_best * 1e9 / (blocks * BLOCK_SAMPLES));
+	}
+
+	printf("(checksum %d)\n", block[lcg_sample() & (BLOCK_SAMPLES - 1)]);
+	return EXIT_SUCCESS;
+}
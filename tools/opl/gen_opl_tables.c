@@ -0,0 +1,118 @@
+/*
+ * OpenTyrian: A modern cross-platform port of Tyrian
+ * Copyright (C) 2007-2009  The OpenTyrian Development Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/*
+ * Writes components/OpenTyrian/opl_tables.h, the constant tables the
+ * fixed-point OPL emulator uses instead of building them in adlib_init().
+ * The formulas are the ones the floating point emulator uses, so both modes
+ * start from identical waveforms and tremolo steps.
+ *
+ *   cc -O2 -o gen_opl_tables tools/opl/gen_opl_tables.c -lm
+ *   ./gen_opl_tables > components/OpenTyrian/opl_tables.h
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#define WAVEPREC 1024
+#define TREMTAB_SIZE 53
+
+static void print_table( const char *decl, const long *values, int count, int per_line )
+{
+	printf("%s = {", decl);
+	for (int i = 0; i < count; i++)
+		printf("%s%ld,", i % per_line == 0 ? "\n\t" : " ", values[i]);
+	printf("\n};\n\n");
+}
+
+int main( void )
+{
+	long table[WAVEPREC * 3];
+
+	printf("/* generated by tools/opl/gen_opl_tables.c -- do not edit */\n");
+	printf("#ifndef OPL_TABLES_H\n#define OPL_TABLES_H\n\n");
+
+	// waveforms, exactly as adlib_init() builds wavtable
+	int16_t wavtable[WAVEPREC * 3] = { 0 };
+	for (int i = 0; i < (WAVEPREC >> 1); i++)
+	{
+		wavtable[(i << 1) + WAVEPREC]     = (int16_t)(16384 * sin((double)((i << 1)) * M_PI * 2 / WAVEPREC));
+		wavtable[(i << 1) + 1 + WAVEPREC] = (int16_t)(16384 * sin((double)((i << 1) + 1) * M_PI * 2 / WAVEPREC));
+		wavtable[i]                       = wavtable[(i << 1) + WAVEPREC];
+	}
+	for (int i = 0; i < (WAVEPREC >> 3); i++)
+	{
+		wavtable[i + (WAVEPREC << 1)]         = wavtable[i + (WAVEPREC >> 3)] - 16384;
+		wavtable[i + ((WAVEPREC * 17) >> 3)] = wavtable[i + (WAVEPREC >> 2)] + 16384;
+	}
+	for (int i = 0; i < WAVEPREC * 3; i++)
+		table[i] = wavtable[i];
+	print_table("DRAM_ATTR static const Bit16s wavtable[WAVEPREC*3]", table, WAVEPREC * 3, 16);
+
+	// vibrato steps
+	static const long vib[8] = { 8, 4, 0, -4, -8, -4, 0, 4 };
+	print_table("static const Bit32s vib_table[VIBTAB_SIZE]", vib, 8, 8);
+
+	// tremolo: 4.8 dB and 1.2 dB depth, in 16.16
+	int trem_table_int[TREMTAB_SIZE];
+	for (int i = 0; i < 14; i++)  trem_table_int[i] = i - 13;
+	for (int i = 14; i < 41; i++) trem_table_int[i] = -i + 14;
+	for (int i = 41; i < 53; i++) trem_table_int[i] = i - 40 - 26;
+	for (int i = 0; i < TREMTAB_SIZE; i++)
+	{
+		double trem_val1 = (double)trem_table_int[i] * 4.8 / 26.0 / 6.0;
+		double trem_val2 = (double)(trem_table_int[i] / 4) * 1.2 / 6.0 / 6.0;
+		table[i]                = (int32_t)(pow(2.0, trem_val1) * 0x10000);
+		table[TREMTAB_SIZE + i] = (int32_t)(pow(2.0, trem_val2) * 0x10000);
+	}
+	print_table("static const Bit32s trem_table[TREMTAB_SIZE*2]", table, TREMTAB_SIZE * 2, 8);
+
+	// key scale levels
+	long kslev[8][16];
+	static const long kslev7[9] = { 0, 24, 32, 37, 40, 43, 45, 47, 48 };
+	for (int i = 0; i < 16; i++)
+		kslev[7][i] = i < 9 ? kslev7[i] : i + 41;
+	for (int j = 6; j >= 0; j--)
+		for (int i = 0; i < 16; i++)
+			kslev[j][i] = kslev[j + 1][i] - 8 < 0 ? 0 : kslev[j + 1][i] - 8;
+	printf("static const Bit8u kslev[8][16] = {\n");
+	for (int j = 0; j < 8; j++)
+	{
+		printf("\t{");
+		for (int i = 0; i < 16; i++)
+			printf("%s%ld", i ? ", " : " ", kslev[j][i]);
+		printf(" },\n");
+	}
+	printf("};\n\n");
+
+	// sustain levels 2^(-sl/2), envelope fixed point
+	for (int i = 0; i < 16; i++)
+		table[i] = i < 15 ? lround(pow(2.0, i * -0.5) * (1 << 30)) : 0;
+	print_table("static const Bit32s sustain_levels[16]", table, 16, 8);
+
+	// operator volume 2^(-q/32) for the low five bits of the quarter-step
+	// attenuation, 2.30 fixed point; the rest is a shift
+	for (int i = 0; i < 32; i++)
+		table[i] = lround(pow(2.0, i / -32.0) * (1 << 30));
+	print_table("static const Bit32s vol_mantissa[32]", table, 32, 8);
+
+	printf("#endif /* OPL_TABLES_H */\n");
+	return 0;
+}
@@ -0,0 +1,393 @@
+/*
+ * OpenTyrian: A modern cross-platform port of Tyrian
+ * Copyright (C) 2007-2009  The OpenTyrian Development Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/*
+ * The tables in palette_lut.c, and the one it dropped, against the nibble
+ * arithmetic they replaced, in the loops the game runs them in:
+ *
+ *   cc -O2 -Itools/host -Icomponents/OpenTyrian -o palette_lut_bench \
+ *      tools/palette/palette_lut_bench.c components/OpenTyrian/palette_lut.c
+ *
+ *   ./palette_lut_bench [-n trials] [-f frames] [-r rounds]
+ *
+ * Add -fno-tree-vectorize to see the arithmetic as a core without SIMD runs
+ * it; the ESP32 compilers do not vectorise these loops.
+ *
+ *   halve       blit_sprite_dark and blit_sprite2_darken: short runs of
+ *               sprite pixels scattered over the screen
+ *   light       the JE_starShowVGA lighting loop, with the light cone
+ *               somewhere on the playfield
+ *   darken      JE_darkenBackground, dither and all, against the table it
+ *               no longer uses
+ *   brightness  the JE_filterScreen brightness loop
+ *
+ * Every effect is run both ways on trials random screens with random
+ * parameters, and any byte that differs fails the run.  The timing runs
+ * each frames times on one screen and reports us per frame, the best of
+ * rounds rounds (five by default) taken in turn with the other side.
+ */
+
+#include "palette_lut.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define PITCH 320
+#define ROWS 200
+#define HALVE_RUNS 1500
+
+static Uint8 src[ROWS][PITCH], alu_screen[ROWS][PITCH], lut_screen[ROWS][PITCH];
+
+// the table palette_lut.c kept for JE_darkenBackground until this timed it
+// slower than the arithmetic: brightness * 15/16 plus a 0..15 dither term
+static Uint8 palette_lut_darken[16][256];
+
+// the sprite runs halve touches: offset into the screen and length
+static struct { unsigned int offset, length; } runs[HALVE_RUNS];
+
+// what a frame of each effect depends on besides the screen
+typedef struct
+{
+	int light_x, light_y;
+	unsigned int neat;
+	int delta;
+}
+EffectArgs;
+
+static uint32_t lcg_state = 0x2545f491;
+
+static uint32_t lcg( void )
+{
+	lcg_state = lcg_state * 1103515245 + 12345;
+	return lcg_state >> 8;
+}
+
+static double now_seconds( void )
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void random_screen( void )
+{
+	for (int y = 0; y < ROWS; ++y)
+		for (int x = 0; x < PITCH; ++x)
+			src[y][x] = (Uint8)lcg();
+
+	// sprite rows broken up by transparent pixels
+	for (unsigned int i = 0; i < HALVE_RUNS; ++i)
+	{
+		runs[i].length = 1 + lcg() % 16;
+		runs[i].offset = lcg() % (PITCH * ROWS - runs[i].length);
+	}
+}
+
+static EffectArgs random_args( void )
+{
+	return (EffectArgs)
+	{
+		.light_x = 281 - (int)(lcg() % 264),
+		.light_y = 172 - (int)(lcg() % 184),
+		.neat = lcg() & 0xffff,
+		.delta = (int)(lcg() % 64) - 24,
+	};
+}
+
+/* halve */
+
+static void halve_alu( Uint8 *screen, const EffectArgs *args )
+{
+	(void)args;
+	for (unsigned int i = 0; i < HALVE_RUNS; ++i)
+	{
+		Uint8 *pixels = screen + runs[i].offset;
+		for (unsigned int length = runs[i].length; length > 0; --length, ++pixels)
+			*pixels = (*pixels & 0xf0) | ((*pixels & 0x0f) / 2);
+	}
+}
+
+static void halve_lut( Uint8 *screen, const EffectArgs *args )
+{
+	(void)args;
+	for (unsigned int i = 0; i < HALVE_RUNS; ++i)
+	{
+		Uint8 *pixels = screen + runs[i].offset;
+		for (unsigned int length = runs[i].length; length > 0; --length, ++pixels)
+			*pixels = palette_lut_halve[*pixels];
+	}
+}
+
+/* light, from game_screen's playfield (src) into the screen */
+
+static void light_alu( Uint8 *screen, const EffectArgs *args )
+{
+	const Uint8 *s_src = &src[0][24];
+	Uint8 *s = screen;
+
+	for (int y = 184; y; y--)
+	{
+		if (args->light_y > y)
+		{
+			for (int x = 320 - 56; x; x--)
+			{
+				*s = (*s_src & 0xf0) | ((*s_src >> 2) & 0x03);
+				s++;
+				s_src++;
+			}
+		}
+		else
+		{
+			for (int x = 320 - 56; x; x--)
+			{
+				const int lightdist = abs(args->light_x - x) + args->light_y;
+				if (lightdist < y)
+					*s = *s_src;
+				else if (lightdist - y <= 5)
+					*s = (*s_src & 0xf0) | (((*s_src & 0x0f) + (3 * (5 - (lightdist - y)))) / 4);
+				else
+					*s = (*s_src & 0xf0) | ((*s_src & 0x0f) >> 2);
+				s++;
+				s_src++;
+			}
+		}
+		s += 56;
+		s_src += 56;
+	}
+}
+
+static void light_lut( Uint8 *screen, const EffectArgs *args )
+{
+	const Uint8 *s_src = &src[0][24];
+	Uint8 *s = screen;
+
+	for (int y = 184; y; y--)
+	{
+		if (args->light_y > y)
+		{
+			for (int x = 320 - 56; x; x--)
+			{
+				*s = palette_lut_light[PALETTE_LUT_LIGHT_EDGE][*s_src];
+				s++;
+				s_src++;
+			}
+		}
+		else
+		{
+			for (int x = 320 - 56; x; x--)
+			{
+				const int lightdist = abs(args->light_x - x) + args->light_y;
+				if (lightdist < y)
+					*s = *s_src;
+				else if (lightdist - y <= PALETTE_LUT_LIGHT_EDGE)
+					*s = palette_lut_light[lightdist - y][*s_src];
+				else
+					*s = palette_lut_light[PALETTE_LUT_LIGHT_EDGE][*s_src];
+				s++;
+				s_src++;
+			}
+		}
+		s += 56;
+		s_src += 56;
+	}
+}
+
+/* darken, in place */
+
+static void darken_alu( Uint8 *screen, const EffectArgs *args )
+{
+	Uint8 *s = screen + 24;
+
+	for (int y = 184; y; y--)
+	{
+		for (int x = 264; x; x--)
+		{
+			*s = ((((*s & 0x0f) << 4) - (*s & 0x0f) + ((((x - (int)args->neat - y) >> 2) + *(s-2) + (y == 184 ? 0 : *(s-(PITCH-1)))) & 0x0f)) >> 4) | (*s & 0xf0);
+			s++;
+		}
+		s += PITCH - 264;
+	}
+}
+
+static void darken_lut( Uint8 *screen, const EffectArgs *args )
+{
+	Uint8 *s = screen + 24;
+
+	for (int y = 184; y; y--)
+	{
+		for (int x = 264; x; x--)
+		{
+			*s = palette_lut_darken[(((x - (int)args->neat - y) >> 2) + *(s-2) + (y == 184 ? 0 : *(s-(PITCH-1)))) & 0x0f][*s];
+			s++;
+		}
+		s += PITCH - 264;
+	}
+}
+
+/* brightness, in place */
+
+static void brightness_alu( Uint8 *screen, const EffectArgs *args )
+{
+	Uint8 *s = screen + 24;
+
+	for (int y = 184; y; y--)
+	{
+		for (int x = 264; x; x--)
+		{
+			const unsigned int temp = (*s & 0x0f) + args->delta;
+			*s = (*s & 0xf0) | (temp >= 0x1f ? 0 : (temp >= 0x0f ? 0x0f : temp));
+			s++;
+		}
+		s += PITCH - 264;
+	}
+}
+
+static void brightness_lut( Uint8 *screen, const EffectArgs *args )
+{
+	Uint8 *s = screen + 24;
+
+	const Uint8 *lut = palette_lut_brightness(args->delta);
+
+	for (int y = 184; y; y--)
+	{
+		for (int x = 264; x; x--)
+		{
+			*s = lut[*s];
+			s++;
+		}
+		s += PITCH - 264;
+	}
+}
+
+typedef void (*Effect)( Uint8 *screen, const EffectArgs *args );
+
+static const struct
+{
+	const char *name;
+	Effect alu, lut;
+}
+effects[] =
+{
+	{ "halve", halve_alu, halve_lut },
+	{ "light", light_alu, light_lut },
+	{ "darken", darken_alu, darken_lut },
+	{ "brightness", brightness_alu, brightness_lut },
+};
+
+static bool check( size_t e, unsigned int trials )
+{
+	unsigned int mismatches = 0;
+
+	for (unsigned int t = 0; t < trials; ++t)
+	{
+		random_screen();
+		const EffectArgs args = random_args();
+
+		memcpy(alu_screen, src, sizeof(src));
+		memcpy(lut_screen, src, sizeof(src));
+		effects[e].alu(&alu_screen[0][0], &args);
+		effects[e].lut(&lut_screen[0][0], &args);
+
+		if (memcmp(alu_screen, lut_screen, sizeof(alu_screen)) != 0)
+		{
+			if (mismatches++ < 10)
+				fprintf(stderr, "mismatch: %s trial %u (light %d,%d neat %u delta %d)\n", effects[e].name, t,
+				        args.light_x, args.light_y, args.neat, args.delta);
+		}
+	}
+
+	printf("%s: %u of %u screens match the arithmetic\n", effects[e].name, trials - mismatches, trials);
+	return mismatches == 0;
+}
+
+// seconds per frame of one round
+static double frame_time( Effect effect, const EffectArgs *args, unsigned int frames )
+{
+	memcpy(alu_screen, src, sizeof(src));
+
+	const double start = now_seconds();
+	for (unsigned int frame = 0; frame < frames; ++frame)
+		effect(&alu_screen[0][0], args);
+	return (now_seconds() - start) / frames;
+}
+
+// seconds per frame both ways in the fastest of rounds rounds; the two
+// alternate, so a busy spell on the host lands on both
+static void time_effect( size_t e, const EffectArgs *args, unsigned int frames, unsigned int rounds, double *alu, double *lut )
+{
+	for (unsigned int round = 0; round < rounds; ++round)
+	{
+		const double alu_seconds = frame_time(effects[e].alu, args, frames),
+		             lut_seconds = frame_time(effects[e].lut, args, frames);
+
+		if (round == 0 || alu_seconds < *alu)
+			*alu = alu_seconds;
+		if (round == 0 || lut_seconds < *lut)
+			*lut = lut_seconds;
+	}
+}
+
+int main( int argc, char *argv[] )
+{
+	unsigned int trials = 200, frames = 500, rounds = 5;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+			trials = (unsigned int)atoi(argv[++i]);
+		else if (strcmp(argv[i], "-f") == 0 && i + 1 < argc)
+			frames = (unsigned int)atoi(argv[++i]);
+		else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc)
+			rounds = (unsigned int)atoi(argv[++i]);
+		else
+		{
+			fprintf(stderr, "usage: %s [-n trials] [-f frames] [-r rounds]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	init_palette_luts();
+	for (unsigned int i = 0; i < 256; ++i)
+		for (unsigned int k = 0; k < 16; ++k)
+			palette_lut_darken[k][i] = (i & 0xf0) | ((((i & 0x0f) << 4) - (i & 0x0f) + k) >> 4);
+
+	bool matches = true;
+	for (size_t e = 0; e < COUNTOF(effects); ++e)
+		matches &= check(e, trials);
+
+	lcg_state = 0x2545f491;  // the same screen to time whatever trials is
+	random_screen();
+	EffectArgs args = random_args();
+	args.light_x = 150;  // the cone in the middle of the playfield
+	args.light_y = 40;
+	args.delta = 5;
+
+	printf("\n%-12s %10s %10s %8s\n", "effect", "alu us", "lut us", "speedup");
+	for (size_t e = 0; e < COUNTOF(effects); ++e)
+	{
+		double alu = 0, lut = 0;
+		time_effect(e, &args, frames, rounds, &alu, &lut);
+		printf("%-12s %10.2f %10.2f %7.2fx\n", effects[e].name, alu * 1e6, lut * 1e6, alu / lut);
+	}
+
+	return !matches;
+}
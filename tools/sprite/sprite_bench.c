@@ -0,0 +1,601 @@
+/*
+ * OpenTyrian: A modern cross-platform port of Tyrian
+ * Copyright (C) 2007-2009  The OpenTyrian Development Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/*
+ * Correctness check and timing for the span lists load_sprites() and
+ * JE_loadCompShapesB() compile, against the RLE decoders the blitters fall
+ * back to, on the real sprites in tyrian.shp:
+ *
+ *   cc -O2 -Itools/host -Icomponents/OpenTyrian -o sprite_bench \
+ *      tools/sprite/sprite_bench.c components/OpenTyrian/sprite.c \
+ *      components/OpenTyrian/file.c components/OpenTyrian/palette_lut.c \
+ *      tools/host/sdl_headless.c
+ *
+ *   ./sprite_bench [-d data_dir] [-n trials] [-f frames]
+ *
+ * Every sprite of the seven Sprite tables and the five Sprite2 tables in
+ * tyrian.shp is drawn with every blitter trials times, at positions that
+ * reach past all four edges of the screen, with random hue, value and filter
+ * arguments: once from its spans and once with the spans hidden, so the
+ * decoder draws it, onto screens filled with the same random pixels.  Any
+ * byte that differs fails the run.  blit_sprite_hv_unsafe is only drawn
+ * where it fits, as the game does.
+ *
+ * Two made-up Sprite2 arrays check the 16-bit span offsets: one whose last
+ * sprite ends just inside 64 KiB must get spans, and one whose last sprite
+ * runs past it must fall back to the decoder.  Both must draw that sprite
+ * the same.
+ *
+ * The same draws are then repeated with a random clip rectangle set on both
+ * screens through set_blit_clip(): the spans must still match the decoder,
+ * and no byte outside the rectangle may change.
+ *
+ * The timing draws each whole table at on-screen positions frames times per
+ * blitter and reports ns per sprite for the decoder and for the spans.
+ */
+
+#include "file.h"
+#include "palette_lut.h"
+#include "sprite.h"
+#include "video.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// the globals sprite.c and file.c link against, which the game defines elsewhere
+SDL_Surface *VGAScreen;
+
+void JE_tyrianHalt( JE_byte code )
+{
+	exit(code);
+}
+
+enum
+{
+	BLIT_SPRITE,
+	BLIT_SPRITE_BLEND,
+	BLIT_SPRITE_HV_UNSAFE,
+	BLIT_SPRITE_HV,
+	BLIT_SPRITE_HV_BLEND,
+	BLIT_SPRITE_DARK,
+	SPRITE_BLITTERS
+};
+
+static const char * const sprite_blitter_names[SPRITE_BLITTERS] =
+{
+	"blit_sprite",
+	"blit_sprite_blend",
+	"blit_sprite_hv_unsafe",
+	"blit_sprite_hv",
+	"blit_sprite_hv_blend",
+	"blit_sprite_dark",
+};
+
+enum
+{
+	BLIT_SPRITE2,
+	BLIT_SPRITE2_BLEND,
+	BLIT_SPRITE2_DARKEN,
+	BLIT_SPRITE2_FILTER,
+	SPRITE2_BLITTERS
+};
+
+static const char * const sprite2_blitter_names[SPRITE2_BLITTERS] =
+{
+	"blit_sprite2",
+	"blit_sprite2_blend",
+	"blit_sprite2_darken",
+	"blit_sprite2_filter",
+};
+
+static Sprite2_array * const sprite2_tables[] =
+{
+	&shapesC1, &shapes9, &eShapes[5], &eShapes[4], &shapesW2,
+};
+
+typedef struct
+{
+	Uint8 hue;
+	Sint8 value;
+	bool black;
+	Uint8 filter;
+}
+BlitArgs;
+
+static uint32_t lcg_state = 0x2545f491;
+
+static uint32_t lcg( void )
+{
+	lcg_state = lcg_state * 1103515245 + 12345;
+	return lcg_state >> 8;
+}
+
+static double now_seconds( void )
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static BlitArgs random_args( void )
+{
+	return (BlitArgs)
+	{
+		.hue = lcg() % 16,
+		.value = (Sint8)(lcg() % 9) - 4,
+		.black = lcg() & 1,
+		.filter = lcg() & 0xff,
+	};
+}
+
+static void draw_sprite( int blitter, SDL_Surface *surface, int x, int y, unsigned int table, unsigned int index, const BlitArgs *args )
+{
+	switch (blitter)
+	{
+	case BLIT_SPRITE:
+		blit_sprite(surface, x, y, table, index);
+		break;
+	case BLIT_SPRITE_BLEND:
+		blit_sprite_blend(surface, x, y, table, index);
+		break;
+	case BLIT_SPRITE_HV_UNSAFE:
+		blit_sprite_hv_unsafe(surface, x, y, table, index, args->hue, args->value);
+		break;
+	case BLIT_SPRITE_HV:
+		blit_sprite_hv(surface, x, y, table, index, args->hue, args->value);
+		break;
+	case BLIT_SPRITE_HV_BLEND:
+		blit_sprite_hv_blend(surface, x, y, table, index, args->hue, args->value);
+		break;
+	case BLIT_SPRITE_DARK:
+		blit_sprite_dark(surface, x, y, table, index, args->black);
+		break;
+	}
+}
+
+static void draw_sprite2( int blitter, SDL_Surface *surface, int x, int y, Sprite2_array sprite2s, unsigned int index, const BlitArgs *args )
+{
+	switch (blitter)
+	{
+	case BLIT_SPRITE2:
+		blit_sprite2(surface, x, y, sprite2s, index);
+		break;
+	case BLIT_SPRITE2_BLEND:
+		blit_sprite2_blend(surface, x, y, sprite2s, index);
+		break;
+	case BLIT_SPRITE2_DARKEN:
+		blit_sprite2_darken(surface, x, y, sprite2s, index);
+		break;
+	case BLIT_SPRITE2_FILTER:
+		blit_sprite2_filter(surface, x, y, sprite2s, index, args->filter);
+		break;
+	}
+}
+
+static void fill_screens( SDL_Surface *a, SDL_Surface *b )
+{
+	Uint8 *pa = a->pixels, *pb = b->pixels;
+	for (int i = 0; i < a->pitch * a->h; ++i)
+		pa[i] = pb[i] = (Uint8)lcg();
+}
+
+static bool same_screens( const SDL_Surface *a, const SDL_Surface *b )
+{
+	return memcmp(a->pixels, b->pixels, a->pitch * a->h) == 0;
+}
+
+static unsigned int check_sprites( SDL_Surface *spans, SDL_Surface *decoded, unsigned int trials )
+{
+	unsigned int mismatches = 0, draws = 0;
+
+	for (unsigned int table = 0; table < 7; ++table)
+	{
+		for (unsigned int index = 0; index < sprite_table[table].count; ++index)
+		{
+			Sprite * const cur_sprite = sprite(table, index);
+			if (cur_sprite->data == NULL)
+				continue;
+
+			const int w = cur_sprite->width, h = cur_sprite->height;
+
+			for (int blitter = 0; blitter < SPRITE_BLITTERS; ++blitter)
+			{
+				for (unsigned int t = 0; t < trials; ++t)
+				{
+					int x, y;
+					if (blitter == BLIT_SPRITE_HV_UNSAFE)
+					{
+						if (w > spans->w || h > spans->h)
+							break;
+						x = lcg() % (spans->w - w + 1);
+						y = lcg() % (spans->h - h + 1);
+					}
+					else
+					{
+						x = (int)(lcg() % (spans->w + 2 * w)) - 2 * w + w / 2 + 1;
+						y = (int)(lcg() % (spans->h + 2 * h)) - 2 * h + h / 2 + 1;
+					}
+					const BlitArgs args = random_args();
+
+					fill_screens(spans, decoded);
+
+					draw_sprite(blitter, spans, x, y, table, index, &args);
+
+					SpriteSpan * const saved = cur_sprite->spans;
+					cur_sprite->spans = NULL;
+					draw_sprite(blitter, decoded, x, y, table, index, &args);
+					cur_sprite->spans = saved;
+
+					draws++;
+					if (!same_screens(spans, decoded))
+					{
+						if (mismatches++ < 10)
+							fprintf(stderr, "mismatch: %s table %u sprite %u at %d,%d\n",
+							        sprite_blitter_names[blitter], table, index, x, y);
+					}
+				}
+			}
+		}
+	}
+
+	printf("%u of %u Sprite draws match the decoder\n", draws - mismatches, draws);
+	return mismatches;
+}
+
+static unsigned int check_sprite2s( SDL_Surface *spans, SDL_Surface *decoded, unsigned int trials )
+{
+	unsigned int mismatches = 0, draws = 0;
+
+	for (size_t table = 0; table < COUNTOF(sprite2_tables); ++table)
+	{
+		const Sprite2_array sprite2s = *sprite2_tables[table];
+		Sprite2_array without_spans = sprite2s;
+		without_spans.spans = NULL;
+
+		// sprite2s are 12x14 pixels, so a 16-pixel margin reaches past every edge
+		for (unsigned int index = 1; index <= sprite2s.sprite_count; ++index)
+		{
+			for (int blitter = 0; blitter < SPRITE2_BLITTERS; ++blitter)
+			{
+				for (unsigned int t = 0; t < trials; ++t)
+				{
+					const int x = (int)(lcg() % (spans->w + 32)) - 16,
+					          y = (int)(lcg() % (spans->h + 32)) - 16;
+					const BlitArgs args = random_args();
+
+					fill_screens(spans, decoded);
+
+					draw_sprite2(blitter, spans, x, y, sprite2s, index, &args);
+					draw_sprite2(blitter, decoded, x, y, without_spans, index, &args);
+
+					draws++;
+					if (!same_screens(spans, decoded))
+					{
+						if (mismatches++ < 10)
+							fprintf(stderr, "mismatch: %s table %zu sprite %u at %d,%d\n",
+							        sprite2_blitter_names[blitter], table, index, x, y);
+					}
+				}
+			}
+		}
+	}
+
+	printf("%u of %u Sprite2 draws match the decoder\n", draws - mismatches, draws);
+	return mismatches;
+}
+
+// Loads a Sprite2_array whose second sprite, a 12x14 block of every colour,
+// starts at second_offset.
+static Sprite2_array load_block_sprite2s( unsigned int second_offset )
+{
+	enum { ROWS = 14, ROW_BYTES = 1 + 12 + 1 };
+	const unsigned int size = second_offset + ROWS * ROW_BYTES + 1;
+	Uint8 *data = calloc(size, 1);
+
+	((Uint16 *)data)[0] = SDL_Swap16LE(4);
+	((Uint16 *)data)[1] = SDL_Swap16LE(second_offset);
+	data[4] = 0x0f;  // the first sprite is empty
+
+	Uint8 *p = data + second_offset;
+	for (int row = 0; row < ROWS; ++row)
+	{
+		*p++ = 0xc0;  // twelve opaque pixels
+		for (int i = 0; i < 12; ++i)
+			*p++ = (Uint8)(row * 12 + i + 1);
+		*p++ = 0x00;  // next row
+	}
+	*p = 0x0f;
+
+	FILE *f = tmpfile();
+	fwrite(data, 1, size, f);
+	rewind(f);
+	free(data);
+
+	Sprite2_array sprite2s = { .size = size };
+	JE_loadCompShapesB(&sprite2s, f);
+	fclose(f);
+	return sprite2s;
+}
+
+static unsigned int check_large_sprite2s( SDL_Surface *spans, SDL_Surface *decoded )
+{
+	unsigned int failed = 0;
+
+	Sprite2_array fits = load_block_sprite2s(65536 - 14 * 14 - 1),
+	              too_large = load_block_sprite2s(65500);
+
+	if (fits.size != 65536 || fits.spans == NULL)
+	{
+		fprintf(stderr, "a %u-byte Sprite2 array got no spans\n", fits.size);
+		failed++;
+	}
+	if (too_large.spans != NULL)
+	{
+		fprintf(stderr, "a %u-byte Sprite2 array got spans with truncated offsets\n", too_large.size);
+		failed++;
+	}
+
+	for (int blitter = 0; blitter < SPRITE2_BLITTERS; ++blitter)
+	{
+		const BlitArgs args = random_args();
+
+		fill_screens(spans, decoded);
+		draw_sprite2(blitter, spans, 100, 100, fits, 2, &args);
+		draw_sprite2(blitter, decoded, 100, 100, too_large, 2, &args);
+
+		if (!same_screens(spans, decoded))
+		{
+			fprintf(stderr, "mismatch: %s draws a sprite past 64 KiB differently\n", sprite2_blitter_names[blitter]);
+			failed++;
+		}
+	}
+
+	free_sprite2s(&fits);
+	free_sprite2s(&too_large);
+
+	printf("%s\n", failed ? "Sprite2 arrays over 64 KiB are mishandled" : "Sprite2 arrays over 64 KiB fall back to the decoder");
+	return failed;
+}
+
+// the bytes outside clip that differ between a and b
+static unsigned int changed_outside( const SDL_Surface *a, const SDL_Surface *b, const SDL_Rect *clip )
+{
+	unsigned int changed = 0;
+	for (int y = 0; y < a->h; ++y)
+		for (int x = 0; x < a->w; ++x)
+			if ((x < clip->x || x >= clip->x + clip->w || y < clip->y || y >= clip->y + clip->h) &&
+			    ((Uint8 *)a->pixels)[y * a->pitch + x] != ((Uint8 *)b->pixels)[y * b->pitch + x])
+				changed++;
+	return changed;
+}
+
+static unsigned int check_clipped( SDL_Surface *spans, SDL_Surface *decoded, unsigned int trials )
+{
+	SDL_Surface *before = SDL_CreateSurface(spans->w, spans->h, SDL_PIXELFORMAT_INDEX8);
+	unsigned int mismatches = 0, draws = 0;
+
+	for (unsigned int t = 0; t < trials * 200; ++t)
+	{
+		SDL_Rect clip;
+		clip.x = lcg() % spans->w;
+		clip.y = lcg() % spans->h;
+		clip.w = 1 + lcg() % (spans->w - clip.x);
+		clip.h = 1 + lcg() % (spans->h - clip.y);
+		set_blit_clip(spans, &clip);
+		set_blit_clip(decoded, &clip);
+
+		fill_screens(spans, decoded);
+		memcpy(before->pixels, spans->pixels, spans->pitch * spans->h);
+
+		const BlitArgs args = random_args();
+		const char *name;
+		unsigned int table, index;
+		int x, y;
+
+		if (lcg() & 1)
+		{
+			table = lcg() % 7;
+			if (sprite_table[table].count == 0)
+				continue;
+			index = lcg() % sprite_table[table].count;
+			Sprite * const cur_sprite = sprite(table, index);
+			if (cur_sprite->data == NULL)
+				continue;
+
+			int blitter = lcg() % SPRITE_BLITTERS;
+			if (blitter == BLIT_SPRITE_HV_UNSAFE)
+				blitter = BLIT_SPRITE_HV;  // only drawn where it fits the screen
+			name = sprite_blitter_names[blitter];
+
+			const int w = cur_sprite->width, h = cur_sprite->height;
+			x = clip.x + (int)(lcg() % (clip.w + 2 * w)) - 2 * w + w / 2 + 1;
+			y = clip.y + (int)(lcg() % (clip.h + 2 * h)) - 2 * h + h / 2 + 1;
+
+			draw_sprite(blitter, spans, x, y, table, index, &args);
+
+			SpriteSpan * const saved = cur_sprite->spans;
+			cur_sprite->spans = NULL;
+			draw_sprite(blitter, decoded, x, y, table, index, &args);
+			cur_sprite->spans = saved;
+		}
+		else
+		{
+			table = lcg() % COUNTOF(sprite2_tables);
+			const Sprite2_array sprite2s = *sprite2_tables[table];
+			Sprite2_array without_spans = sprite2s;
+			without_spans.spans = NULL;
+			index = 1 + lcg() % sprite2s.sprite_count;
+
+			const int blitter = lcg() % SPRITE2_BLITTERS;
+			name = sprite2_blitter_names[blitter];
+
+			x = clip.x + (int)(lcg() % (clip.w + 32)) - 16;
+			y = clip.y + (int)(lcg() % (clip.h + 32)) - 16;
+
+			draw_sprite2(blitter, spans, x, y, sprite2s, index, &args);
+			draw_sprite2(blitter, decoded, x, y, without_spans, index, &args);
+		}
+
+		draws++;
+		if (!same_screens(spans, decoded) || changed_outside(spans, before, &clip) != 0)
+		{
+			if (mismatches++ < 10)
+				fprintf(stderr, "mismatch: %s table %u sprite %u at %d,%d clipped to %d,%d %dx%d\n",
+				        name, table, index, x, y, clip.x, clip.y, clip.w, clip.h);
+		}
+	}
+
+	set_blit_clip(spans, NULL);
+	set_blit_clip(decoded, NULL);
+	SDL_DestroySurface(before);
+
+	printf("%u of %u clipped draws match the decoder and stay inside the clip\n", draws - mismatches, draws);
+	return mismatches;
+}
+
+static double time_sprites( SDL_Surface *surface, int blitter, bool use_spans, unsigned int frames, unsigned int *draws )
+{
+	const BlitArgs args = { .hue = 5, .value = 2, .black = false, .filter = 0x85 };
+
+	SpriteSpan *saved[7][SPRITES_PER_TABLE_MAX];
+	for (unsigned int table = 0; table < 7; ++table)
+	{
+		for (unsigned int index = 0; index < sprite_table[table].count; ++index)
+		{
+			saved[table][index] = sprite(table, index)->spans;
+			if (!use_spans)
+				sprite(table, index)->spans = NULL;
+		}
+	}
+
+	*draws = 0;
+	const double start = now_seconds();
+	for (unsigned int frame = 0; frame < frames; ++frame)
+	{
+		for (unsigned int table = 0; table < 7; ++table)
+		{
+			for (unsigned int index = 0; index < sprite_table[table].count; ++index)
+			{
+				const Sprite * const cur_sprite = sprite(table, index);
+				if (cur_sprite->data == NULL || cur_sprite->width > surface->w || cur_sprite->height > surface->h)
+					continue;
+
+				const int x = (index * 37 + frame) % (surface->w - cur_sprite->width + 1),
+				          y = (index * 23 + table * 11) % (surface->h - cur_sprite->height + 1);
+				draw_sprite(blitter, surface, x, y, table, index, &args);
+				(*draws)++;
+			}
+		}
+	}
+	const double seconds = now_seconds() - start;
+
+	for (unsigned int table = 0; table < 7; ++table)
+		for (unsigned int index = 0; index < sprite_table[table].count; ++index)
+			sprite(table, index)->spans = saved[table][index];
+
+	return seconds;
+}
+
+static double time_sprite2s( SDL_Surface *surface, int blitter, bool use_spans, unsigned int frames, unsigned int *draws )
+{
+	const BlitArgs args = { .hue = 5, .value = 2, .black = false, .filter = 0x85 };
+
+	*draws = 0;
+	const double start = now_seconds();
+	for (unsigned int frame = 0; frame < frames; ++frame)
+	{
+		for (size_t table = 0; table < COUNTOF(sprite2_tables); ++table)
+		{
+			Sprite2_array sprite2s = *sprite2_tables[table];
+			if (!use_spans)
+				sprite2s.spans = NULL;
+
+			for (unsigned int index = 1; index <= sprite2s.sprite_count; ++index)
+			{
+				const int x = (index * 37 + frame) % (surface->w - 12),
+				          y = (index * 23 + table * 11) % (surface->h - 14);
+				draw_sprite2(blitter, surface, x, y, sprite2s, index, &args);
+				(*draws)++;
+			}
+		}
+	}
+	return now_seconds() - start;
+}
+
+int main( int argc, char *argv[] )
+{
+	const char *dir = "data/tyrian/data";
+	unsigned int trials = 20, frames = 200;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		if (strcmp(argv[i], "-d") == 0 && i + 1 < argc)
+			dir = argv[++i];
+		else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+			trials = (unsigned int)atoi(argv[++i]);
+		else if (strcmp(argv[i], "-f") == 0 && i + 1 < argc)
+			frames = (unsigned int)atoi(argv[++i]);
+		else
+		{
+			fprintf(stderr, "usage: %s [-d data_dir] [-n trials] [-f frames]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	custom_data_dir = dir;
+	init_palette_luts();
+
+	SDL_Surface *spans = SDL_CreateSurface(320, 200, SDL_PIXELFORMAT_INDEX8),
+	            *decoded = SDL_CreateSurface(320, 200, SDL_PIXELFORMAT_INDEX8);
+	VGAScreen = spans;
+
+	JE_loadMainShapeTables("tyrian.shp");
+
+	unsigned int failed = 0;
+	failed += check_sprites(spans, decoded, trials);
+	failed += check_sprite2s(spans, decoded, trials);
+	failed += check_large_sprite2s(spans, decoded);
+	failed += check_clipped(spans, decoded, trials);
+
+	printf("\n%-24s %12s %12s %8s\n", "blitter", "decoder ns", "spans ns", "speedup");
+
+	for (int blitter = 0; blitter < SPRITE_BLITTERS; ++blitter)
+	{
+		unsigned int draws;
+		const double decoder = time_sprites(spans, blitter, false, frames, &draws) * 1e9 / draws,
+		             span = time_sprites(spans, blitter, true, frames, &draws) * 1e9 / draws;
+		printf("%-24s %12.1f %12.1f %7.2fx\n", sprite_blitter_names[blitter], decoder, span, decoder / span);
+	}
+	for (int blitter = 0; blitter < SPRITE2_BLITTERS; ++blitter)
+	{
+		unsigned int draws;
+		const double decoder = time_sprite2s(spans, blitter, false, frames, &draws) * 1e9 / draws,
+		             span = time_sprite2s(spans, blitter, true, frames, &draws) * 1e9 / draws;
+		printf("%-24s %12.1f %12.1f %7.2fx\n", sprite2_blitter_names[blitter], decoder, span, decoder / span);
+	}
+
+	free_main_shape_tables();
+	SDL_DestroySurface(spans);
+	SDL_DestroySurface(decoded);
+
+	return failed != 0;
+}
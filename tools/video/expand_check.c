@@ -0,0 +1,145 @@
+/*
+ * OpenTyrian: A modern cross-platform port of Tyrian
+ * Copyright (C) 2007-2009  The OpenTyrian Development Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/*
+ * Bit-exactness check and timing for expand_index8_rgb565, against the
+ * per-pixel expand_index8_rgb565_c it has to match:
+ *
+ *   cc -O2 -Itools/host -Icomponents/OpenTyrian -o expand_check \
+ *      tools/video/expand_check.c components/OpenTyrian/video_expand.c
+ *
+ *   ./expand_check [-n trials]
+ *
+ * Each trial draws a new random palette and source, a width of up to 1000
+ * pixels (odd ones included, so the tail after the last eight-pixel block
+ * takes every length), and source and destination offsets that leave the
+ * index loads and the pixel stores unaligned.  The destination is guarded
+ * on both sides so a write past either end fails the trial too.  The
+ * timing expands a 320x200 frame a row at a time, as update_dirty_rows
+ * does, and reports ns per pixel.
+ */
+
+#include "video_expand.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define MAX_WIDTH 1000
+#define GUARD     8  // pixels either side of the destination
+
+static Uint16 palette[256];
+
+static uint32_t lcg_state = 0x2545f491;
+
+static uint32_t lcg( void )
+{
+	lcg_state = lcg_state * 1103515245 + 12345;
+	return lcg_state >> 8;
+}
+
+static double now_seconds( void )
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static bool check( void )
+{
+	static Uint8 src[MAX_WIDTH + 8];
+	static Uint16 out[MAX_WIDTH + 2 * GUARD + 4], ref[MAX_WIDTH + 2 * GUARD + 4];
+
+	for (int i = 0; i < 256; ++i)
+		palette[i] = (Uint16)lcg();
+	for (size_t i = 0; i < sizeof(src); ++i)
+		src[i] = (Uint8)lcg();
+
+	const unsigned int width = lcg() % (MAX_WIDTH + 1),
+	                   src_offset = lcg() % 8,
+	                   dst_offset = lcg() % 4;  // in pixels, so half of these are not word aligned
+
+	const Uint16 fill = (Uint16)lcg();
+	for (size_t i = 0; i < sizeof(out) / sizeof(*out); ++i)
+		out[i] = ref[i] = fill;
+
+	expand_index8_rgb565(out + GUARD + dst_offset, src + src_offset, palette, width);
+	expand_index8_rgb565_c(ref + GUARD + dst_offset, src + src_offset, palette, width);
+
+	if (memcmp(out, ref, sizeof(out)) == 0)
+		return true;
+
+	for (size_t i = 0; i < sizeof(out) / sizeof(*out); ++i)
+	{
+		if (out[i] != ref[i])
+		{
+			fprintf(stderr, "mismatch: width %u, src offset %u, dst offset %u: pixel %d is %04x, expected %04x\n",
+			        width, src_offset, dst_offset, (int)i - GUARD - (int)dst_offset, out[i], ref[i]);
+			break;
+		}
+	}
+	return false;
+}
+
+static void time_kernel( const char *name, void (*expand)( Uint16 *, const Uint8 *, const Uint16 *, unsigned int ), unsigned int frames )
+{
+	static Uint8 src[200][320];
+	static Uint16 dst[200][320];
+
+	for (int y = 0; y < 200; ++y)
+		for (int x = 0; x < 320; ++x)
+			src[y][x] = (Uint8)lcg();
+
+	const double start = now_seconds();
+	for (unsigned int frame = 0; frame < frames; ++frame)
+		for (int y = 0; y < 200; ++y)
+			expand(dst[y], src[y], palette, 320);
+	const double seconds = now_seconds() - start;
+
+	printf("%-24s %7.3f ns/pixel\n", name, seconds * 1e9 / ((double)frames * 320 * 200));
+}
+
+int main( int argc, char *argv[] )
+{
+	unsigned int trials = 100000;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+			trials = (unsigned int)atoi(argv[++i]);
+		else
+		{
+			fprintf(stderr, "usage: %s [-n trials]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	unsigned int failed = 0;
+	for (unsigned int t = 0; t < trials; ++t)
+		failed += !check();
+
+	printf("%u of %u expansions match expand_index8_rgb565_c\n", trials - failed, trials);
+
+	time_kernel("expand_index8_rgb565_c", expand_index8_rgb565_c, 2000);
+	time_kernel("expand_index8_rgb565", expand_index8_rgb565, 2000);
+
+	return failed != 0;
+}
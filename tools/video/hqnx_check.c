@@ -0,0 +1,321 @@
+/*
+ * OpenTyrian: A modern cross-platform port of Tyrian
+ * Copyright (C) 2007-2009  The OpenTyrian Development Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/*
+ * Bit-exactness check and timing for the INDEX8 hq2x/hq3x/hq4x kernels in
+ * video_scale_hqNx.c, against the XRGB8888 hqNx they were made from.  That
+ * one sat commented out in video_scale_hqNx.c before the palette diff
+ * bitmap; take it from the commit before and uncomment it:
+ *
+ *   git show 940b092:components/OpenTyrian/video_scale_hqNx.c | \
+ *      sed -e '/^\t\/\*$/d' -e '/^\t\*\/$/d' > hqNx_ref.c
+ *
+ *   cc -O2 -Itools/host -Icomponents/OpenTyrian -I. -o hqnx_check \
+ *      tools/video/hqnx_check.c components/OpenTyrian/video_scale_hqNx.c
+ *
+ *   ./hqnx_check [-n trials] [-f frames]
+ *
+ * Each trial draws a new RGB565 palette, with runs of near-identical colours
+ * so both sides of the YUV thresholds come up, and a new frame of blocks,
+ * lines and noise over a few of its colours.  The reference is fed the same
+ * colours widened to eight bits the way the kernels widen them, and its
+ * output is packed down to RGB565 the way they pack it.  The kernels draw
+ * the frame in bands of random height, as the scaler workers split it, so
+ * band edges are checked too.  Any pixel that differs fails the run.
+ *
+ * The timing scales a whole frame with the same palette, as the present task
+ * does between palette changes, and again with one colour changed before
+ * every frame, as during a fade.  It reports frames per second and us per
+ * frame for the reference and the kernels, each the best of five rounds.
+ * The reference reads palette.c's yuv_palette, which the game keeps up to
+ * date as it changes colours, so only the kernels pay for a palette change.
+ */
+
+#include "palette.h"
+#include "video.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// the reference, renamed so it links alongside the kernels
+#define interp1 ref_interp1
+#define interp2 ref_interp2
+#define interp3 ref_interp3
+#define interp4 ref_interp4
+#define interp5 ref_interp5
+#define interp6 ref_interp6
+#define interp7 ref_interp7
+#define interp8 ref_interp8
+#define interp9 ref_interp9
+#define interp10 ref_interp10
+#define diff ref_diff
+#define Ymask ref_Ymask
+#define Umask ref_Umask
+#define Vmask ref_Vmask
+#define trY ref_trY
+#define trU ref_trU
+#define trV ref_trV
+
+static Uint32 YUV1, YUV2;  // the reference used these as scratch globals
+
+#include "hqNx_ref.c"
+
+#undef interp1
+#undef interp2
+#undef interp3
+#undef interp4
+#undef interp5
+#undef interp6
+#undef interp7
+#undef interp8
+#undef interp9
+#undef interp10
+#undef diff
+#undef Ymask
+#undef Umask
+#undef Vmask
+#undef trY
+#undef trU
+#undef trV
+
+void hq2x_16( Uint8 *out, int out_pitch, const Uint8 *src, int src_pitch, const Uint16 *palette, int first_row, int last_row );
+void hq3x_16( Uint8 *out, int out_pitch, const Uint8 *src, int src_pitch, const Uint16 *palette, int first_row, int last_row );
+void hq4x_16( Uint8 *out, int out_pitch, const Uint8 *src, int src_pitch, const Uint16 *palette, int first_row, int last_row );
+
+// palette.c's, which the kernels link against
+EXT_RAM_BSS_ATTR Uint32 rgb_palette[256], yuv_palette[256];
+
+Uint32 rgb_to_yuv( int r, int g, int b )
+{
+	int y = (r + g + b) >> 2,
+	    u = 128 + ((r - b) >> 2),
+	    v = 128 + ((-r + 2 * g - b) >> 3);
+	return (y << 16) + (u << 8) + v;
+}
+
+typedef void (*RefScaler)( SDL_Surface *, SDL_Surface * );
+typedef void (*Kernel)( Uint8 *, int, const Uint8 *, int, const Uint16 *, int, int );
+
+static const struct
+{
+	const char *name;
+	int factor;
+	RefScaler ref;
+	Kernel kernel;
+}
+scalers_under_test[] =
+{
+	{ "hq2x", 2, hq2x_32, hq2x_16 },
+	{ "hq3x", 3, hq3x_32, hq3x_16 },
+	{ "hq4x", 4, hq4x_32, hq4x_16 },
+};
+
+static Uint8 src[vga_height][vga_width];
+static Uint32 ref_out[4 * vga_height][4 * vga_width];
+static Uint16 out[4 * vga_height][4 * vga_width];
+static Uint16 palette565[256];
+
+static uint32_t lcg_state = 0x2545f491;
+
+static uint32_t lcg( void )
+{
+	lcg_state = lcg_state * 1103515245 + 12345;
+	return lcg_state >> 8;
+}
+
+static double now_seconds( void )
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void random_palette( void )
+{
+	Uint16 c = (Uint16)lcg();
+	for (int i = 0; i < 256; ++i)
+	{
+		// mostly small steps from the last colour, sometimes a jump
+		if (lcg() % 4 == 0)
+			c = (Uint16)lcg();
+		else
+			c ^= 1u << (lcg() % 16);
+		palette565[i] = c;
+
+		const int r = (c >> 11) & 0x1f,
+		          g = (c >> 5) & 0x3f,
+		          b = c & 0x1f;
+		const int r8 = (r << 3) | (r >> 2),
+		          g8 = (g << 2) | (g >> 4),
+		          b8 = (b << 3) | (b >> 2);
+		rgb_palette[i] = (r8 << 16) | (g8 << 8) | b8;
+		yuv_palette[i] = rgb_to_yuv(r8, g8, b8);
+	}
+}
+
+static void random_frame( void )
+{
+	Uint8 colors[8];
+	const unsigned int color_count = 2 + lcg() % 7;
+	const Uint8 base = (Uint8)lcg();
+	for (unsigned int i = 0; i < color_count; ++i)
+		colors[i] = (lcg() % 2) ? (Uint8)(base + lcg() % 8) : (Uint8)lcg();
+
+	memset(src, colors[0], sizeof(src));
+
+	for (int shape = lcg() % 200; shape > 0; --shape)
+	{
+		const int x = lcg() % vga_width, y = lcg() % vga_height,
+		          w = 1 + lcg() % 40, h = 1 + lcg() % 40;
+		const Uint8 color = colors[lcg() % color_count];
+		const bool diagonal = lcg() % 2;
+		for (int j = y; j < y + h && j < vga_height; ++j)
+			for (int i = x; i < x + w && i < vga_width; ++i)
+				if (!diagonal || (i - x) >= (j - y))
+					src[j][i] = color;
+	}
+	for (int noise = lcg() % 2000; noise > 0; --noise)
+		src[lcg() % vga_height][lcg() % vga_width] = colors[lcg() % color_count];
+}
+
+static void run_reference( RefScaler ref, int factor )
+{
+	SDL_Surface src_surface = { .w = vga_width, .h = vga_height, .pitch = vga_width, .pixels = src },
+	            dst_surface = { .w = factor * vga_width, .h = factor * vga_height, .pitch = sizeof(ref_out[0]), .pixels = ref_out };
+	ref(&src_surface, &dst_surface);
+}
+
+static void run_kernel( Kernel kernel, int factor, int first_row, int last_row )
+{
+	kernel((Uint8 *)out[factor * first_row], sizeof(out[0]), &src[0][0], sizeof(src[0]), palette565, first_row, last_row);
+}
+
+static bool check( int s )
+{
+	const int factor = scalers_under_test[s].factor;
+
+	random_palette();
+	random_frame();
+
+	run_reference(scalers_under_test[s].ref, factor);
+
+	memset(out, 0xaa, sizeof(out));
+	for (int first_row = 0; first_row < vga_height; )
+	{
+		const int band = lcg() % 64,
+		          last_row = MIN(first_row + band, vga_height - 1);
+		run_kernel(scalers_under_test[s].kernel, factor, first_row, last_row);
+		first_row = last_row + 1;
+	}
+
+	for (int y = 0; y < factor * vga_height; ++y)
+	{
+		for (int x = 0; x < factor * vga_width; ++x)
+		{
+			const Uint32 c = ref_out[y][x];
+			const Uint16 expected = ((c >> 8) & 0xf800) | ((c >> 5) & 0x07e0) | ((c >> 3) & 0x001f);
+			if (out[y][x] != expected)
+			{
+				fprintf(stderr, "mismatch: %s pixel %d,%d (source %d,%d) is %04x, expected %04x\n",
+				        scalers_under_test[s].name, x, y, x / factor, y / factor, out[y][x], expected);
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+#define TIMING_ROUNDS 5
+
+// seconds per frame in the fastest of TIMING_ROUNDS rounds, so a busy host
+// does not skew one side of the comparison
+static double best_frame_time( int s, bool reference, bool fading, unsigned int frames )
+{
+	const int factor = scalers_under_test[s].factor;
+	double best = 0;
+
+	for (int round = 0; round < TIMING_ROUNDS; ++round)
+	{
+		const double start = now_seconds();
+		for (unsigned int frame = 0; frame < frames; ++frame)
+		{
+			if (fading)
+				palette565[frame & 0xff] ^= 0x0821;
+
+			if (reference)
+				run_reference(scalers_under_test[s].ref, factor);
+			else
+				run_kernel(scalers_under_test[s].kernel, factor, 0, vga_height - 1);
+		}
+		const double seconds = (now_seconds() - start) / frames;
+		if (round == 0 || seconds < best)
+			best = seconds;
+	}
+	return best;
+}
+
+static void time_scaler( int s, unsigned int frames )
+{
+	random_palette();
+	random_frame();
+
+	const double ref_seconds = best_frame_time(s, true, false, frames),
+	             seconds = best_frame_time(s, false, false, frames),
+	             fading_seconds = best_frame_time(s, false, true, frames);
+
+	printf("%-6s %10.1f %10.1f %10.1f %10.1f %10.1f\n", scalers_under_test[s].name,
+	       1 / ref_seconds, ref_seconds * 1e6, 1 / seconds, seconds * 1e6, fading_seconds * 1e6);
+}
+
+int main( int argc, char *argv[] )
+{
+	unsigned int trials = 200, frames = 50;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+			trials = (unsigned int)atoi(argv[++i]);
+		else if (strcmp(argv[i], "-f") == 0 && i + 1 < argc)
+			frames = (unsigned int)atoi(argv[++i]);
+		else
+		{
+			fprintf(stderr, "usage: %s [-n trials] [-f frames]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	unsigned int failed = 0;
+	for (size_t s = 0; s < COUNTOF(scalers_under_test); ++s)
+	{
+		unsigned int scaler_failed = 0;
+		for (unsigned int t = 0; t < trials; ++t)
+			scaler_failed += !check(s);
+		printf("%s: %u of %u frames match the XRGB8888 hqNx\n", scalers_under_test[s].name, trials - scaler_failed, trials);
+		failed += scaler_failed;
+	}
+
+	printf("\n%-6s %10s %10s %10s %10s %10s\n", "scaler", "ref fps", "ref us", "fps", "us", "fading us");
+	for (size_t s = 0; s < COUNTOF(scalers_under_test); ++s)
+		time_scaler(s, frames);
+
+	return failed != 0;
+}
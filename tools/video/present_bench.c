@@ -0,0 +1,272 @@
+/*
+ * OpenTyrian: A modern cross-platform port of Tyrian
+ * Copyright (C) 2007-2009  The OpenTyrian Development Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/*
+ * Bytes pushed to the display per frame by video.c's present path, and a
+ * check that the partial pushes leave the window exactly as a whole-frame
+ * push would:
+ *
+ *   cc -O2 -pthread -Itools/host -Icomponents/OpenTyrian -o present_bench \
+ *      tools/video/present_bench.c tools/host/sdl_headless.c tools/host/freertos.c \
+ *      components/OpenTyrian/video.c components/OpenTyrian/scaler_jobs.c \
+ *      components/OpenTyrian/video_scale.c components/OpenTyrian/video_expand.c \
+ *      components/OpenTyrian/video_scale_hqNx.c -lm
+ *
+ *   ./present_bench [-n frames] [-w <w>x<h>] [-s scaler]
+ *
+ * The window stands in for a panel of the given size (320x240 by default,
+ * as on the esp-box and the Core S3).  Each scene hands -n frames to
+ * scale_and_flip and waits for the present task to take every one:
+ *
+ *   idle     nothing changes
+ *   menu     a number ticks every frame and a highlight bar moves between
+ *            six menu lines every 15 frames, over a fixed background
+ *   lines    a number ticks at the top of the screen and another at the
+ *            bottom, so one band from first to last changed row would be
+ *            nearly the whole screen
+ *   scroll   every row moves down one line per frame
+ *   fade     the palette changes every frame
+ *
+ * "whole" is what pushing the whole window for every presented frame costs,
+ * which is what the renderer did before; "pushed" is what went to the
+ * display.  After every frame the window is compared with a whole-frame
+ * expand and blit of the same frame, and any difference fails the run.
+ */
+
+#include "palette.h"
+#include "video.h"
+#include "video_scale.h"
+
+#include <sched.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// the parts of palette.c and keyboard.c that video.c and the scalers use
+Uint16 rgb565_palette[256];
+EXT_RAM_BSS_ATTR Uint32 rgb_palette[256], yuv_palette[256];
+SDL_Palette *palette;
+bool input_grab_enabled;
+
+void input_grab( bool enable )
+{
+	input_grab_enabled = enable;
+}
+
+Uint32 rgb_to_yuv( int r, int g, int b )
+{
+	int y = (r + g + b) >> 2,
+	    u = 128 + ((r - b) >> 2),
+	    v = 128 + ((-r + 2 * g - b) >> 3);
+	return (y << 16) + (u << 8) + v;
+}
+
+extern SDL_Window *window;  // video.c's
+
+static Uint8 background[vga_height][vga_width];
+
+static uint32_t lcg_state = 0x2545f491;
+
+static uint32_t lcg( void )
+{
+	lcg_state = lcg_state * 1103515245 + 12345;
+	return lcg_state >> 8;
+}
+
+static void set_palette_brightness( int level )
+{
+	for (int i = 0; i < 256; ++i)
+	{
+		const int r = (i * 7) & 0xff, g = (i * 13) & 0xff, b = (i * 29) & 0xff;
+		rgb565_palette[i] = ((r * level / 64) & 0xf8) << 8 | ((g * level / 64) & 0xfc) << 3 | (b * level / 64) >> 3;
+	}
+}
+
+static void draw_number( int x, int y, unsigned int value )
+{
+	// blocky digits are enough to change the rows they sit on
+	Uint8 *pixels = VGAScreen->pixels;
+	for (int digit = 0; digit < 3; ++digit, value /= 10)
+		for (int j = 0; j < 8; ++j)
+			for (int i = 0; i < 6; ++i)
+				pixels[(y + j) * VGAScreen->pitch + x + (2 - digit) * 8 + i] = (Uint8)(value % 10 * 17 + i * j);
+}
+
+static void draw_scene( const char *scene, unsigned int frame )
+{
+	Uint8 *pixels = VGAScreen->pixels;
+
+	if (strcmp(scene, "scroll") == 0)
+	{
+		for (int y = 0; y < vga_height; ++y)
+			memcpy(pixels + y * VGAScreen->pitch, background[(y + vga_height - frame % vga_height) % vga_height], vga_width);
+		return;
+	}
+
+	for (int y = 0; y < vga_height; ++y)
+		memcpy(pixels + y * VGAScreen->pitch, background[y], vga_width);
+
+	if (strcmp(scene, "menu") == 0)
+	{
+		const int line = frame / 15 % 6;
+		memset(pixels + (60 + line * 16) * VGAScreen->pitch + 100, 200, 120);
+		memset(pixels + (60 + line * 16 + 9) * VGAScreen->pitch + 100, 200, 120);
+		draw_number(200, 20, frame);
+	}
+	else if (strcmp(scene, "lines") == 0)
+	{
+		draw_number(20, 4, frame);
+		draw_number(260, 188, frame * 7);
+	}
+	else if (strcmp(scene, "fade") == 0)
+	{
+		set_palette_brightness(64 - frame % 64);
+	}
+}
+
+static Uint32 frames_taken( void )
+{
+	Uint32 presented, dropped, unchanged;
+	get_present_stats(&presented, &dropped, &unchanged);
+	return presented + dropped + unchanged;
+}
+
+// the window as a whole-frame expand and blit would leave it
+static bool window_matches( void )
+{
+	const struct Scalers *s = &scalers[scaler];
+	SDL_Surface *frame = SDL_CreateSurface(s->width, s->height, SDL_PIXELFORMAT_RGB565),
+	            *window_surface = SDL_GetWindowSurface(window),
+	            *expected = SDL_CreateSurface(window_surface->w, window_surface->h, SDL_PIXELFORMAT_RGB565);
+
+	s->expand16(frame->pixels, frame->pitch, VGAScreen->pixels, VGAScreen->pitch, rgb565_palette, 0, vga_height - 1);
+
+	if (scaler != 0 && frame->w <= expected->w && frame->h <= expected->h)
+	{
+		const SDL_Rect dst_rect = { (expected->w - frame->w) / 2, (expected->h - frame->h) / 2, frame->w, frame->h };
+		SDL_BlitSurface(frame, NULL, expected, &dst_rect);
+	}
+	else
+	{
+		SDL_BlitSurfaceScaled(frame, NULL, expected, NULL, SDL_SCALEMODE_NEAREST);
+	}
+
+	bool matches = true;
+	for (int y = 0; y < expected->h && matches; ++y)
+	{
+		if (memcmp((Uint8 *)expected->pixels + y * expected->pitch, (Uint8 *)window_surface->pixels + y * window_surface->pitch, expected->w * 2) != 0)
+		{
+			fprintf(stderr, "mismatch: window row %d differs from a whole-frame push\n", y);
+			matches = false;
+		}
+	}
+
+	SDL_DestroySurface(frame);
+	SDL_DestroySurface(expected);
+	return matches;
+}
+
+static bool run_scene( const char *scene, unsigned int frames )
+{
+	Uint32 presented, dropped, unchanged, pushed, whole;
+	get_present_stats(&presented, &dropped, &unchanged);
+	get_present_bytes(&pushed, &whole);
+	const Uint32 start_presented = presented, start_pushed = pushed, start_whole = whole;
+
+	bool matches = true;
+	for (unsigned int frame = 0; frame < frames; ++frame)
+	{
+		draw_scene(scene, frame);
+
+		const Uint32 taken = frames_taken();
+		scale_and_flip(VGAScreen);
+		while (frames_taken() == taken)
+			sched_yield();
+
+		if (matches)
+			matches = window_matches();
+	}
+
+	get_present_stats(&presented, &dropped, &unchanged);
+	get_present_bytes(&pushed, &whole);
+	presented -= start_presented;
+	pushed -= start_pushed;
+	whole -= start_whole;
+
+	printf("%-8s %9u %12.0f %12.0f %7.1f%%%s\n", scene, presented,
+	       presented ? (double)whole / presented : 0.0, presented ? (double)pushed / presented : 0.0,
+	       whole ? 100.0 * pushed / whole : 0.0, matches ? "" : "  MISMATCH");
+	return matches;
+}
+
+int main( int argc, char *argv[] )
+{
+	unsigned int frames = 300;
+	const char *panel = "320x240";
+	const char *scaler_name = "None";
+
+	for (int i = 1; i < argc; ++i)
+	{
+		if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+			frames = (unsigned int)atoi(argv[++i]);
+		else if (strcmp(argv[i], "-w") == 0 && i + 1 < argc)
+			panel = argv[++i];
+		else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc)
+			scaler_name = argv[++i];
+		else
+		{
+			fprintf(stderr, "usage: %s [-n frames] [-w <w>x<h>] [-s scaler]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	setenv("SDL_HEADLESS_WINDOW", panel, 1);
+
+	init_video();
+	if (VGAScreen == NULL)
+		return 1;
+
+	scaler = scalers_count;
+	set_scaler_by_name(scaler_name);
+	if (scaler == scalers_count)
+	{
+		fprintf(stderr, "unknown scaler %s\n", scaler_name);
+		return 1;
+	}
+
+	for (int y = 0; y < vga_height; ++y)
+		for (int x = 0; x < vga_width; ++x)
+			background[y][x] = (Uint8)((x / 16 + y / 10) * 3 + (lcg() % 4 == 0));
+	set_palette_brightness(64);
+
+	printf("%s on a %s window\n\n", scalers[scaler].name, panel);
+	printf("%-8s %9s %12s %12s %8s\n", "scene", "presented", "whole B/fr", "pushed B/fr", "pushed");
+
+	static const char *const scenes[] = { "idle", "menu", "lines", "scroll", "fade" };
+	bool matches = true;
+	for (size_t i = 0; i < COUNTOF(scenes); ++i)
+	{
+		set_palette_brightness(64);
+		matches &= run_scene(scenes[i], frames);
+	}
+
+	deinit_video();
+	return !matches;
+}
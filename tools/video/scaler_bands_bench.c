@@ -0,0 +1,208 @@
+/*
+ * OpenTyrian: A modern cross-platform port of Tyrian
+ * Copyright (C) 2007-2009  The OpenTyrian Development Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/*
+ * Band-split scaling in scaler_jobs.c against the caller scaling alone, and
+ * a check that both leave the same pixels:
+ *
+ *   cc -O2 -pthread -Itools/host -Icomponents/OpenTyrian -o scaler_bands_bench \
+ *      tools/video/scaler_bands_bench.c tools/host/sdl_headless.c tools/host/freertos.c \
+ *      components/OpenTyrian/scaler_jobs.c components/OpenTyrian/video_scale.c \
+ *      components/OpenTyrian/video_expand.c components/OpenTyrian/video_scale_hqNx.c -lm
+ *
+ *   ./scaler_bands_bench [-n trials] [-f frames]
+ *
+ * "alone" is init_scaler_jobs() with the caller on core 1 and the game on
+ * core 0, which leaves no core for a worker, as on the dual-core chips.
+ * "split" gives the game's core a worker, as the scaler jobs did before they
+ * were kept off it.  Every scaler expands trials random frames both ways;
+ * any byte that differs fails the run.
+ *
+ * The timing expands a whole frame frames times each way and reports us per
+ * frame, the best of five rounds.  "worker us" is the part of a split frame
+ * the worker band took, which on the device is time taken from the game on
+ * its core.  The host shim does not pin tasks to cores, so on a host with
+ * fewer free cores than bands the split cannot win there.
+ */
+
+#include "scaler_jobs.h"
+#include "video.h"
+#include "video_scale.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// the parts of palette.c that the scalers use
+EXT_RAM_BSS_ATTR Uint32 rgb_palette[256], yuv_palette[256];
+
+Uint32 rgb_to_yuv( int r, int g, int b )
+{
+	int y = (r + g + b) >> 2,
+	    u = 128 + ((r - b) >> 2),
+	    v = 128 + ((-r + 2 * g - b) >> 3);
+	return (y << 16) + (u << 8) + v;
+}
+
+#define TIMING_ROUNDS 5
+
+static Uint8 src[vga_height][vga_width];
+static Uint16 palette565[256];
+static Uint16 split_out[4 * vga_height][4 * vga_width],
+              alone_out[4 * vga_height][4 * vga_width];
+
+static uint32_t lcg_state = 0x2545f491;
+
+static uint32_t lcg( void )
+{
+	lcg_state = lcg_state * 1103515245 + 12345;
+	return lcg_state >> 8;
+}
+
+static double now_seconds( void )
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void random_frame( void )
+{
+	for (int i = 0; i < 256; ++i)
+		palette565[i] = (Uint16)lcg();
+
+	// blocks over noise, so the edge-detecting scalers take both paths
+	for (int y = 0; y < vga_height; ++y)
+		for (int x = 0; x < vga_width; ++x)
+			src[y][x] = (lcg() % 8 == 0) ? (Uint8)lcg() : (Uint8)((x / 16 + y / 10) * 3);
+}
+
+static void start_jobs( bool split )
+{
+	// the caller is on core 1; split lets a worker onto the game's core 0
+	init_scaler_jobs(1, split ? 1 : 0);
+}
+
+static void scale_frame( unsigned int s, Uint16 (*out)[4 * vga_width] )
+{
+	const int scale_y = scalers[s].height / vga_height;
+	run_scaler_bands(scalers[s].expand16, (Uint8 *)out, sizeof(out[0]), scale_y,
+	                 &src[0][0], sizeof(src[0]), palette565, 0, vga_height - 1);
+}
+
+static bool check( unsigned int s, unsigned int trials )
+{
+	unsigned int mismatches = 0;
+
+	for (unsigned int t = 0; t < trials; ++t)
+	{
+		random_frame();
+
+		start_jobs(true);
+		scale_frame(s, split_out);
+		deinit_scaler_jobs();
+
+		start_jobs(false);
+		scale_frame(s, alone_out);
+		deinit_scaler_jobs();
+
+		for (int y = 0; y < scalers[s].height; ++y)
+		{
+			if (memcmp(split_out[y], alone_out[y], scalers[s].width * sizeof(Uint16)) != 0)
+			{
+				if (mismatches++ < 10)
+					fprintf(stderr, "mismatch: %s trial %u row %d\n", scalers[s].name, t, y);
+				break;
+			}
+		}
+	}
+
+	printf("%s: %u of %u split frames match the caller scaling alone\n", scalers[s].name, trials - mismatches, trials);
+	return mismatches == 0;
+}
+
+// seconds per frame in the fastest of TIMING_ROUNDS rounds, and the worker
+// band's share of that round
+static double best_frame_time( unsigned int s, bool split, unsigned int frames, double *worker_seconds )
+{
+	double best = 0;
+
+	start_jobs(split);
+	for (int round = 0; round < TIMING_ROUNDS; ++round)
+	{
+		Uint32 before[SCALER_BANDS], after[SCALER_BANDS];
+		get_scaler_band_stats(before);
+
+		const double start = now_seconds();
+		for (unsigned int frame = 0; frame < frames; ++frame)
+			scale_frame(s, split ? split_out : alone_out);
+		const double seconds = (now_seconds() - start) / frames;
+
+		get_scaler_band_stats(after);
+		if (round == 0 || seconds < best)
+		{
+			best = seconds;
+			*worker_seconds = (Uint32)(after[0] - before[0]) / 1e6 / frames;
+		}
+	}
+	deinit_scaler_jobs();
+
+	return best;
+}
+
+int main( int argc, char *argv[] )
+{
+	unsigned int trials = 20, frames = 50;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+			trials = (unsigned int)atoi(argv[++i]);
+		else if (strcmp(argv[i], "-f") == 0 && i + 1 < argc)
+			frames = (unsigned int)atoi(argv[++i]);
+		else
+		{
+			fprintf(stderr, "usage: %s [-n trials] [-f frames]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	bool matches = true;
+	for (unsigned int s = 0; s < scalers_count; ++s)
+		if (scalers[s].expand16 != NULL)
+			matches &= check(s, trials);
+
+	random_frame();
+
+	printf("\n%-8s %10s %10s %10s\n", "scaler", "alone us", "split us", "worker us");
+	for (unsigned int s = 0; s < scalers_count; ++s)
+	{
+		if (scalers[s].expand16 == NULL)
+			continue;
+
+		double alone_worker, split_worker;
+		const double alone = best_frame_time(s, false, frames, &alone_worker),
+		             split = best_frame_time(s, true, frames, &split_worker);
+		printf("%-8s %10.1f %10.1f %10.1f\n", scalers[s].name, alone * 1e6, split * 1e6, split_worker * 1e6);
+	}
+
+	return !matches;
+}